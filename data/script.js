@@ -23,6 +23,14 @@ class SplitFlopController {
 
     this.calibrateOnStart = false;
     this.ws = null;
+    this.wsSubscribed = false; // true: стан приходить через /ws, опитування не потрібне
+    this.clockAnchor = null; // останній кадр теми clock для локального годинника
+    this.lastTickSecond = null; // секунда, яку тікер показав останньою
+
+    // View‑model: останні записані в DOM значення та записи до наступного кадру
+    this.rendered = new Map();
+    this.pendingView = new Map();
+    this.digitEls = null;
     this.calibrationInProgress = false;
     this.motorsHomed = true; // чи відкалібровані двигуни
     this.savedTestDigits = [...this.testDigits];
@@ -107,11 +115,25 @@ class SplitFlopController {
 
     this.ws.onopen = () => {
       console.log("WebSocket connected");
+      // Лише теми, які показує панель (без metrics)
+      this.ws.send(
+        JSON.stringify({
+          subscribe: ["clock", "motion", "config", "calibration"],
+        }),
+      );
     };
 
     this.ws.onmessage = (event) => {
       try {
         const data = JSON.parse(event.data);
+        if (data.topics) {
+          this.wsSubscribed = true;
+          return;
+        }
+        if (data.error) {
+          console.warn("WebSocket command rejected:", data.error);
+          return;
+        }
         this.handleWebSocketData(data);
       } catch (e) {
         console.error("Invalid WebSocket message", e);
@@ -120,61 +142,153 @@ class SplitFlopController {
 
     this.ws.onclose = () => {
       console.log("WebSocket disconnected, will reconnect...");
+      this.wsSubscribed = false;
       setTimeout(() => this.initWebSocket(), 3000);
     };
   }
 
-  handleWebSocketData(data) {
-    // Оновлюємо стан калібрування та моторів
-    if (data.calibrationInProgress !== undefined) {
-      this.calibrationInProgress = data.calibrationInProgress;
-      this.updateUIBlockedState();
-    }
-    if (data.motorsHomed !== undefined) {
-      this.motorsHomed = data.motorsHomed;
-      this.updateUIBlockedState();
-    }
+  // ---------- View‑model ----------
+  // Дані з /ws та /api/state оновлюють лише модель. DOM змінюється в
+  // тікері, раз на кадр і тільки для значень, які справді змінились.
+  setView(key, value, render) {
+    if (!this.pendingView.has(key) && this.rendered.get(key) === value) return;
+    this.pendingView.set(key, { value, render, force: false });
+  }
 
-    if (data.currentTimeFormatted) {
-      document.getElementById("current-time").textContent =
-        data.currentTimeFormatted;
-      const [hours, minutes, seconds] = data.currentTimeFormatted
-        .split(":")
-        .map(Number);
-      const now = new Date();
-      now.setHours(hours, minutes, seconds, 0);
-      this.currentTime = now;
+  // Для елементів, які також змінюють обробники вводу: рендер без
+  // порівняння з кешем (зміну вже визначено за this.config)
+  scheduleRender(key, render) {
+    this.pendingView.set(key, { value: undefined, render, force: true });
+  }
+
+  flushView() {
+    if (this.pendingView.size === 0) return;
+    const pending = this.pendingView;
+    this.pendingView = new Map();
+    for (const [key, { value, render, force }] of pending) {
+      if (!force) {
+        if (this.rendered.get(key) === value) continue;
+        this.rendered.set(key, value);
+      }
+      render(value);
     }
+  }
 
-    if (data.timeRemaining) {
-      document.getElementById("time-remaining").textContent =
-        data.timeRemaining;
+  // Один локальний тікер на requestAnimationFrame: годинник і відлік
+  // рахуються з останнього кадру clock, тож частоту рендеру задає екран,
+  // а не мережа. У фоновій вкладці браузер його призупиняє.
+  startTicker() {
+    const frame = () => {
+      this.tickClock();
+      this.flushView();
+      requestAnimationFrame(frame);
+    };
+    requestAnimationFrame(frame);
+  }
+
+  // Годинник між кадрами теми clock: сервер надсилає їх лише на події
+  // та раз на хвилину, тож час і залишок рахуємо локально
+  tickClock() {
+    const a = this.clockAnchor;
+    if (!a) return;
+    const elapsed = ((Date.now() - a.at) / 1000) * a.warp;
+    const second = Math.floor(a.epoch + elapsed);
+    if (second === this.lastTickSecond) return;
+    this.lastTickSecond = second;
+
+    const now = new Date(second * 1000);
+    const pad = (n) => n.toString().padStart(2, "0");
+    this.currentTime = now;
+    this.setView(
+      "currentTime",
+      `${pad(now.getHours())}:${pad(now.getMinutes())}:${pad(now.getSeconds())}`,
+      (text) => (document.getElementById("current-time").textContent = text),
+    );
+    if (this.config.useCurrentOnStart && this.config.timerStopped) {
+      this.calculateEndDate();
+    }
+    if (!a.stopped && a.remaining !== undefined) {
+      const remaining = Math.max(0, Math.round(a.remaining - elapsed));
+      this.setRemainingDetailed(remaining);
     }
-    if (data.remainingSeconds !== undefined) {
-      const detailed = this.formatDetailedRemaining(data.remainingSeconds);
-      document.getElementById("time-remaining-detailed").textContent = detailed;
+    this.updateStartMomentDisplay();
+  }
+
+  setRemainingDetailed(seconds) {
+    this.setView(
+      "remainingDetailed",
+      this.formatDetailedRemaining(seconds),
+      (text) =>
+        (document.getElementById("time-remaining-detailed").textContent = text),
+    );
+  }
+
+  handleWebSocketData(data) {
+    this.applyState(data);
+  }
+
+  // Стан пристрою (кадр /ws або відповідь /api/state) → модель.
+  // Кадр теми несе лише свої поля; відсутні поля не чіпаємо.
+  applyState(data) {
+    if (data.epoch !== undefined) {
+      this.clockAnchor = {
+        epoch: data.epoch,
+        at: Date.now(),
+        warp: data.warpFactor || 1,
+        remaining: data.remainingSeconds,
+        stopped: data.timerStopped,
+      };
+      this.lastTickSecond = null; // перерахувати в найближчому кадрі
+    } else {
+      // Без якоря годинника (старіша прошивка) – значення як є
+      if (data.currentTimeFormatted) {
+        this.setView(
+          "currentTime",
+          data.currentTimeFormatted,
+          (text) => (document.getElementById("current-time").textContent = text),
+        );
+        const [hours, minutes, seconds] = data.currentTimeFormatted
+          .split(":")
+          .map(Number);
+        const now = new Date();
+        now.setHours(hours, minutes, seconds, 0);
+        this.currentTime = now;
+      }
+      if (data.remainingSeconds !== undefined) {
+        this.setRemainingDetailed(data.remainingSeconds);
+      }
     }
 
+    // Стан калібрування та моторів
     if (
-      data.motorsHomed !== undefined ||
-      data.calibrationInProgress !== undefined
+      data.calibrationInProgress !== undefined ||
+      data.motorsHomed !== undefined
     ) {
-      this.updateCalibrationBadge(data.motorsHomed, data.calibrationInProgress);
+      if (data.calibrationInProgress !== undefined) {
+        this.calibrationInProgress = data.calibrationInProgress;
+      }
+      if (data.motorsHomed !== undefined) {
+        this.motorsHomed = data.motorsHomed;
+      }
+      this.updateUIBlockedState();
+      this.updateCalibrationBadge(this.motorsHomed, this.calibrationInProgress);
     }
 
     if (data.segmentValues) {
-      const digits = document.querySelectorAll(".digit-sim");
-      digits.forEach((digit, index) => {
-        if (data.segmentValues[index] !== undefined) {
-          const newValue = data.segmentValues[index];
-          if (digit.textContent !== newValue.toString()) {
-            digit.textContent = newValue;
-            this.animateFlip(digit);
+      data.segmentValues.forEach((value, index) => {
+        this.setView(`digit${index}`, value.toString(), (text) => {
+          if (!this.digitEls) {
+            this.digitEls = document.querySelectorAll(".digit-sim");
           }
-        }
+          const digit = this.digitEls[index];
+          if (!digit) return;
+          digit.textContent = text;
+          this.animateFlip(digit);
+        });
       });
     }
 
+    // Налаштування: лише поля, що відрізняються від моделі
     if (
       data.durationValue !== undefined &&
       data.durationValue !== this.config.durationValue
@@ -183,21 +297,53 @@ class SplitFlopController {
       const str = data.durationValue.toString().padStart(4, "0");
       for (let i = 0; i < 4; i++) {
         this.testDigits[i] = parseInt(str[i]) || 0;
-        const digitEl = document.querySelector(
-          `.test-digit[data-segment="${i}"] .digit-number`,
-        );
-        if (digitEl) digitEl.textContent = this.testDigits[i];
       }
       this.savedTestDigits = [...this.testDigits];
+      this.scheduleRender("testDigits", () => this.updateTestDigitsUI());
+    }
+    if (data.durationUnit && data.durationUnit !== this.config.durationUnit) {
+      this.config.durationUnit = data.durationUnit;
+      this.setActiveUnit(data.durationUnit);
+    }
+    if (data.syncHour !== undefined && data.syncHour !== this.config.syncHour) {
+      this.config.syncHour = data.syncHour;
+      this.hourDigits = [Math.floor(data.syncHour / 10), data.syncHour % 10];
+      this.scheduleRender("hourDigits", () => this.updateHourDisplay());
+    }
+    if (data.autoSync !== undefined && data.autoSync !== this.config.autoSync) {
+      this.config.autoSync = data.autoSync;
+      this.updateAutoSyncButton();
+    }
+    if (
+      data.useCurrentOnStart !== undefined &&
+      data.useCurrentOnStart !== this.config.useCurrentOnStart
+    ) {
+      this.config.useCurrentOnStart = data.useCurrentOnStart;
+      this.scheduleRender("useCurrentOnStart", () => {
+        document.getElementById("use-current-on-start").checked =
+          this.config.useCurrentOnStart;
+        this.toggleStartFields(this.config.useCurrentOnStart);
+      });
+    }
+    if (
+      data.calibrateOnStart !== undefined &&
+      data.calibrateOnStart !== this.calibrateOnStart
+    ) {
+      this.config.calibrateOnStart = data.calibrateOnStart;
+      this.calibrateOnStart = data.calibrateOnStart;
+      this.updateCalibrateOnStartButton();
     }
 
     if (data.timerStopped !== undefined) {
+      const changed = data.timerStopped !== this.config.timerStopped;
       this.config.timerStopped = data.timerStopped;
       this.updateStartStopButton();
-      if (this.config.timerStopped) {
-        this.checkPastEndDate();
-      } else {
-        this.hidePersistentNotification();
+      if (changed) {
+        if (this.config.timerStopped) {
+          this.checkPastEndDate();
+        } else {
+          this.hidePersistentNotification();
+        }
       }
     }
 
@@ -211,43 +357,42 @@ class SplitFlopController {
       }
     }
 
-    if (data.startDate && data.startTime && !this.config.useCurrentOnStart) {
-      const dateInput = document.getElementById("start-date");
-      const timeInput = document.getElementById("start-time");
-      if (dateInput.value !== data.startDate) {
-        dateInput.value = data.startDate;
-      }
-      if (timeInput.value !== data.startTime) {
-        timeInput.value = data.startTime;
-      }
+    if (
+      data.startDate &&
+      data.startTime &&
+      !this.config.useCurrentOnStart &&
+      (data.startDate !== this.config.startDate ||
+        data.startTime !== this.config.startTime)
+    ) {
       this.config.startDate = data.startDate;
       this.config.startTime = data.startTime;
+      // Поля вводу одразу: з них рахується дата завершення
+      document.getElementById("start-date").value = data.startDate;
+      document.getElementById("start-time").value = data.startTime;
       this.calculateEndDate();
     }
 
-    if (data.durationUnit) {
-      this.config.durationUnit = data.durationUnit;
-      this.setActiveUnit(data.durationUnit);
-    }
-    if (data.syncHour !== undefined) {
-      this.config.syncHour = data.syncHour;
-      this.hourDigits = [Math.floor(data.syncHour / 10), data.syncHour % 10];
-      this.updateHourDisplay();
-    }
-    if (data.autoSync !== undefined) {
-      this.config.autoSync = data.autoSync;
-      this.updateAutoSyncButton();
-    }
-    if (data.useCurrentOnStart !== undefined) {
-      this.config.useCurrentOnStart = data.useCurrentOnStart;
-      document.getElementById("use-current-on-start").checked =
-        data.useCurrentOnStart;
-      this.toggleStartFields(data.useCurrentOnStart);
-    }
-    if (data.calibrateOnStart !== undefined) {
-      this.config.calibrateOnStart = data.calibrateOnStart;
-      this.calibrateOnStart = data.calibrateOnStart;
-      this.updateCalibrateOnStartButton();
+    if (data.timeRemaining) {
+      this.setView(
+        "timeRemaining",
+        data.timeRemaining,
+        (text) => (document.getElementById("time-remaining").textContent = text),
+      );
+      // ВИЯВЛЕННЯ ЗАВЕРШЕННЯ ВІДЛІКУ за рядком "Час вийшов"
+      if (
+        data.timeRemaining.trim() === "Час вийшов" &&
+        !this.timeoutWarningShown
+      ) {
+        this.timeoutWarningShown = true;
+        // Кадр теми clock не несе налаштувань – доповнюємо з моделі
+        this.showCountdownFinishedNotification({
+          startTimestamp: this.startMomentStatic
+            ? this.startMomentStatic.getTime() / 1000
+            : data.startTimestamp,
+          durationValue: this.config.durationValue,
+          durationUnit: this.config.durationUnit,
+        });
+      }
     }
 
     this.updateStartMomentDisplay();
@@ -256,6 +401,14 @@ class SplitFlopController {
   // ---------- Блокування UI залежно від стану калібрування ----------
   updateUIBlockedState() {
     const blocked = this.calibrationInProgress || !this.motorsHomed;
+    this.setView(
+      "blocked",
+      `${blocked}|${this.calibrationInProgress}`,
+      () => this.renderBlockedState(blocked),
+    );
+  }
+
+  renderBlockedState(blocked) {
     const startBtn = document.getElementById("btn-start-stop");
     const digitControls = document.querySelectorAll(
       ".test-digit .digit-btn, .test-digit .digit-number",
@@ -424,7 +577,8 @@ class SplitFlopController {
     }
   }
 
-  async saveConfig(showToast = false) {
+  // Поля конфігурації для /api/config та операції "config" у /api/batch
+  configPayload() {
     const durationStr = this.testDigits.join("");
     const durationValue = parseInt(durationStr, 10) || 0;
     this.config.durationValue = durationValue;
@@ -442,6 +596,11 @@ class SplitFlopController {
       payload.startDate = document.getElementById("start-date").value;
       payload.startTime = document.getElementById("start-time").value;
     }
+    return payload;
+  }
+
+  async saveConfig(showToast = false) {
+    const payload = this.configPayload();
 
     try {
       const response = await fetch("/api/config", {
@@ -485,23 +644,18 @@ class SplitFlopController {
   }
 
   updateStartMomentDisplay() {
-    const displayEl = document.getElementById("start-moment-display");
-    if (!displayEl) return;
-
+    let text;
     if (!this.config.timerStopped && this.startMomentStatic) {
-      displayEl.textContent = this.formatDateTime(this.startMomentStatic);
-      return;
-    }
-
-    if (this.config.useCurrentOnStart) {
-      if (this.currentTime) {
-        displayEl.textContent = this.formatDateTime(this.currentTime);
-      } else {
-        displayEl.textContent = "--:--:--";
-      }
+      text = this.formatDateTime(this.startMomentStatic);
+    } else if (this.config.useCurrentOnStart) {
+      text = this.currentTime ? this.formatDateTime(this.currentTime) : "--:--:--";
     } else {
-      displayEl.textContent = `${this.config.startDate} ${this.config.startTime}`;
+      text = `${this.config.startDate} ${this.config.startTime}`;
     }
+    this.setView("startMoment", text, (value) => {
+      const displayEl = document.getElementById("start-moment-display");
+      if (displayEl) displayEl.textContent = value;
+    });
   }
 
   formatDateTime(date) {
@@ -688,9 +842,15 @@ class SplitFlopController {
   }
 
   updateAutoSyncButton() {
+    this.setView("autoSync", this.config.autoSync, (on) =>
+      this.renderAutoSyncButton(on),
+    );
+  }
+
+  renderAutoSyncButton(on) {
     const btn = document.getElementById("btn-auto-sync");
     if (!btn) return;
-    if (this.config.autoSync) {
+    if (on) {
       btn.innerHTML = '<i class="fas fa-sync-alt"></i> Автосинхронізація: Вкл';
       btn.classList.add("active");
     } else {
@@ -724,6 +884,10 @@ class SplitFlopController {
   }
 
   setActiveUnit(unit) {
+    this.setView("durationUnit", unit, (value) => this.renderActiveUnit(value));
+  }
+
+  renderActiveUnit(unit) {
     const cards = document.querySelectorAll(".unit-card");
     cards.forEach((card) => {
       if (card.dataset.unit === unit) {
@@ -760,8 +924,7 @@ class SplitFlopController {
 
     if (isNaN(startDateTime.getTime())) {
       this.endDateString = "Невірна дата";
-      document.getElementById("end-date-display").textContent =
-        this.endDateString;
+      this.renderEndDate();
       return;
     }
 
@@ -796,11 +959,18 @@ class SplitFlopController {
       second: "2-digit",
     });
 
-    document.getElementById("end-date-display").textContent =
-      this.endDateString;
+    this.renderEndDate();
     this.checkPastEndDate();
   }
 
+  renderEndDate() {
+    this.setView(
+      "endDate",
+      this.endDateString,
+      (text) => (document.getElementById("end-date-display").textContent = text),
+    );
+  }
+
   checkPastEndDate() {
     if (!this.config.timerStopped) return;
 
@@ -862,6 +1032,15 @@ class SplitFlopController {
     const notif = document.getElementById("persistent-notification");
     const msgDiv = notif.querySelector(".notification-message");
     const closeBtn = notif.querySelector(".close-btn");
+    if (
+      !notif.classList.contains("hidden") &&
+      notif.dataset.type === type &&
+      notif.dataset.message === message
+    ) {
+      return; // уже показано – без повторного запису в DOM
+    }
+    notif.dataset.type = type;
+    notif.dataset.message = message;
 
     notif.className = `persistent-notification ${type}`;
     msgDiv.innerHTML = message.replace(/\n/g, "<br>");
@@ -874,7 +1053,7 @@ class SplitFlopController {
 
   hidePersistentNotification() {
     const notif = document.getElementById("persistent-notification");
-    notif.classList.add("hidden");
+    if (!notif.classList.contains("hidden")) notif.classList.add("hidden");
   }
 
   formatDetailedRemaining(seconds) {
@@ -978,9 +1157,15 @@ class SplitFlopController {
   }
 
   updateStartStopButton() {
+    this.setView("timerStopped", this.config.timerStopped, (stopped) =>
+      this.renderStartStopButton(stopped),
+    );
+  }
+
+  renderStartStopButton(stopped) {
     const btn = document.getElementById("btn-start-stop");
     if (!btn) return;
-    if (this.config.timerStopped) {
+    if (stopped) {
       btn.innerHTML = '<i class="fas fa-play"></i> Старт';
       btn.classList.remove("btn-danger");
       btn.classList.add("btn-success");
@@ -992,9 +1177,15 @@ class SplitFlopController {
   }
 
   updateCalibrateOnStartButton() {
+    this.setView("calibrateOnStart", this.calibrateOnStart, (on) =>
+      this.renderCalibrateOnStartButton(on),
+    );
+  }
+
+  renderCalibrateOnStartButton(on) {
     const btn = document.getElementById("btn-calibrate-on-start");
     if (!btn) return;
-    if (this.calibrateOnStart) {
+    if (on) {
       btn.classList.add("active");
       btn.innerHTML = '<i class="fas fa-check-square"></i>';
     } else {
@@ -1014,17 +1205,7 @@ class SplitFlopController {
     }
 
     if (this.config.timerStopped) {
-      if (this.calibrateOnStart) {
-        this.showToast("Калібрування перед стартом...", "warning");
-        try {
-          await this.calibrateMotors();
-          this.startTimerAfterCalibration();
-        } catch {
-          this.showToast("Калібрування не вдалося, запуск скасовано", "error");
-        }
-      } else {
-        this.startTimerAfterCalibration();
-      }
+      await this.startTimerRequest();
     } else {
       await this.stopTimerRequest();
     }
@@ -1046,33 +1227,47 @@ class SplitFlopController {
     }
   }
 
-  async startTimerAfterCalibration() {
+  // Конфігурація, калібрування (за потреби) і старт – одним пакетом:
+  // пристрій зберігає все одним записом і сам запускає таймер після
+  // калібрування.
+  async startTimerRequest() {
+    const ops = [{ op: "config", ...this.configPayload() }];
+    if (this.calibrateOnStart) ops.push({ op: "calibrate" });
+    ops.push({ op: "start" });
+
     try {
-      const response = await fetch("/api/stop", { method: "POST" });
-      if (response.ok) {
-        const data = await response.json();
-        this.config.timerStopped = data.status === "stopped";
-        if (!this.config.timerStopped) {
-          if (this.currentTime) {
-            this.startMomentStatic = new Date(this.currentTime);
-          } else {
-            this.startMomentStatic = new Date();
-          }
-          this.calculateEndDate();
-          // Скидаємо прапорець, щоб сповіщення про завершення могло з'явитися знову
-          this.timeoutWarningShown = false;
-        }
-        this.updateStartStopButton();
-        this.showToast(
-          this.config.timerStopped ? "Таймер зупинено" : "Таймер запущено",
-          this.config.timerStopped ? "warning" : "success",
-        );
-        this.updateStartMomentDisplay();
-        setTimeout(() => this.updateStatus(), 500);
-        this.hidePersistentNotification();
+      const response = await fetch("/api/batch", {
+        method: "POST",
+        headers: { "Content-Type": "application/json" },
+        body: JSON.stringify({ ops }),
+      });
+      const data = await response
+        .json()
+        .catch(() => ({ error: "Unknown error" }));
+      if (!response.ok || !data.success) {
+        throw new Error(data.error || "Помилка запуску таймера");
+      }
+
+      this.config.timerStopped = false;
+      if (this.currentTime) {
+        this.startMomentStatic = new Date(this.currentTime);
+      } else {
+        this.startMomentStatic = new Date();
       }
+      this.calculateEndDate();
+      // Скидаємо прапорець, щоб сповіщення про завершення могло з'явитися знову
+      this.timeoutWarningShown = false;
+      this.updateStartStopButton();
+      if (this.calibrateOnStart) {
+        this.showToast("Калібрування перед стартом...", "warning");
+      } else {
+        this.showToast("Таймер запущено", "success");
+      }
+      this.updateStartMomentDisplay();
+      setTimeout(() => this.updateStatus(), 500);
+      this.hidePersistentNotification();
     } catch (error) {
-      this.showToast("Помилка запуску таймера", "error");
+      this.showToast(error.message || "Помилка запуску таймера", "error");
     }
   }
 
@@ -1130,8 +1325,12 @@ class SplitFlopController {
   }
 
   async startStatusUpdates() {
+    this.startTicker();
     await this.updateStatus();
-    setInterval(() => this.updateStatus(), 1000);
+    // Опитування /api/state лише без підписки на /ws; рендер – у тікері
+    setInterval(() => {
+      if (!this.wsSubscribed) this.updateStatus();
+    }, 1000);
   }
 
   async updateStatus() {
@@ -1139,103 +1338,18 @@ class SplitFlopController {
       const response = await fetch("/api/state");
       if (!response.ok) throw new Error("Network error");
       const data = await response.json();
-
-      // Оновлюємо стан калібрування та моторів
-      if (data.calibrationInProgress !== undefined) {
-        this.calibrationInProgress = data.calibrationInProgress;
-      }
-      if (data.motorsHomed !== undefined) {
-        this.motorsHomed = data.motorsHomed;
-      }
-      this.updateUIBlockedState();
-
-      if (data.currentTimeFormatted) {
-        document.getElementById("current-time").textContent =
-          data.currentTimeFormatted;
-        const [hours, minutes, seconds] = data.currentTimeFormatted
-          .split(":")
-          .map(Number);
-        const now = new Date();
-        now.setHours(hours, minutes, seconds, 0);
-        this.currentTime = now;
-
-        if (this.config.useCurrentOnStart && this.config.timerStopped) {
-          this.calculateEndDate();
-        }
-      }
-
-      if (data.timeRemaining) {
-        document.getElementById("time-remaining").textContent =
-          data.timeRemaining;
-      }
-
-      if (data.remainingSeconds !== undefined) {
-        const detailed = this.formatDetailedRemaining(data.remainingSeconds);
-        document.getElementById("time-remaining-detailed").textContent =
-          detailed;
-      }
-
-      // ВИЯВЛЕННЯ ЗАВЕРШЕННЯ ВІДЛІКУ за рядком "Час вийшов"
-      if (
-        data.timeRemaining &&
-        data.timeRemaining.trim() === "Час вийшов" &&
-        !this.timeoutWarningShown
-      ) {
-        this.timeoutWarningShown = true;
-        console.log("Countdown finished, showing notification");
-        this.showCountdownFinishedNotification(data);
-      }
-
-      if (data.motorsHomed !== undefined) {
-        this.updateCalibrationBadge(
-          data.motorsHomed,
-          data.calibrationInProgress,
-        );
-      }
-
-      if (data.segmentValues) {
-        const digits = document.querySelectorAll(".digit-sim");
-        digits.forEach((digit, index) => {
-          if (data.segmentValues[index] !== undefined) {
-            const newValue = data.segmentValues[index];
-            if (digit.textContent !== newValue.toString()) {
-              digit.textContent = newValue;
-              this.animateFlip(digit);
-            }
-          }
-        });
-      }
-
-      if (data.timerStopped !== undefined) {
-        this.config.timerStopped = data.timerStopped;
-        this.updateStartStopButton();
-        if (this.config.timerStopped) {
-          this.checkPastEndDate();
+      this.applyState(data);
+      this.setView("online", navigator.onLine, (online) => {
+        const statusElement = document.getElementById("connection-status");
+        if (online) {
+          statusElement.innerHTML = '<i class="fas fa-circle"></i> Підключено';
+          statusElement.style.color = "#10b981";
         } else {
-          this.hidePersistentNotification();
-        }
-      }
-
-      if (data.startTimestamp && !this.config.timerStopped) {
-        const serverStart = new Date(data.startTimestamp * 1000);
-        if (
-          !this.startMomentStatic ||
-          this.startMomentStatic.getTime() !== serverStart.getTime()
-        ) {
-          this.startMomentStatic = serverStart;
+          statusElement.innerHTML =
+            '<i class="fas fa-circle"></i> Не підключено';
+          statusElement.style.color = "#dc2626";
         }
-      }
-
-      this.updateStartMomentDisplay();
-
-      const statusElement = document.getElementById("connection-status");
-      if (navigator.onLine) {
-        statusElement.innerHTML = '<i class="fas fa-circle"></i> Підключено';
-        statusElement.style.color = "#10b981";
-      } else {
-        statusElement.innerHTML = '<i class="fas fa-circle"></i> Не підключено';
-        statusElement.style.color = "#dc2626";
-      }
+      });
     } catch (error) {
       console.error("Помилка оновлення статусу:", error);
     }
@@ -1273,6 +1387,12 @@ class SplitFlopController {
   }
 
   updateCalibrationBadge(homed, inProgress) {
+    this.setView("calibrationBadge", `${homed}|${inProgress}`, () =>
+      this.renderCalibrationBadge(homed, inProgress),
+    );
+  }
+
+  renderCalibrationBadge(homed, inProgress) {
     const badge = document.getElementById("calibration-badge");
     const textSpan = document.getElementById("calibration-status-text");
     if (!badge || !textSpan) return;
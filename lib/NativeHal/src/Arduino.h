@@ -0,0 +1,123 @@
+#ifndef HAL_ARDUINO_H
+#define HAL_ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * Native stand‑in for the Arduino‑ESP32 core: types, String, Serial,
+ * timing on the virtual clock (HalClock.h) and the FreeRTOS surface.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <string>
+
+#include "FreeRTOSShim.h"
+#include "HalClock.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define LOW  0
+#define HIGH 1
+#define INPUT             0x01
+#define OUTPUT            0x03
+#define INPUT_PULLUP      0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+/**
+ * Small subset of Arduino String backed by std::string.
+ */
+class String {
+public:
+    String() {}
+    String(const char* s) : s(s ? s : "") {}
+    String(const std::string& s) : s(s) {}
+    String(char c) : s(1, c) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned int v) : s(std::to_string(v)) {}
+    String(long v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+
+    const char* c_str() const { return s.c_str(); }
+    size_t length() const { return s.length(); }
+    bool isEmpty() const { return s.empty(); }
+    long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+    bool startsWith(const String& p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+    String substring(size_t from, size_t to = std::string::npos) const {
+        if (from > s.size()) return String();
+        return String(s.substr(from, to == std::string::npos ? std::string::npos : to - from));
+    }
+
+    String& operator+=(const String& o) { s += o.s; return *this; }
+    String& operator+=(const char* o) { s += o; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    friend String operator+(String a, const String& b) { a += b; return a; }
+    friend String operator+(String a, const char* b) { a += b; return a; }
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator==(const char* o) const { return s == o; }
+    bool operator!=(const String& o) const { return s != o.s; }
+
+    const std::string& str() const { return s; }
+
+private:
+    std::string s;
+};
+
+/**
+ * Serial on stdout. Output can be muted for benchmarks.
+ */
+class HalSerial {
+public:
+    void begin(unsigned long) {}
+    size_t print(const char* s);
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(int v);
+    size_t println(const char* s = "");
+    size_t println(const String& s) { return println(s.c_str()); }
+    size_t println(int v);
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    size_t write(const uint8_t* data, size_t len);
+    void flush() {}
+
+    void setEcho(bool on) { echo = on; }
+    bool isEcho() const { return echo; }
+
+private:
+    bool echo = true;
+};
+
+extern HalSerial Serial;
+
+/**
+ * ESP object: heap figures are reported as a fixed, healthy device.
+ */
+class EspClass {
+public:
+    uint32_t getHeapSize() { return 327680; }
+    uint32_t getFreeHeap() { return 200000; }
+    uint32_t getMinFreeHeap() { return 180000; }
+    uint32_t getMaxAllocHeap() { return 110000; }
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+    void restart() { exit(0); }
+};
+
+extern EspClass ESP;
+
+#endif
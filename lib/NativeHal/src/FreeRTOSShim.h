@@ -0,0 +1,54 @@
+#ifndef HAL_FREERTOS_SHIM_H
+#define HAL_FREERTOS_SHIM_H
+
+#include <stdint.h>
+
+/**
+ * @file FreeRTOSShim.h
+ * Minimal FreeRTOS surface used by the firmware. Tasks run to completion
+ * inside xTaskCreatePinnedToCore() on the caller's thread, which keeps the
+ * native build single‑threaded and deterministic; vTaskDelete(NULL)
+ * unwinds back to the creator.
+ */
+
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void* QueueHandle_t;
+typedef void (*TaskFunction_t)(void*);
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+typedef struct { int unused; } StaticTask_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdFAIL  0
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define tskIDLE_PRIORITY 0
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux)  ((void)(mux))
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority,
+                                   TaskHandle_t* handle, BaseType_t core);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                           void* param, UBaseType_t priority, StackType_t* stack,
+                                           StaticTask_t* tcb, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void taskYIELD();
+TickType_t xTaskGetTickCount();
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+#endif
@@ -0,0 +1,206 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_system.h>
+#include <stdarg.h>
+#include <sys/prctl.h>
+
+HalSerial Serial;
+HalWiFi WiFi;
+EspClass ESP;
+
+// -------------------------------------------------------------------
+// Virtual clock
+// -------------------------------------------------------------------
+static uint64_t nowMicros = 0;
+static int64_t epochOffsetUs = 0;     // wall clock µs − nowMicros
+static bool epochSet = false;
+static bool realtime = false;
+
+// In real‑time mode the clock is the host's CLOCK_MONOTONIC, so
+// timestamps from several instances on one machine are comparable
+static uint64_t monotonicMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static uint64_t clockNow() {
+    if (realtime) nowMicros = monotonicMicros();
+    return nowMicros;
+}
+
+static void sleepFor(uint64_t us) {
+    if (!realtime) {
+        nowMicros += us;
+        return;
+    }
+    uint64_t until = monotonicMicros() + us;
+    struct timespec ts = {(time_t)(until / 1000000ULL), (long)(until % 1000000ULL) * 1000L};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0) {}
+    clockNow();
+}
+
+uint64_t halNowMicros() { return clockNow(); }
+void halAdvanceMicros(uint64_t us) { sleepFor(us); }
+
+void halSetEpoch(time_t epoch) {
+    halSetEpochMicros((int64_t)epoch * 1000000LL);
+}
+
+void halSetEpochMicros(int64_t epochUs) {
+    epochSet = epochUs != 0;
+    epochOffsetUs = epochUs - (int64_t)clockNow();
+}
+
+void halSetRealtime(bool on) {
+    int64_t wall = (int64_t)clockNow() + epochOffsetUs;
+    realtime = on;
+    // Default 50 µs timer slack would stretch every 1 ms motor step
+    if (on) prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+    epochOffsetUs = wall - (int64_t)clockNow();   // wall clock carries on
+}
+
+void halResetClock() {
+    nowMicros = 0;
+    realtime = false;
+    epochOffsetUs = 0;
+    epochSet = false;
+    // Device builds have no TZ set – localtime() is UTC there too
+    setenv("TZ", "UTC0", 1);
+    tzset();
+}
+
+unsigned long millis() { return (unsigned long)(clockNow() / 1000ULL); }
+unsigned long micros() { return (unsigned long)clockNow(); }
+void delay(unsigned long ms) { sleepFor((uint64_t)ms * 1000ULL); }
+void delayMicroseconds(unsigned int us) { sleepFor(us); }
+void yield() {}
+
+// Wall clock on the virtual timeline. Overrides libc so that firmware
+// code calling time()/settimeofday() needs no changes.
+static int64_t wallMicros() {
+    // Like the ESP32 before NTP: seconds since boot
+    return (int64_t)clockNow() + (epochSet ? epochOffsetUs : 0);
+}
+
+extern "C" time_t time(time_t* out) noexcept {
+    time_t t = (time_t)(wallMicros() / 1000000LL);
+    if (out) *out = t;
+    return t;
+}
+
+extern "C" int gettimeofday(struct timeval* __restrict tv, void* __restrict) noexcept {
+    int64_t us = wallMicros();
+    tv->tv_sec = (time_t)(us / 1000000LL);
+    tv->tv_usec = (suseconds_t)(us % 1000000LL);
+    return 0;
+}
+
+extern "C" int settimeofday(const struct timeval* tv, const struct timezone*) noexcept {
+    if (tv) halSetEpochMicros((int64_t)tv->tv_sec * 1000000LL + tv->tv_usec);
+    return 0;
+}
+
+// -------------------------------------------------------------------
+// GPIO: pins float high (pull‑ups), writes are remembered
+// -------------------------------------------------------------------
+static uint8_t pinLevels[64];
+static bool pinDriven[64];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < 64) pinDriven[pin] = (mode == OUTPUT || mode == OUTPUT_OPEN_DRAIN);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < 64) pinLevels[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= 64) return LOW;
+    return pinDriven[pin] ? pinLevels[pin] : HIGH;
+}
+
+// -------------------------------------------------------------------
+// Serial
+// -------------------------------------------------------------------
+size_t HalSerial::print(const char* s) {
+    if (!echo) return 0;
+    return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+size_t HalSerial::print(int v) {
+    return echo ? (size_t)fprintf(stdout, "%d", v) : 0;
+}
+
+size_t HalSerial::println(const char* s) {
+    if (!echo) return 0;
+    return (size_t)fprintf(stdout, "%s\n", s);
+}
+
+size_t HalSerial::println(int v) {
+    return echo ? (size_t)fprintf(stdout, "%d\n", v) : 0;
+}
+
+size_t HalSerial::printf(const char* fmt, ...) {
+    if (!echo) return 0;
+    va_list args;
+    va_start(args, fmt);
+    int n = vfprintf(stdout, fmt, args);
+    va_end(args);
+    return n > 0 ? (size_t)n : 0;
+}
+
+size_t HalSerial::write(const uint8_t* data, size_t len) {
+    if (!echo) return 0;
+    return fwrite(data, 1, len, stdout);
+}
+
+// -------------------------------------------------------------------
+// Reset reason
+// -------------------------------------------------------------------
+static esp_reset_reason_t resetReason = ESP_RST_POWERON;
+
+esp_reset_reason_t esp_reset_reason() { return resetReason; }
+void halSetResetReason(esp_reset_reason_t reason) { resetReason = reason; }
+
+// -------------------------------------------------------------------
+// FreeRTOS: run‑to‑completion tasks on the caller's thread
+// -------------------------------------------------------------------
+namespace {
+struct TaskExit {};
+int taskDepth = 0;
+int dummyHandle = 0;
+int dummyMutex = 0;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t,
+                                   void* param, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    if (handle) *handle = &dummyHandle;
+    taskDepth++;
+    try {
+        fn(param);
+    } catch (const TaskExit&) {
+    }
+    taskDepth--;
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                           void* param, UBaseType_t priority, StackType_t*,
+                                           StaticTask_t*, BaseType_t core) {
+    TaskHandle_t handle = NULL;
+    xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority, &handle, core);
+    return handle;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == NULL && taskDepth > 0) throw TaskExit();
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+void taskYIELD() {}
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return &dummyMutex; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
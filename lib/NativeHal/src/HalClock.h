@@ -0,0 +1,49 @@
+#ifndef HAL_CLOCK_H
+#define HAL_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @file HalClock.h
+ * Controllable virtual clock for the native build. millis(), micros(),
+ * delay(), time() and settimeofday() all run on this clock, so a test or
+ * benchmark decides how time passes – nothing ever sleeps (unless
+ * real‑time mode is switched on, see halSetRealtime()).
+ */
+
+/**
+ * Current virtual time since "power‑on" in microseconds.
+ */
+uint64_t halNowMicros();
+
+/**
+ * Advance the virtual clock.
+ */
+void halAdvanceMicros(uint64_t us);
+
+/**
+ * Set wall‑clock epoch (as settimeofday() would). Pass 0 to simulate an
+ * unset clock after power‑on.
+ */
+void halSetEpoch(time_t epoch);
+
+/**
+ * Set the wall clock with microsecond resolution (settimeofday() with
+ * tv_usec lands here).
+ */
+void halSetEpochMicros(int64_t epochUs);
+
+/**
+ * Run the clock in real time: it follows the host's CLOCK_MONOTONIC and
+ * delay() really sleeps. Used when several native instances talk to each
+ * other over loopback; the wall clock continues from its current value.
+ */
+void halSetRealtime(bool on);
+
+/**
+ * Reset the virtual clock to power‑on state (0 µs, epoch unset).
+ */
+void halResetClock();
+
+#endif
@@ -0,0 +1,67 @@
+#include <Preferences.h>
+#include <map>
+#include <vector>
+
+typedef std::map<std::string, std::vector<uint8_t>> NvsNamespace;
+
+static std::map<std::string, NvsNamespace>& store() {
+    static std::map<std::string, NvsNamespace> s;
+    return s;
+}
+
+static uint32_t writeCount = 0;
+
+uint32_t halNvsWriteCount() { return writeCount; }
+void halNvsErase() { store().clear(); }
+
+bool Preferences::begin(const char* name, bool ro) {
+    ns = name;
+    readOnly = ro;
+    opened = true;
+    store()[ns];
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!opened) return false;
+    return store()[ns].count(key) != 0;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly) return false;
+    return store()[ns].erase(key) != 0;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) return false;
+    store()[ns].clear();
+    return true;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!opened || readOnly || key == nullptr) return 0;
+    const uint8_t* p = (const uint8_t*)value;
+    store()[ns][key].assign(p, p + len);
+    writeCount++;
+    return len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!opened) return 0;
+    NvsNamespace& n = store()[ns];
+    auto it = n.find(key);
+    if (it == n.end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!opened) return 0;
+    NvsNamespace& n = store()[ns];
+    auto it = n.find(key);
+    return it == n.end() ? 0 : it->second.size();
+}
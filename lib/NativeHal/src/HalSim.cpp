@@ -0,0 +1,169 @@
+#include "HalSim.h"
+
+// Half‑step table – must match the firmware's steps[] in SegmentController
+static const uint8_t HALF_STEPS[8] = {
+    0b1000, 0b1100, 0b0100, 0b0110,
+    0b0010, 0b0011, 0b0001, 0b1001
+};
+
+static int decodePhase(uint8_t pattern) {
+    for (int i = 0; i < 8; i++) {
+        if (HALF_STEPS[i] == pattern) return i;
+    }
+    return -1;
+}
+
+// -------------------------------------------------------------------
+// PCF8575
+// -------------------------------------------------------------------
+SimPCF8575::SimPCF8575() {
+    const int bases[2] = {3, 11};
+    const int halls[2] = {8, 9};
+    for (int i = 0; i < 2; i++) {
+        motors[i].basePin = bases[i];
+        motors[i].hallPin = halls[i];
+        motors[i].position = 0;
+        motors[i].phase = -1;
+        motors[i].halfSteps = 0;
+        motors[i].skippedPhases = 0;
+        motors[i].minStepUs = 0;
+        motors[i].lostSteps = 0;
+        motors[i].lastStepMicros = 0;
+    }
+}
+
+void SimPCF8575::setPosition(int motorIndex, int position) {
+    motors[motorIndex].position = ((position % STEPS_PER_REV) + STEPS_PER_REV) % STEPS_PER_REV;
+}
+
+bool SimPCF8575::hallActive(const SimMotor& m) const {
+    return m.position < HALL_WIDTH;
+}
+
+void SimPCF8575::applyFrame(uint16_t word) {
+    latch = word;
+    frames++;
+    for (SimMotor& m : motors) {
+        int phase = decodePhase((word >> m.basePin) & 0x0F);
+        if (phase < 0) {
+            m.phase = -1;
+            continue;
+        }
+        if (m.phase >= 0 && phase != m.phase) {
+            int delta = (phase - m.phase + 8) % 8;
+            uint64_t now = halNowMicros();
+            uint64_t dt = now - m.lastStepMicros;
+            m.lastStepMicros = now;
+            bool lost = m.minStepUs &&
+                        (dt < m.minStepUs || (dt < m.minStepUs * 11 / 10 && m.halfSteps % 64 == 0));
+            if (lost && (delta == 1 || delta == 7)) {
+                m.lostSteps++;
+            } else if (delta == 1) {
+                m.position = (m.position + 1) % STEPS_PER_REV;
+            } else if (delta == 7) {
+                m.position = (m.position - 1 + STEPS_PER_REV) % STEPS_PER_REV;
+            } else {
+                m.skippedPhases++;
+            }
+            m.halfSteps++;
+        }
+        m.phase = phase;
+    }
+}
+
+void SimPCF8575::onWrite(const uint8_t* data, size_t len) {
+    // Every complete 16‑bit word is latched on ACK (burst writes allowed)
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        applyFrame((uint16_t)data[i] | ((uint16_t)data[i + 1] << 8));
+    }
+}
+
+size_t SimPCF8575::onRead(uint8_t* data, size_t len) {
+    // Quasi‑bidirectional: a pin written high reads the external level
+    uint16_t pins = latch;
+    for (const SimMotor& m : motors) {
+        if (hallActive(m)) pins &= ~(1 << m.hallPin);
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (i % 2 == 0) ? (pins & 0xFF) : (pins >> 8);
+    }
+    return len;
+}
+
+// -------------------------------------------------------------------
+// DS3231
+// -------------------------------------------------------------------
+static uint8_t toBcd(int v) { return (uint8_t)(((v / 10) << 4) | (v % 10)); }
+static int fromBcd(uint8_t v) { return (v >> 4) * 10 + (v & 0x0F); }
+
+time_t SimDS3231::now() const {
+    return baseEpoch + (time_t)((halNowMicros() - baseMicros) / 1000000ULL);
+}
+
+void SimDS3231::setTime(time_t epoch) {
+    baseEpoch = epoch;
+    baseMicros = halNowMicros();
+    oscillatorStopped = false;
+}
+
+void SimDS3231::loadRegisters() {
+    time_t t = now();
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    regs[0] = toBcd(tm.tm_sec);
+    regs[1] = toBcd(tm.tm_min);
+    regs[2] = toBcd(tm.tm_hour);
+    regs[3] = toBcd(tm.tm_wday + 1);
+    regs[4] = toBcd(tm.tm_mday);
+    regs[5] = toBcd(tm.tm_mon + 1);
+    regs[6] = toBcd(tm.tm_year - 100);
+    regs[0x0F] = oscillatorStopped ? 0x80 : 0x00;
+}
+
+void SimDS3231::storeTimeRegisters() {
+    struct tm tm = {};
+    tm.tm_sec = fromBcd(regs[0] & 0x7F);
+    tm.tm_min = fromBcd(regs[1] & 0x7F);
+    tm.tm_hour = fromBcd(regs[2] & 0x3F);
+    tm.tm_mday = fromBcd(regs[4] & 0x3F);
+    tm.tm_mon = fromBcd(regs[5] & 0x1F) - 1;
+    tm.tm_year = fromBcd(regs[6]) + 100;
+    baseEpoch = timegm(&tm);
+    baseMicros = halNowMicros();
+}
+
+void SimDS3231::onWrite(const uint8_t* data, size_t len) {
+    if (len == 0) return;
+    loadRegisters();
+    pointer = data[0];
+    bool timeWritten = false;
+    for (size_t i = 1; i < len; i++) {
+        if (pointer < sizeof(regs)) {
+            regs[pointer] = data[i];
+            if (pointer <= 6) timeWritten = true;
+            if (pointer == 0x0F) oscillatorStopped = (data[i] & 0x80) != 0;
+        }
+        pointer++;
+    }
+    if (timeWritten) storeTimeRegisters();
+}
+
+size_t SimDS3231::onRead(uint8_t* data, size_t len) {
+    loadRegisters();
+    for (size_t i = 0; i < len; i++) {
+        data[i] = pointer < sizeof(regs) ? regs[pointer] : 0;
+        pointer++;
+    }
+    return len;
+}
+
+// -------------------------------------------------------------------
+// Board
+// -------------------------------------------------------------------
+SimBoard& halAttachSimulatedBoard() {
+    static SimBoard board;
+    halAttachI2cDevice(0x20, &board.pcf1);
+    halAttachI2cDevice(0x21, &board.pcf2);
+    halAttachI2cDevice(0x68, &board.rtc);
+    return board;
+}
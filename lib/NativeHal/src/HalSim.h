@@ -0,0 +1,98 @@
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/**
+ * @file HalSim.h
+ * Simulated display hardware for the native build: two PCF8575 expanders,
+ * each driving two ULN2003/28BYJ‑48 motors with a Hall sensor per drum,
+ * and a DS3231 RTC.
+ */
+
+/**
+ * One simulated flap drum: decodes half‑step coil patterns into a
+ * position and drives an active‑low Hall output near position 0. With
+ * minStepUs set, steps closer together than that are lost, and within
+ * 10 % above it every 64th step is lost (a marginal drum).
+ */
+struct SimMotor {
+    int basePin;                 // first of 4 coil pins on the expander
+    int hallPin;                 // active‑low Hall input pin
+    int position;                // half‑steps, 0 … stepsPerRev‑1
+    int phase;                   // last decoded pattern index, ‑1 = coils off
+    uint32_t halfSteps;          // total half‑steps taken
+    uint32_t skippedPhases;      // pattern jumps of more than one half‑step
+    uint32_t minStepUs;          // pull‑out limit: faster steps are lost (0 = none)
+    uint32_t lostSteps;          // steps the rotor did not follow
+    uint64_t lastStepMicros;
+};
+
+class SimPCF8575 : public HalI2cDevice {
+public:
+    static const int STEPS_PER_REV = 4080;
+    static const int HALL_WIDTH = 12;        // half‑steps the magnet covers
+
+    SimPCF8575();
+
+    void onWrite(const uint8_t* data, size_t len) override;
+    size_t onRead(uint8_t* data, size_t len) override;
+    size_t writeUnit() const override { return 2; }
+
+    SimMotor& motor(int i) { return motors[i]; }
+    uint16_t outputLatch() const { return latch; }
+    uint32_t frameCount() const { return frames; }
+
+    /** Put a drum at an arbitrary position (e.g. after a power cut). */
+    void setPosition(int motorIndex, int position);
+
+private:
+    void applyFrame(uint16_t word);
+    bool hallActive(const SimMotor& m) const;
+
+    uint16_t latch = 0xFFFF;
+    SimMotor motors[2];
+    uint32_t frames = 0;
+};
+
+class SimDS3231 : public HalI2cDevice {
+public:
+    void onWrite(const uint8_t* data, size_t len) override;
+    size_t onRead(uint8_t* data, size_t len) override;
+
+    /** Set the RTC (clears the oscillator‑stop flag). */
+    void setTime(time_t epoch);
+    /** Simulate a dead backup battery. */
+    void loseTime() { oscillatorStopped = true; }
+    time_t now() const;
+
+private:
+    void loadRegisters();
+    void storeTimeRegisters();
+
+    uint8_t regs[0x13] = {};
+    uint8_t pointer = 0;
+    time_t baseEpoch = 0;
+    uint64_t baseMicros = 0;
+    bool oscillatorStopped = true;
+};
+
+/**
+ * The complete simulated board.
+ */
+struct SimBoard {
+    SimPCF8575 pcf1;             // 0x20 – segments 0,1
+    SimPCF8575 pcf2;             // 0x21 – segments 2,3
+    SimDS3231 rtc;               // 0x68
+
+    /** Drum for a display segment (0‑3). */
+    SimMotor& segment(int i) { return i < 2 ? pcf1.motor(i) : pcf2.motor(i - 2); }
+};
+
+/**
+ * Create the board (once) and attach its devices to Wire.
+ */
+SimBoard& halAttachSimulatedBoard();
+
+#endif
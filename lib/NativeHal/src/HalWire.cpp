@@ -0,0 +1,146 @@
+#include <Wire.h>
+
+TwoWire Wire;
+
+static HalI2cDevice* devices[128] = {};
+static HalI2cStats stats[128] = {};
+static uint64_t busMicros = 0;
+static uint32_t faultCount[128] = {};
+static uint8_t faultCode[128] = {};
+
+void halI2cInjectFaults(uint8_t address, uint32_t count, uint8_t code) {
+    faultCount[address & 0x7F] = count;
+    faultCode[address & 0x7F] = code;
+}
+
+// Consume one injected fault; returns its code or 0
+static uint8_t takeFault(uint8_t address) {
+    if (faultCount[address] == 0) return 0;
+    faultCount[address]--;
+    return faultCode[address];
+}
+
+void halAttachI2cDevice(uint8_t address, HalI2cDevice* device) {
+    if (address < 128) devices[address] = device;
+}
+
+void halDetachI2cDevices() {
+    memset(devices, 0, sizeof(devices));
+}
+
+const HalI2cStats& halI2cStats(uint8_t address) {
+    return stats[address & 0x7F];
+}
+
+void halResetI2cStats() {
+    memset(stats, 0, sizeof(stats));
+    busMicros = 0;
+}
+
+uint64_t halI2cBusMicros() {
+    return busMicros;
+}
+
+bool TwoWire::begin(int, int, uint32_t frequency) {
+    if (frequency) clockHz = frequency;
+    return true;
+}
+
+// -------------------------------------------------------------------
+// Wire time: START + address + data bytes (9 clocks each) + STOP.
+// -------------------------------------------------------------------
+void TwoWire::chargeBusTime(size_t bytes) {
+    uint64_t bits = 2 + (uint64_t)(bytes + 1) * 9;
+    uint64_t us = (bits * 1000000ULL + clockHz - 1) / clockHz;
+    busMicros += us;
+    halAdvanceMicros(us);
+}
+
+// Advance to `bits` clocks into the transaction; same rounding as
+// chargeBusTime() for the transaction as a whole
+void TwoWire::chargeBitsTo(uint64_t bits, uint64_t& chargedUs) {
+    uint64_t us = (bits * 1000000ULL + clockHz - 1) / clockHz;
+    busMicros += us - chargedUs;
+    halAdvanceMicros(us - chargedUs);
+    chargedUs = us;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    txAddress = address & 0x7F;
+    txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+    if (txLength >= sizeof(txBuffer)) return 0;
+    txBuffer[txLength++] = b;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len) {
+    size_t n = 0;
+    while (n < len && write(data[n])) n++;
+    return n;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+    HalI2cStats& s = stats[txAddress];
+    HalI2cDevice* dev = devices[txAddress];
+    uint8_t fault = takeFault(txAddress);
+    if (fault == 5) {
+        halAdvanceMicros((uint64_t)timeoutMs * 1000ULL);
+        return fault;
+    }
+    if (dev == nullptr || fault != 0) {
+        chargeBusTime(0);
+        s.nacks++;
+        return fault ? fault : 2;   // address NACK, as in the Arduino core
+    }
+    s.writeTransactions++;
+    s.bytesWritten += txLength;
+    size_t unit = dev->writeUnit();
+    if (unit == 0) {
+        chargeBusTime(txLength);
+        dev->onWrite(txBuffer, txLength);
+        return 0;
+    }
+
+    // START + address, each unit at its ACK, then STOP
+    uint64_t bits = 1 + 9;
+    uint64_t chargedUs = 0;
+    chargeBitsTo(bits, chargedUs);
+    for (size_t i = 0; i < txLength; i += unit) {
+        size_t n = txLength - i < unit ? txLength - i : unit;
+        bits += n * 9;
+        chargeBitsTo(bits, chargedUs);
+        dev->onWrite(txBuffer + i, n);
+    }
+    chargeBitsTo(bits + 1, chargedUs);
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool) {
+    address &= 0x7F;
+    rxLength = 0;
+    rxIndex = 0;
+    HalI2cStats& s = stats[address];
+    HalI2cDevice* dev = devices[address];
+    if (dev == nullptr || takeFault(address) != 0) {
+        chargeBusTime(0);
+        s.nacks++;
+        return 0;
+    }
+    if (quantity > sizeof(rxBuffer)) quantity = sizeof(rxBuffer);
+    rxLength = dev->onRead(rxBuffer, quantity);
+    chargeBusTime(rxLength);
+    s.readTransactions++;
+    s.bytesRead += rxLength;
+    return (uint8_t)rxLength;
+}
+
+int TwoWire::available() {
+    return (int)(rxLength - rxIndex);
+}
+
+int TwoWire::read() {
+    return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1;
+}
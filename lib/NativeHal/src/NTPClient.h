@@ -0,0 +1,24 @@
+#ifndef HAL_NTPCLIENT_H
+#define HAL_NTPCLIENT_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+
+/**
+ * Native NTP client: never gets an answer (host build is offline).
+ * Time comes from the virtual clock / mock clock provider instead.
+ */
+class NTPClient {
+public:
+    NTPClient(WiFiUDP&, const char*, long offset = 0, unsigned long = 60000) : offset(offset) {}
+    void begin() {}
+    bool update() { return false; }
+    bool forceUpdate() { return false; }
+    bool isTimeSet() const { return false; }
+    unsigned long getEpochTime() const { return (unsigned long)time(nullptr); }
+
+private:
+    long offset;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef HAL_PREFERENCES_H
+#define HAL_PREFERENCES_H
+
+#include <Arduino.h>
+
+/**
+ * @file Preferences.h
+ * In‑memory NVS. The store is process‑wide, so a new Preferences instance
+ * (a simulated reboot) sees what the previous one committed.
+ */
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+
+    bool isKey(const char* key);
+    bool remove(const char* key);
+    bool clear();
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+    size_t getBytesLength(const char* key);
+
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { uint8_t v = value; return putBytes(key, &v, 1); }
+
+    uint32_t getUInt(const char* key, uint32_t def = 0) { return getScalar(key, def); }
+    int32_t getInt(const char* key, int32_t def = 0) { return getScalar(key, def); }
+    uint8_t getUChar(const char* key, uint8_t def = 0) { return getScalar(key, def); }
+    bool getBool(const char* key, bool def = false) { return getScalar<uint8_t>(key, def) != 0; }
+
+private:
+    template <typename T>
+    T getScalar(const char* key, T def) {
+        T v;
+        return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : def;
+    }
+
+    std::string ns;
+    bool opened = false;
+    bool readOnly = false;
+};
+
+/**
+ * Number of put*() calls that reached the store (flash writes on target).
+ */
+uint32_t halNvsWriteCount();
+
+/**
+ * Erase the whole in‑memory NVS (factory reset).
+ */
+void halNvsErase();
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef HAL_WIFI_H
+#define HAL_WIFI_H
+
+#include <Arduino.h>
+
+/**
+ * @file WiFi.h
+ * Native stand‑in: the host firmware is always offline.
+ */
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class HalWiFi {
+public:
+    wl_status_t status() const { return WL_DISCONNECTED; }
+    String localIP() const { return String("127.0.0.1"); }
+};
+
+extern HalWiFi WiFi;
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HAL_WIFIUDP_H
+#define HAL_WIFIUDP_H
+
+#include <Arduino.h>
+
+class WiFiUDP {
+public:
+    uint8_t begin(uint16_t) { return 1; }
+    void stop() {}
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef HAL_WIRE_H
+#define HAL_WIRE_H
+
+#include <Arduino.h>
+
+/**
+ * @file Wire.h
+ * Native I2C master. Transactions are routed to simulated devices
+ * registered with halAttachI2cDevice(); each transfer advances the
+ * virtual clock by its time on the wire at the configured bus clock.
+ */
+
+/**
+ * Simulated I2C slave.
+ */
+class HalI2cDevice {
+public:
+    virtual ~HalI2cDevice() {}
+    /** Master wrote len bytes (after the address byte). */
+    virtual void onWrite(const uint8_t* data, size_t len) = 0;
+    /** Master reads up to len bytes; returns bytes supplied. */
+    virtual size_t onRead(uint8_t* data, size_t len) = 0;
+    /**
+     * Bytes the device acts on as soon as they are ACKed (PCF8575: one
+     * 16‑bit word). Non‑zero hands writes over in such units, each at
+     * its own time on the virtual clock; 0 = the whole write at STOP.
+     */
+    virtual size_t writeUnit() const { return 0; }
+};
+
+/**
+ * Per‑address bus statistics.
+ */
+struct HalI2cStats {
+    uint32_t writeTransactions;
+    uint32_t readTransactions;
+    uint32_t bytesWritten;       // payload bytes, address byte excluded
+    uint32_t bytesRead;
+    uint32_t nacks;              // transactions to an address with no device
+};
+
+void halAttachI2cDevice(uint8_t address, HalI2cDevice* device);
+
+/**
+ * Make the next `count` transactions to an address fail with the given
+ * endTransmission() code (2 = NACK, 5 = timeout, …).
+ */
+void halI2cInjectFaults(uint8_t address, uint32_t count, uint8_t code);
+void halDetachI2cDevices();
+const HalI2cStats& halI2cStats(uint8_t address);
+void halResetI2cStats();
+
+/**
+ * Total time spent on the bus since the last halResetI2cStats(), in µs.
+ */
+uint64_t halI2cBusMicros();
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    void end() {}
+    void setClock(uint32_t frequency) { clockHz = frequency; }
+    void setTimeOut(uint16_t ms) { timeoutMs = ms; }
+    uint32_t getClock() const { return clockHz; }
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    size_t write(uint8_t b);
+    size_t write(const uint8_t* data, size_t len);
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+    uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t)address, (uint8_t)quantity); }
+    int available();
+    int read();
+
+private:
+    void chargeBusTime(size_t bytes);
+    void chargeBitsTo(uint64_t bits, uint64_t& chargedUs);
+
+    uint32_t clockHz = 100000;
+    uint16_t timeoutMs = 50;
+    uint8_t txAddress = 0;
+    uint8_t txBuffer[256];          // room for a PCF8575 burst
+    size_t txLength = 0;
+    uint8_t rxBuffer[128];
+    size_t rxLength = 0;
+    size_t rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef HAL_ESP_ATTR_H
+#define HAL_ESP_ATTR_H
+
+// Memory placement attributes have no meaning on the host
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+#define EXT_RAM_ATTR
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef HAL_ESP_SYSTEM_H
+#define HAL_ESP_SYSTEM_H
+
+/**
+ * Reset reasons (subset of ESP‑IDF esp_reset_reason_t).
+ */
+typedef enum {
+    ESP_RST_UNKNOWN = 0,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO
+} esp_reset_reason_t;
+
+/**
+ * Reason of the last (simulated) reset. Defaults to ESP_RST_POWERON.
+ */
+esp_reset_reason_t esp_reset_reason();
+
+/**
+ * Native only: choose what esp_reset_reason() reports on the next boot.
+ */
+void halSetResetReason(esp_reset_reason_t reason);
+
+#endif
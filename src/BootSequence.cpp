@@ -0,0 +1,229 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <WiFi.h>
+
+#include "BootSequence.h"
+#include "ConfigManager.h"
+#include "SegmentController.h"
+#include "TimerController.h"
+#include "ClockManager.h"
+#include "I2CBus.h"
+#include "TaskPlan.h"
+#include "StepTrace.h"
+#include "MemoryPlan.h"
+#include "DisplaySync.h"
+#include "EventStore.h"
+
+// External references
+extern ConfigManager configManager;
+
+// Stage implementations living in other modules
+void setupLittleFS();
+bool setupWiFi();
+void setupMDNS();
+void setupWebServer();
+
+#define STAGE_BIT(id) (1UL << (id))
+
+typedef bool (*BootStageFn)();
+
+/**
+ * Static description of a stage: what it needs and where it runs.
+ */
+struct BootStageDef {
+    BootStageId id;
+    const char* name;
+    uint32_t dependsOn;       // mask of STAGE_BIT()s that must be done first
+    bool background;
+    BootStageFn run;
+};
+
+// -------------------------------------------------------------------
+// Stage bodies
+// -------------------------------------------------------------------
+static bool stageI2C() {
+    // Initialize I2C for PCF8575 and DS3231
+    i2cBusBegin(8, 9, 400000);
+    return true;
+}
+
+static bool stageLittleFS() {
+    setupLittleFS();
+    recordEvent(EVT_BOOT, EVENT_NO_CHANNEL, (int32_t)esp_reset_reason());
+    return setupEventStore();
+}
+
+static bool stageConfig() {
+    if (!configManager.begin()) return false;
+    configManager.load();
+    return true;
+}
+
+static bool stageClock() {
+    // Seed the system clock from the RTC so the countdown is right
+    // before the network is up; NTP later disciplines the RTC.
+    clockManager.addProvider(&ntpClock);
+    clockManager.addProvider(&rtcClock);
+    clockManager.beginDisciplineTask();
+    return clockManager.seedSystemClock();
+}
+
+static bool stageSegments() {
+    setupStepTrace();                // trace buffer, reserved up front
+    setupSegmentController();        // motors, Hall sensors, PCFs
+    return true;
+}
+
+static bool stageTimer() {
+    setupTimerController();          // restore run state from NVS
+    return true;
+}
+
+static bool stageWiFi() {
+    // Keep retrying in the background instead of rebooting – the display
+    // keeps counting while the network is down.
+    while (!setupWiFi()) {
+        vTaskDelay(pdMS_TO_TICKS(30000));
+    }
+    return true;
+}
+
+static bool stageMDNS() {
+    setupMDNS();                     // http://timer.local
+    return true;
+}
+
+static bool stageNTP() {
+    return syncTimeAtBoot();
+}
+
+static bool stageWebServer() {
+    setupWebServer();                // REST API and WebSocket
+    Serial.print("Open: http://");
+    Serial.println(WiFi.localIP());
+    Serial.println("Or: http://timer.local");
+    return true;
+}
+
+static bool stageSync() {
+    return setupDisplaySync();       // multicast group, if a role is set
+}
+
+static const BootStageDef stageDefs[STAGE_COUNT] = {
+    { STAGE_I2C,       "i2c",       0,                                       false, stageI2C },
+    { STAGE_LITTLEFS,  "littlefs",  0,                                       false, stageLittleFS },
+    { STAGE_CONFIG,    "config",    0,                                       false, stageConfig },
+    { STAGE_CLOCK,     "clock",     STAGE_BIT(STAGE_I2C),                    false, stageClock },
+    { STAGE_SEGMENTS,  "segments",  STAGE_BIT(STAGE_I2C),                    false, stageSegments },
+    { STAGE_TIMER,     "timer",     STAGE_BIT(STAGE_CONFIG) | STAGE_BIT(STAGE_CLOCK) | STAGE_BIT(STAGE_SEGMENTS), false, stageTimer },
+    { STAGE_WIFI,      "wifi",      0,                                       true,  stageWiFi },
+    { STAGE_MDNS,      "mdns",      STAGE_BIT(STAGE_WIFI),                   true,  stageMDNS },
+    { STAGE_NTP,       "ntp",       STAGE_BIT(STAGE_WIFI) | STAGE_BIT(STAGE_TIMER), true, stageNTP },
+    // Handlers reach the motion and calibration tasks: not before they exist
+    { STAGE_WEBSERVER, "webserver", STAGE_BIT(STAGE_WIFI) | STAGE_BIT(STAGE_LITTLEFS) | STAGE_BIT(STAGE_CONFIG) |
+                                    STAGE_BIT(STAGE_CLOCK) | STAGE_BIT(STAGE_SEGMENTS) | STAGE_BIT(STAGE_TIMER), true, stageWebServer },
+    { STAGE_SYNC,      "sync",      STAGE_BIT(STAGE_WIFI) | STAGE_BIT(STAGE_TIMER), true, stageSync },
+};
+
+static BootStageReport reports[STAGE_COUNT];
+static EventGroupHandle_t bootEvents = NULL;
+static StaticEventGroup_t bootEventsStorage;
+static uint32_t bootStartMs = 0;
+static bool reportPrinted = false;
+static portMUX_TYPE reportMux = portMUX_INITIALIZER_UNLOCKED;
+
+// -------------------------------------------------------------------
+// Execute one stage and record its timing.
+// -------------------------------------------------------------------
+static void executeStage(const BootStageDef& def) {
+    BootStageReport& r = reports[def.id];
+    r.startMs = millis() - bootStartMs;
+    r.ok = def.run();
+    r.durationMs = millis() - bootStartMs - r.startMs;
+    r.done = true;
+    Serial.printf("[BOOT] %-10s %s in %lu ms\n", def.name, r.ok ? "ok" : "FAILED",
+                  (unsigned long)r.durationMs);
+    xEventGroupSetBits(bootEvents, STAGE_BIT(def.id));
+}
+
+// -------------------------------------------------------------------
+// Background stage task: wait for dependencies, run, exit.
+// -------------------------------------------------------------------
+static void bootStageTask(void *pvParameters) {
+    const BootStageDef* def = (const BootStageDef*)pvParameters;
+    if (def->dependsOn) {
+        xEventGroupWaitBits(bootEvents, def->dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    executeStage(*def);
+
+    // The last background stage to finish prints the report
+    bool printNow = false;
+    portENTER_CRITICAL(&reportMux);
+    if (isBootComplete() && !reportPrinted) {
+        reportPrinted = true;
+        printNow = true;
+    }
+    portEXIT_CRITICAL(&reportMux);
+    if (printNow) {
+        printBootReport();
+        printMemoryBudget();
+    }
+    vTaskDelete(NULL);
+}
+
+void runBootSequence() {
+    bootStartMs = millis();
+    bootEvents = xEventGroupCreateStatic(&bootEventsStorage);
+
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        reports[i].name = stageDefs[i].name;
+        reports[i].background = stageDefs[i].background;
+        reports[i].done = false;
+        reports[i].ok = false;
+        reports[i].startMs = 0;
+        reports[i].durationMs = 0;
+    }
+
+    // Launch network stages first so WiFi association overlaps local init
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (!stageDefs[i].background) continue;
+        startPlannedTask(TASK_BOOT_STAGE, bootStageTask, (void*)&stageDefs[i],
+                         NULL, stageDefs[i].name);   // core 0, with the WiFi stack
+    }
+
+    // Local stages in table order (the table is dependency‑sorted)
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (stageDefs[i].background) continue;
+        executeStage(stageDefs[i]);
+    }
+
+    // Budget of everything planned so far – printed even if WiFi never
+    // comes up; the network stages' blocks follow in the final report
+    printMemoryBudget();
+}
+
+bool isBootComplete() {
+    if (bootEvents == NULL) return false;
+    const uint32_t all = STAGE_BIT(STAGE_COUNT) - 1;
+    return (xEventGroupGetBits(bootEvents) & all) == all;
+}
+
+bool isBootStageDone(BootStageId id) {
+    if (bootEvents == NULL) return false;
+    return (xEventGroupGetBits(bootEvents) & STAGE_BIT(id)) != 0;
+}
+
+const BootStageReport& getBootStageReport(BootStageId id) {
+    return reports[id];
+}
+
+void printBootReport() {
+    Serial.println("[BOOT] Stage report (ms since boot start):");
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        const BootStageReport& r = reports[i];
+        Serial.printf("  %-10s %-4s start %6lu  took %6lu  %s\n",
+                      r.name, r.background ? "bg" : "fg",
+                      (unsigned long)r.startMs, (unsigned long)r.durationMs,
+                      r.done ? (r.ok ? "ok" : "FAILED") : "pending");
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <Arduino.h>
+
+/**
+ * @file BootSequence.h
+ * Staged boot: local stages (config, display, timer) run synchronously
+ * from setup(), network stages run concurrently in background tasks once
+ * their dependencies have finished.
+ */
+
+/**
+ * Boot stage identifiers (also bit positions in the completion mask).
+ */
+enum BootStageId {
+    STAGE_I2C = 0,
+    STAGE_LITTLEFS,
+    STAGE_CONFIG,
+    STAGE_CLOCK,
+    STAGE_SEGMENTS,
+    STAGE_TIMER,
+    STAGE_WIFI,
+    STAGE_MDNS,
+    STAGE_NTP,
+    STAGE_WEBSERVER,
+    STAGE_SYNC,
+    STAGE_COUNT
+};
+
+/**
+ * Timing record of one boot stage.
+ */
+struct BootStageReport {
+    const char* name;
+    bool background;          // runs in its own task
+    bool done;
+    bool ok;
+    uint32_t startMs;         // millis() when the stage began
+    uint32_t durationMs;
+};
+
+/**
+ * Run all boot stages. Returns once the local stages are complete;
+ * network stages continue in the background.
+ */
+void runBootSequence();
+
+/**
+ * True once every stage (including background ones) has finished.
+ */
+bool isBootComplete();
+
+/**
+ * True once the given stage has finished (successfully or not).
+ */
+bool isBootStageDone(BootStageId id);
+
+/**
+ * Get the timing record of a stage.
+ */
+const BootStageReport& getBootStageReport(BootStageId id);
+
+/**
+ * Print the per‑stage timing report to Serial.
+ */
+void printBootReport();
+
+#endif
@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <sys/time.h>
+
+#include "ClockManager.h"
+#include "TaskPlan.h"
+
+ClockManager clockManager;
+DS3231ClockProvider rtcClock;
+NtpClockProvider ntpClock;
+
+static const unsigned long RTC_REWRITE_INTERVAL_MS = 24UL * 3600UL * 1000UL;
+
+bool ClockManager::addProvider(ClockProvider* provider) {
+    if (count >= CLOCK_MAX_PROVIDERS || provider == nullptr) return false;
+
+    // Keep the list sorted by quality, best first
+    int pos = count;
+    while (pos > 0 && providers[pos - 1]->quality() < provider->quality()) {
+        providers[pos] = providers[pos - 1];
+        pos--;
+    }
+    providers[pos] = provider;
+    count++;
+    provider->begin();
+    return true;
+}
+
+static int64_t systemMillis() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// -------------------------------------------------------------------
+// Write a provider at the next whole second of the system clock, so a
+// DS3231 (whose divider restarts on the write) rolls over in phase with
+// it. Blocks up to one second.
+// -------------------------------------------------------------------
+static bool writeAligned(ClockProvider* p) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    time_t next = tv.tv_sec + 1;
+    delay((1000000 - tv.tv_usec) / 1000);
+    for (;;) {
+        gettimeofday(&tv, nullptr);
+        if (tv.tv_sec >= next) break;
+        delayMicroseconds(50);
+    }
+    return p->write(tv.tv_sec);
+}
+
+bool ClockManager::seedSystemClock() {
+    for (int i = 0; i < count; i++) {
+        time_t epoch;
+        struct timeval tv;
+        bool aligned = providers[i]->readEdge(epoch, CLOCK_EDGE_TIMEOUT_MS);
+        if (aligned) {
+            tv = {epoch, 0};
+        } else if (providers[i]->read(epoch)) {
+            tv = {epoch, CLOCK_UNKNOWN_PHASE_US};
+        } else {
+            continue;
+        }
+        settimeofday(&tv, nullptr);
+        active = providers[i];
+        Serial.printf("[CLOCK] System clock seeded from %s: %lld (%s)\n",
+                      active->name(), (long long)epoch, aligned ? "at seconds edge" : "±0.5 s");
+        return true;
+    }
+    Serial.println("[CLOCK] No valid time source at boot");
+    return false;
+}
+
+#ifndef NATIVE_BUILD
+void ClockManager::beginDisciplineTask() {
+    if (task == nullptr) startPlannedTask(TASK_CLOCK, disciplineTask, this, &task);
+}
+
+// -------------------------------------------------------------------
+// Clock task: sleeps until discipline() hands over a request.
+// -------------------------------------------------------------------
+void ClockManager::disciplineTask(void* param) {
+    ClockManager* self = (ClockManager*)param;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        ClockProvider* source = self->pendingSource;
+        if (source) self->runDiscipline(source);
+    }
+}
+#else
+void ClockManager::beginDisciplineTask() {}     // host build: discipline() runs inline
+#endif
+
+void ClockManager::discipline(ClockProvider* source, time_t epoch) {
+    if (source == nullptr) return;
+    if (active == nullptr || source->quality() >= active->quality()) {
+        active = source;
+    }
+
+    // The system clock is the reference: it has sub‑second phase, the
+    // source's epoch does not
+    int64_t offsetMs = (int64_t)epoch * 1000 - systemMillis();
+    if (offsetMs > 1500 || offsetMs < -1500) {
+        Serial.printf("[CLOCK] System clock disagrees with %s by %lld ms – not disciplining\n",
+                      source->name(), (long long)offsetMs);
+        return;
+    }
+
+#ifndef NATIVE_BUILD
+    if (task != nullptr) {
+        pendingSource = source;     // requests while one runs collapse into one
+        xTaskNotifyGive(task);
+        return;
+    }
+#endif
+    runDiscipline(source);
+}
+
+// -------------------------------------------------------------------
+// Check and rewrite the lower‑quality providers (clock task). Blocks up
+// to ~2 s for the edge read and the aligned write.
+// -------------------------------------------------------------------
+void ClockManager::runDiscipline(ClockProvider* source) {
+    for (int i = 0; i < count; i++) {
+        ClockProvider* p = providers[i];
+        if (p == source || p->quality() >= source->quality()) continue;
+
+        unsigned long nowMs = millis();
+        bool stale = !everWritten[i] || (nowMs - lastWriteMs[i] >= RTC_REWRITE_INTERVAL_MS);
+        bool phaseDue = !everPhaseChecked[i] || (nowMs - lastPhaseCheckMs[i] >= CLOCK_PHASE_CHECK_MS);
+
+        // Whole seconds first (no wait); to the ms at a seconds edge hourly
+        time_t current;
+        bool valid = p->read(current);
+        int64_t driftMs = valid ? ((int64_t)current - (int64_t)(systemMillis() / 1000)) * 1000 : 0;
+        bool exact = false;
+        if (valid && driftMs == 0 && !stale && phaseDue) {
+            everPhaseChecked[i] = true;
+            lastPhaseCheckMs[i] = nowMs;
+            if (p->readEdge(current, CLOCK_EDGE_TIMEOUT_MS)) {
+                driftMs = (int64_t)current * 1000 - systemMillis();
+                exact = true;
+            }
+        }
+        if (valid) lastDriftMillis = (long)driftMs;
+
+        bool off = driftMs > CLOCK_DRIFT_TOLERANCE_MS || driftMs < -CLOCK_DRIFT_TOLERANCE_MS;
+        if (valid && !off && !stale) continue;
+
+        if (writeAligned(p)) {
+            writes++;
+            everWritten[i] = true;
+            lastWriteMs[i] = millis();
+            everPhaseChecked[i] = true;          // in phase as of this write
+            lastPhaseCheckMs[i] = lastWriteMs[i];
+            Serial.printf("[CLOCK] %s disciplined from %s (drift %lld ms%s)\n",
+                          p->name(), source->name(), (long long)driftMs, exact ? "" : ", whole seconds");
+        }
+    }
+}
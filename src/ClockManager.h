@@ -0,0 +1,91 @@
+#ifndef CLOCK_MANAGER_H
+#define CLOCK_MANAGER_H
+
+#include <Arduino.h>
+#include "ClockProvider.h"
+
+/**
+ * @file ClockManager.h
+ * Ranks the registered clock providers, seeds the system clock at boot and
+ * keeps writable providers (RTC) disciplined from better sources.
+ */
+
+#define CLOCK_MAX_PROVIDERS 4
+#define CLOCK_EDGE_TIMEOUT_MS       1100        // wait for one seconds rollover
+#define CLOCK_UNKNOWN_PHASE_US      500000      // whole‑second source: assume mid‑second
+#define CLOCK_DRIFT_TOLERANCE_MS    10          // rewrite the RTC beyond this
+#define CLOCK_PHASE_CHECK_MS        3600000UL   // ms‑level drift check (clock task, ≤ 2 s)
+
+class ClockManager {
+public:
+    /**
+     * Register a provider (not owned). Call before seedSystemClock().
+     */
+    bool addProvider(ClockProvider* provider);
+
+    /**
+     * Set the system clock from the best provider that has a valid time.
+     * A provider with a seconds edge (DS3231) is read at its rollover, so
+     * the system clock starts within a few ms of it; otherwise the second
+     * is taken as mid‑second (±0.5 s). Blocks up to CLOCK_EDGE_TIMEOUT_MS.
+     * @return true if the clock was set.
+     */
+    bool seedSystemClock();
+
+    /**
+     * Start the clock task (low priority, network core) that runs the
+     * blocking part of discipline(). Without it (host build) discipline()
+     * does the work on the caller.
+     */
+    void beginDisciplineTask();
+
+    /**
+     * A provider just delivered a fresh reference time `epoch`, and the
+     * system clock was set from it (or agrees with it within a second –
+     * otherwise nothing is written). Every writable provider of lower
+     * quality is checked against the system clock and rewritten, at a
+     * system clock second boundary, when it is off by a whole second, when
+     * the hourly edge check finds more than CLOCK_DRIFT_TOLERANCE_MS, or
+     * when it was not written for a day. The edge check and the aligned
+     * write take up to about 2 s; they run on the clock task, so the
+     * caller (loop) only hands the request over.
+     */
+    void discipline(ClockProvider* source, time_t epoch);
+
+    /** Provider that last set the system clock (or nullptr). */
+    ClockProvider* activeSource() const { return active; }
+
+    int providerCount() const { return count; }
+    ClockProvider* provider(int i) const { return (i >= 0 && i < count) ? providers[i] : nullptr; }
+
+    /** Drift (provider − reference) seen at the last discipline, in seconds. */
+    long lastDrift() const { return (long)(lastDriftMillis / 1000); }
+
+    /** Same in ms; whole seconds unless measured at a seconds edge. */
+    long lastDriftMs() const { return lastDriftMillis; }
+
+    /** Number of RTC writes performed by discipline(). */
+    uint32_t disciplineWrites() const { return writes; }
+
+private:
+    void runDiscipline(ClockProvider* source);
+    static void disciplineTask(void* param);
+
+    ClockProvider* volatile pendingSource = nullptr;
+    TaskHandle_t task = nullptr;
+    ClockProvider* providers[CLOCK_MAX_PROVIDERS] = {};
+    int count = 0;
+    ClockProvider* active = nullptr;
+    long lastDriftMillis = 0;
+    uint32_t writes = 0;
+    unsigned long lastWriteMs[CLOCK_MAX_PROVIDERS] = {};
+    bool everWritten[CLOCK_MAX_PROVIDERS] = {};
+    unsigned long lastPhaseCheckMs[CLOCK_MAX_PROVIDERS] = {};
+    bool everPhaseChecked[CLOCK_MAX_PROVIDERS] = {};
+};
+
+extern ClockManager clockManager;
+extern DS3231ClockProvider rtcClock;
+extern NtpClockProvider ntpClock;
+
+#endif
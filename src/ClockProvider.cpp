@@ -0,0 +1,130 @@
+#include <Arduino.h>
+#include <NTPClient.h>
+
+#include "ClockProvider.h"
+#include "I2CBus.h"
+
+extern NTPClient timeClient;
+
+#define DS3231_ADDRESS  0x68
+#define DS3231_REG_TIME 0x00
+#define DS3231_REG_STATUS 0x0F
+#define DS3231_OSF      0x80        // oscillator stopped – time invalid
+
+// -------------------------------------------------------------------
+// BCD helpers
+// -------------------------------------------------------------------
+static uint8_t bcdToBin(uint8_t v) { return (v >> 4) * 10 + (v & 0x0F); }
+static uint8_t binToBcd(uint8_t v) { return ((v / 10) << 4) | (v % 10); }
+
+// -------------------------------------------------------------------
+// Calendar <-> epoch without touching the TZ (days from civil, H. Hinnant).
+// -------------------------------------------------------------------
+static int64_t daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t)era * 146097 + (int64_t)doe - 719468;
+}
+
+static void civilFromDays(int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)(yoe + era * 400) + (m <= 2);
+}
+
+// -------------------------------------------------------------------
+// DS3231
+// -------------------------------------------------------------------
+bool DS3231ClockProvider::begin() {
+    present = i2cWrite(DS3231_ADDRESS, NULL, 0);
+    Serial.printf("[CLOCK] DS3231 %s\n", present ? "found" : "not found");
+    return present;
+}
+
+// Oscillator‑stop flag clear: the time registers hold a valid time
+bool DS3231ClockProvider::valid() {
+    if (!present) return false;
+    uint8_t status;
+    if (!i2cReadRegister(DS3231_ADDRESS, DS3231_REG_STATUS, &status, 1)) return false;
+    return (status & DS3231_OSF) == 0;       // set: battery died or first power‑up
+}
+
+bool DS3231ClockProvider::read(time_t& epoch) {
+    if (!valid()) return false;
+
+    uint8_t r[7];
+    if (!i2cReadRegister(DS3231_ADDRESS, DS3231_REG_TIME, r, sizeof(r))) return false;
+
+    uint8_t sec   = bcdToBin(r[0] & 0x7F);
+    uint8_t min   = bcdToBin(r[1] & 0x7F);
+    uint8_t hour  = bcdToBin(r[2] & 0x3F);   // 24h mode, r[3] = day of week
+    uint8_t date  = bcdToBin(r[4] & 0x3F);
+    uint8_t month = bcdToBin(r[5] & 0x1F);
+    uint8_t year  = bcdToBin(r[6]);
+
+    int64_t days = daysFromCivil(2000 + year, month, date);
+    epoch = (time_t)(days * 86400 + hour * 3600 + min * 60 + sec);
+    return true;
+}
+
+// The seconds register is the only sub‑second information the DS3231
+// gives: poll it every millisecond until it changes.
+bool DS3231ClockProvider::readEdge(time_t& epoch, uint32_t timeoutMs) {
+    if (!valid()) return false;
+
+    uint8_t first, sec;
+    if (!i2cReadRegister(DS3231_ADDRESS, DS3231_REG_TIME, &first, 1)) return false;
+    unsigned long start = millis();
+    while (millis() - start < timeoutMs) {
+        delay(1);
+        if (!i2cReadRegister(DS3231_ADDRESS, DS3231_REG_TIME, &sec, 1)) return false;
+        if (sec != first) return read(epoch);     // next rollover is ~1 s away
+    }
+    return false;
+}
+
+// Writing the seconds register restarts the DS3231's sub‑second divider:
+// the next rollover comes one second after the write.
+bool DS3231ClockProvider::write(time_t epoch) {
+    if (!present) return false;
+
+    int64_t days = (int64_t)epoch / 86400;
+    int32_t secs = (int32_t)((int64_t)epoch % 86400);
+    int y; unsigned m, d;
+    civilFromDays(days, y, m, d);
+    if (y < 2000 || y > 2099) return false;
+
+    uint8_t frame[8] = {
+        DS3231_REG_TIME,
+        binToBcd(secs % 60),
+        binToBcd((secs / 60) % 60),
+        binToBcd(secs / 3600),
+        binToBcd((uint8_t)(((days + 4) % 7) + 1)),   // 1970‑01‑01 was Thursday
+        binToBcd(d),
+        binToBcd(m),
+        binToBcd(y - 2000)
+    };
+    if (!i2cWrite(DS3231_ADDRESS, frame, sizeof(frame))) return false;
+
+    // Clear oscillator‑stop flag now that the time is valid
+    uint8_t status[2] = {DS3231_REG_STATUS, 0x00};
+    return i2cWrite(DS3231_ADDRESS, status, sizeof(status));
+}
+
+// -------------------------------------------------------------------
+// NTP
+// -------------------------------------------------------------------
+bool NtpClockProvider::read(time_t& epoch) {
+    if (!timeClient.isTimeSet()) return false;
+    epoch = (time_t)timeClient.getEpochTime();
+    return true;
+}
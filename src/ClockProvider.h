@@ -0,0 +1,118 @@
+#ifndef CLOCK_PROVIDER_H
+#define CLOCK_PROVIDER_H
+
+#include <Arduino.h>
+#include <time.h>
+
+/**
+ * @file ClockProvider.h
+ * Pluggable wall‑clock sources. Each provider reports a quality rank;
+ * ClockManager seeds the system clock from the best one available and
+ * disciplines writable lower‑quality sources (the RTC) from better ones.
+ */
+
+/**
+ * Quality ranks – higher is better.
+ */
+enum ClockQuality {
+    CLOCK_QUALITY_NONE = 0,
+    CLOCK_QUALITY_RTC = 50,         // battery‑backed, ±2 ppm, 1 s resolution
+    CLOCK_QUALITY_NTP = 100
+};
+
+/**
+ * Abstract time source.
+ */
+class ClockProvider {
+public:
+    virtual ~ClockProvider() {}
+
+    /** Short name for logs and /api/clock. */
+    virtual const char* name() const = 0;
+
+    /** Quality rank (ClockQuality). */
+    virtual int quality() const = 0;
+
+    /** Probe the hardware/service. Returns false if not present. */
+    virtual bool begin() = 0;
+
+    /** Read current epoch. Returns false if the source has no valid time. */
+    virtual bool read(time_t& epoch) = 0;
+
+    /**
+     * Wait (at most timeoutMs) for the source's seconds to roll over and
+     * return the new second; it is exact at the moment of return, to
+     * within one poll. Sources without a visible seconds edge return false.
+     */
+    virtual bool readEdge(time_t& epoch, uint32_t timeoutMs) {
+        (void)epoch; (void)timeoutMs;
+        return false;
+    }
+
+    /** Set the source from a better one. Read‑only sources return false. */
+    virtual bool write(time_t epoch) { (void)epoch; return false; }
+};
+
+/**
+ * DS3231 on the shared I2C bus (address 0x68).
+ */
+class DS3231ClockProvider : public ClockProvider {
+public:
+    const char* name() const override { return "ds3231"; }
+    int quality() const override { return CLOCK_QUALITY_RTC; }
+    bool begin() override;
+    bool read(time_t& epoch) override;
+    bool readEdge(time_t& epoch, uint32_t timeoutMs) override;
+    bool write(time_t epoch) override;
+
+private:
+    bool valid();
+    bool present = false;
+};
+
+/**
+ * NTP via the global NTPClient (valid only after a successful update).
+ */
+class NtpClockProvider : public ClockProvider {
+public:
+    const char* name() const override { return "ntp"; }
+    int quality() const override { return CLOCK_QUALITY_NTP; }
+    bool begin() override { return true; }
+    bool read(time_t& epoch) override;
+};
+
+/**
+ * Settable clock for host builds and tests.
+ */
+class MockClockProvider : public ClockProvider {
+public:
+    explicit MockClockProvider(int rank = CLOCK_QUALITY_RTC) : rank(rank) {}
+
+    const char* name() const override { return "mock"; }
+    int quality() const override { return rank; }
+    bool begin() override { return true; }
+    bool read(time_t& epoch) override {
+        if (!valid) return false;
+        epoch = now;
+        return true;
+    }
+    bool write(time_t epoch) override {
+        now = epoch;
+        valid = true;
+        writes++;
+        return true;
+    }
+
+    void set(time_t epoch) { now = epoch; valid = true; }
+    void advance(long seconds) { now += seconds; }
+    void invalidate() { valid = false; }
+    uint32_t writeCount() const { return writes; }
+
+private:
+    int rank;
+    time_t now = 0;
+    bool valid = false;
+    uint32_t writes = 0;
+};
+
+#endif
@@ -4,8 +4,10 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include <time.h>
+#include <stddef.h>
 
-extern bool timerStopped; // from TimerController.cpp
+#include "DeviceState.h"
+#include "TimeWarp.h"
 
 /**
  * Units for countdown duration.
@@ -66,8 +68,53 @@ struct TimerConfig {
     }
 };
 
+/**
+ * On‑flash image of the configuration (single NVS blob).
+ * Bump CONFIG_BLOB_VERSION whenever the layout changes and add a
+ * migration branch in ConfigManager::load().
+ */
+#define CONFIG_BLOB_KEY     "cfg"
+#define CONFIG_BLOB_VERSION 1
+
+struct __attribute__((packed)) ConfigBlob {
+    uint8_t  version;
+    uint8_t  durationUnit;
+    uint8_t  syncHour24;
+    uint8_t  flags;                 // CFG_FLAG_* bits
+    int64_t  startTime;
+    int32_t  durationValue;
+    uint32_t crc;                   // CRC32 over all preceding bytes
+};
+
+#define CFG_FLAG_AUTO_SYNC      0x01
+#define CFG_FLAG_USE_CURRENT    0x02
+#define CFG_FLAG_CALIBRATE      0x04
+#define CFG_FLAG_TIMER_RUNNING  0x08
+
+/**
+ * Flash write statistics (exposed via /api/storage).
+ */
+struct StorageStats {
+    uint32_t flashWrites;           // blobs actually written to NVS
+    uint32_t skippedWrites;         // flushes where bytes were unchanged
+    uint32_t coalescedSaves;        // save() calls merged into a pending flush
+    uint32_t writeErrors;           // failed putBytes()
+    uint32_t lastFlushMicros;       // duration of the last NVS write
+
+    StorageStats() : flashWrites(0), skippedWrites(0), coalescedSaves(0),
+                     writeErrors(0), lastFlushMicros(0) {}
+};
+
 /**
  * ConfigManager – saves/loads configuration to/from NVS (Preferences).
+ * The whole config is stored as one CRC‑protected blob; save() only marks
+ * it dirty and the actual write happens from update() at most
+ * SAVE_COALESCE_MS after the first unsaved change, and only if the bytes
+ * differ from what is on flash. A reset inside that window loses the
+ * pending change – including a timer start or stop, so the timer comes
+ * back in its previous state; callers that cannot afford that flush().
+ * save() runs on the web (AsyncTCP) task and update() on the loop task;
+ * the dirty flag and its timestamp are guarded by dirtyMux.
  * Also provides helper methods to compute remaining time.
  */
 class ConfigManager {
@@ -76,11 +123,147 @@ private:
     bool nvsInitialized = false;
 
     TimerConfig config;
+    bool timerRunning = false;
+
+    ConfigBlob lastWritten;         // image currently on flash
+    bool haveLastWritten = false;
+    bool dirty = false;             // guarded by dirtyMux
+    unsigned long dirtySince = 0;   // first unsaved change, guarded by dirtyMux
+    portMUX_TYPE dirtyMux = portMUX_INITIALIZER_UNLOCKED;
+    StorageStats stats;
+
+    static const unsigned long SAVE_COALESCE_MS = 2000;
+
+    /**
+     * Plain bitwise CRC32 (IEEE 802.3). The blob is ~20 bytes, no table needed.
+     */
+    static uint32_t crc32(const uint8_t* data, size_t len) {
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; b++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+        }
+        return ~crc;
+    }
+
+    /**
+     * Build the on‑flash image from the in‑memory state.
+     */
+    ConfigBlob pack() const {
+        ConfigBlob blob;
+        memset(&blob, 0, sizeof(blob));
+        blob.version = CONFIG_BLOB_VERSION;
+        blob.durationUnit = (uint8_t)config.duration.unit;
+        blob.syncHour24 = (uint8_t)config.syncHour24;
+        blob.flags = (config.autoSync ? CFG_FLAG_AUTO_SYNC : 0) |
+                     (config.useCurrentOnStart ? CFG_FLAG_USE_CURRENT : 0) |
+                     (config.calibrateOnStart ? CFG_FLAG_CALIBRATE : 0) |
+                     (timerRunning ? CFG_FLAG_TIMER_RUNNING : 0);
+        blob.startTime = (int64_t)config.startTime;
+        blob.durationValue = config.duration.value;
+        blob.crc = crc32((const uint8_t*)&blob, offsetof(ConfigBlob, crc));
+        return blob;
+    }
+
+    /**
+     * Apply a validated blob to the in‑memory state.
+     */
+    void unpack(const ConfigBlob& blob) {
+        config.startTime = (time_t)blob.startTime;
+        config.duration.value = blob.durationValue;
+        config.duration.unit = (DurationUnit)blob.durationUnit;
+        config.syncHour24 = blob.syncHour24;
+        config.autoSync = blob.flags & CFG_FLAG_AUTO_SYNC;
+        config.useCurrentOnStart = blob.flags & CFG_FLAG_USE_CURRENT;
+        config.calibrateOnStart = blob.flags & CFG_FLAG_CALIBRATE;
+        timerRunning = blob.flags & CFG_FLAG_TIMER_RUNNING;
+    }
+
+    /**
+     * Read and validate the blob. Returns false if missing, wrong size,
+     * unknown version or CRC mismatch.
+     */
+    bool readBlob(ConfigBlob& blob) {
+        if (preferences.getBytesLength(CONFIG_BLOB_KEY) != sizeof(ConfigBlob)) return false;
+        if (preferences.getBytes(CONFIG_BLOB_KEY, &blob, sizeof(blob)) != sizeof(blob)) return false;
+        if (blob.version != CONFIG_BLOB_VERSION) return false;
+        return blob.crc == crc32((const uint8_t*)&blob, offsetof(ConfigBlob, crc));
+    }
+
+    /**
+     * Read the pre‑blob layout (one Preferences key per field).
+     * Returns true if legacy keys were found. The keys stay on flash
+     * until the blob has been written and read back (removeLegacyKeys()),
+     * so a reset or failed write during the migration loses nothing.
+     */
+    bool migrateLegacyKeys() {
+        if (!preferences.isKey("startLow") && !preferences.isKey("durationValue")) {
+            return false;
+        }
+
+        // startTime stored as two uint32_t
+        uint32_t startTimeLow = preferences.getUInt("startLow", 0);
+        uint32_t startTimeHigh = preferences.getUInt("startHigh", 0);
+        config.startTime = ((uint64_t)startTimeHigh << 32) | startTimeLow;
+
+        config.duration.value = preferences.getInt("durationValue", 0);
+        config.duration.unit = (DurationUnit)preferences.getUChar("durUnit", UNIT_DAYS);
+        config.syncHour24 = preferences.getInt("syncHour", 3);
+        config.autoSync = preferences.getBool("autoSync", true);
+        config.useCurrentOnStart = preferences.getBool("useCurStart", false);
+        config.calibrateOnStart = preferences.getBool("calibStart", false);
+        timerRunning = preferences.getBool("timerRunning", false);
+        return true;
+    }
 
+    /**
+     * Drop the legacy keys once the blob on flash is verified.
+     */
+    void removeLegacyKeys() {
+        const char* legacyKeys[] = {
+            "startLow", "startHigh", "durationValue", "durUnit", "syncHour",
+            "autoSync", "useCurStart", "calibStart", "timerRunning"
+        };
+        for (const char* key : legacyKeys) {
+            preferences.remove(key);
+        }
+        Serial.println("Migrated legacy preference keys to config blob");
+    }
+
+    /**
+     * Mark config dirty; the write is deferred to update(). The window
+     * starts at the first unsaved change, so a stream of saves cannot
+     * postpone the NVS write indefinitely.
+     */
+    void markDirty() {
+        portENTER_CRITICAL(&dirtyMux);
+        if (dirty) {
+            stats.coalescedSaves++;
+        } else {
+            dirty = true;
+            dirtySince = millis();
+        }
+        portEXIT_CRITICAL(&dirtyMux);
+    }
+
+    /**
+     * Mirror the config into the shared device state (seqlock snapshot).
+     */
+    void publishState() {
+        uint8_t flags = (config.autoSync ? DEV_CFG_AUTO_SYNC : 0) |
+                        (config.useCurrentOnStart ? DEV_CFG_USE_CURRENT : 0) |
+                        (config.calibrateOnStart ? DEV_CFG_CALIBRATE : 0);
+        deviceState.publishConfig((int64_t)config.startTime, config.duration.value,
+                                  (uint8_t)config.duration.unit, config.syncHour24, flags);
+    }
+
+public:
     /**
      * Convert a duration unit to seconds.
      */
-    long unitToSeconds(DurationUnit u) const {
+    static long unitToSeconds(DurationUnit u) {
         switch (u) {
             case UNIT_DAYS:    return 86400L;
             case UNIT_HOURS:   return 3600L;
@@ -90,7 +273,6 @@ private:
         }
     }
 
-public:
     ConfigManager() {}
 
     /**
@@ -105,7 +287,8 @@ public:
     }
 
     /**
-     * Load configuration from NVS.
+     * Load configuration from NVS (blob, or legacy keys on first boot
+     * after upgrade).
      */
     void load() {
         if (!nvsInitialized) {
@@ -113,17 +296,21 @@ public:
             return;
         }
 
-        // startTime stored as two uint32_t
-        uint32_t startTimeLow = preferences.getUInt("startLow", 0);
-        uint32_t startTimeHigh = preferences.getUInt("startHigh", 0);
-        config.startTime = ((uint64_t)startTimeHigh << 32) | startTimeLow;
-
-        config.duration.value = preferences.getInt("durationValue", 0);
-        config.duration.unit = (DurationUnit)preferences.getUChar("durUnit", UNIT_DAYS);
-        config.syncHour24 = preferences.getInt("syncHour", 3);
-        config.autoSync = preferences.getBool("autoSync", true);
-        config.useCurrentOnStart = preferences.getBool("useCurStart", false);
-        config.calibrateOnStart = preferences.getBool("calibStart", false);   // NEW
+        ConfigBlob blob;
+        if (readBlob(blob)) {
+            unpack(blob);
+            lastWritten = blob;
+            haveLastWritten = true;
+        } else if (migrateLegacyKeys()) {
+            ConfigBlob check;
+            if (flush() && readBlob(check) && memcmp(&check, &lastWritten, sizeof(check)) == 0) {
+                removeLegacyKeys();
+            } else {
+                Serial.println("⚠️ Config blob not verified, legacy keys kept");
+            }
+        } else if (preferences.isKey(CONFIG_BLOB_KEY)) {
+            Serial.println("⚠️ Config blob invalid (CRC/version), using defaults");
+        }
 
         // If startTime was 0 (uninitialised), set to today 12:00
         if (config.startTime == 0) {
@@ -137,43 +324,88 @@ public:
             }
         }
 
+        publishState();
         Serial.printf("Loaded startTime: %lld\n", (int64_t)config.startTime);
         Serial.printf("Loaded calibrateOnStart: %d\n", config.calibrateOnStart);
     }
 
     /**
-     * Save current configuration to NVS.
+     * Request a save of the current configuration. Cheap – the NVS write
+     * is coalesced and performed later by update().
      */
     bool save() {
+        publishState();
         if (!nvsInitialized) {
             Serial.println("❌ NVS not open, cannot save");
             return false;
         }
+        markDirty();
+        return true;
+    }
 
-        bool allOk = true;
-
-        // Save startTime as two 32‑bit halves
-        uint64_t st = (uint64_t)config.startTime;
-        uint32_t low = st & 0xFFFFFFFF;
-        uint32_t high = (st >> 32) & 0xFFFFFFFF;
-
-        allOk &= (preferences.putUInt("startLow", low) != 0);
-        allOk &= (preferences.putUInt("startHigh", high) != 0);
+    /**
+     * Write the blob now if it differs from what is on flash.
+     * Returns false only on a failed NVS write; the config then stays
+     * dirty and update() tries again SAVE_COALESCE_MS later.
+     */
+    bool flush() {
+        if (!nvsInitialized) return false;
+        portENTER_CRITICAL(&dirtyMux);
+        dirty = false;
+        portEXIT_CRITICAL(&dirtyMux);
+
+        ConfigBlob blob = pack();
+        if (haveLastWritten && memcmp(&blob, &lastWritten, sizeof(blob)) == 0) {
+            stats.skippedWrites++;
+            return true;
+        }
 
-        allOk &= (preferences.putInt("durationValue", config.duration.value) != 0);
-        allOk &= (preferences.putUChar("durUnit", (uint8_t)config.duration.unit) != 0);
-        allOk &= (preferences.putInt("syncHour", config.syncHour24) != 0);
-        allOk &= (preferences.putBool("autoSync", config.autoSync) != 0);
-        allOk &= (preferences.putBool("useCurStart", config.useCurrentOnStart) != 0);
-        allOk &= (preferences.putBool("calibStart", config.calibrateOnStart) != 0); // NEW
+        unsigned long t0 = micros();
+        bool ok = preferences.putBytes(CONFIG_BLOB_KEY, &blob, sizeof(blob)) == sizeof(blob);
+        stats.lastFlushMicros = micros() - t0;
 
-        if (allOk) {
-            Serial.println("✅ All preferences saved successfully.");
+        if (ok) {
+            lastWritten = blob;
+            haveLastWritten = true;
+            stats.flashWrites++;
         } else {
-            Serial.println("❌ One or more preferences write failed.");
+            stats.writeErrors++;
+            Serial.println("❌ Config blob write failed.");
+            // Still unsaved: update() retries after another window
+            portENTER_CRITICAL(&dirtyMux);
+            if (!dirty) {
+                dirty = true;
+                dirtySince = millis();
+            }
+            portEXIT_CRITICAL(&dirtyMux);
         }
+        return ok;
+    }
 
-        return allOk;
+    /**
+     * Called from main loop – flushes pending changes once the
+     * coalescing window has elapsed.
+     */
+    void update() {
+        portENTER_CRITICAL(&dirtyMux);
+        bool due = dirty && millis() - dirtySince >= SAVE_COALESCE_MS;
+        portEXIT_CRITICAL(&dirtyMux);
+        if (due) flush();
+    }
+
+    /**
+     * Flash write statistics.
+     */
+    const StorageStats& getStats() const { return stats; }
+
+    /**
+     * True if a save is waiting for the coalescing window.
+     */
+    bool isSavePending() {
+        portENTER_CRITICAL(&dirtyMux);
+        bool pending = dirty;
+        portEXIT_CRITICAL(&dirtyMux);
+        return pending;
     }
 
     /**
@@ -190,11 +422,15 @@ public:
     }
 
     /**
-     * Save only the timer running state (used on stop/start).
+     * Save only the timer running state (used on stop/start). Coalesced
+     * like save(): a reset within SAVE_COALESCE_MS restores the previous
+     * running state.
      */
     void saveTimerState(bool isRunning) {
         if (!nvsInitialized) return;
-        preferences.putBool("timerRunning", isRunning);
+        if (timerRunning == isRunning) return;
+        timerRunning = isRunning;
+        markDirty();
     }
 
     /**
@@ -202,7 +438,7 @@ public:
      */
     bool loadTimerState() {
         if (!nvsInitialized) return false;
-        return preferences.getBool("timerRunning", false);
+        return timerRunning;
     }
 
     /**
@@ -210,7 +446,7 @@ public:
      * Returns 0 if timer expired.
      */
     int getCurrentValueRemaining() const {
-        time_t now = time(nullptr);
+        time_t now = warpTime();     // countdown clock (time‑warp aware)
         if (now == 0) return config.duration.value;
 
         if (now < config.startTime) {
@@ -228,7 +464,7 @@ public:
      * Compute remaining seconds as 64‑bit integer (safe for long durations).
      */
     int64_t getRemainingSeconds() const {
-        time_t now = time(nullptr);
+        time_t now = warpTime();
         if (now == 0) return 0;
         if (now < config.startTime) {
             return (int64_t)config.duration.value * unitToSeconds(config.duration.unit);
@@ -247,7 +483,7 @@ public:
      * Check if timer is currently active (running and remaining > 0).
      */
     bool isTimerActive() const {
-        if (timerStopped) return false;
+        if (deviceState.hasFlag(DEV_TIMER_STOPPED)) return false;
         return getCurrentValueRemaining() > 0;
     }
 
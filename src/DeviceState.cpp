@@ -0,0 +1,108 @@
+#include <Arduino.h>
+
+#include "DeviceState.h"
+
+DeviceState deviceState;
+
+// Writers from different tasks/cores take turns; the section is a
+// handful of stores
+static portMUX_TYPE writeMux = portMUX_INITIALIZER_UNLOCKED;
+
+DeviceState::DeviceState() {
+    seq.store(0);
+    for (int i = 0; i < DISPLAY_DIGITS; i++) digits[i].store(0);
+    flags.store(DEV_MOTORS_HOMED | DEV_TIMER_STOPPED);
+    startTimeLo.store(0);
+    startTimeHi.store(0);
+    durationValue.store(0);
+    durationUnit.store(0);
+    syncHour24.store(0);
+    configFlags.store(0);
+    snapshotRetries.store(0);
+}
+
+// -------------------------------------------------------------------
+// Seqlock write side: odd sequence while fields are being changed.
+// -------------------------------------------------------------------
+void DeviceState::beginWrite() {
+    portENTER_CRITICAL(&writeMux);
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void DeviceState::endWrite() {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    portEXIT_CRITICAL(&writeMux);
+}
+
+void DeviceState::setDigit(int segment, int value) {
+    if (segment < 0 || segment >= DISPLAY_DIGITS) return;
+    beginWrite();
+    digits[segment].store((int8_t)value, std::memory_order_relaxed);
+    endWrite();
+}
+
+void DeviceState::setDigits(const int* values) {
+    beginWrite();
+    for (int i = 0; i < DISPLAY_DIGITS; i++) digits[i].store((int8_t)values[i], std::memory_order_relaxed);
+    endWrite();
+}
+
+void DeviceState::setFlag(DeviceFlag f, bool on) {
+    beginWrite();
+    uint8_t v = flags.load(std::memory_order_relaxed);
+    flags.store(on ? (v | f) : (v & ~f), std::memory_order_relaxed);
+    endWrite();
+}
+
+void DeviceState::publishConfig(int64_t startTime, int value, uint8_t unit,
+                                int syncHour, uint8_t cfgFlags) {
+    beginWrite();
+    startTimeLo.store((uint32_t)startTime, std::memory_order_relaxed);
+    startTimeHi.store((uint32_t)((uint64_t)startTime >> 32), std::memory_order_relaxed);
+    durationValue.store(value, std::memory_order_relaxed);
+    durationUnit.store(unit, std::memory_order_relaxed);
+    syncHour24.store((uint8_t)syncHour, std::memory_order_relaxed);
+    configFlags.store(cfgFlags, std::memory_order_relaxed);
+    endWrite();
+}
+
+// -------------------------------------------------------------------
+// Seqlock read side.
+// -------------------------------------------------------------------
+DeviceSnapshot DeviceState::snapshot() const {
+    DeviceSnapshot s;
+    for (;;) {
+        uint32_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            snapshotRetries.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        for (int i = 0; i < DISPLAY_DIGITS; i++) s.digits[i] = digits[i].load(std::memory_order_relaxed);
+        uint8_t f = flags.load(std::memory_order_relaxed);
+        uint32_t lo = startTimeLo.load(std::memory_order_relaxed);
+        uint32_t hi = startTimeHi.load(std::memory_order_relaxed);
+        s.durationValue = durationValue.load(std::memory_order_relaxed);
+        s.durationUnit = durationUnit.load(std::memory_order_relaxed);
+        s.syncHour24 = syncHour24.load(std::memory_order_relaxed);
+        uint8_t cf = configFlags.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) != before) {
+            snapshotRetries.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        s.motorsHomed = f & DEV_MOTORS_HOMED;
+        s.calibrationInProgress = f & DEV_CALIBRATING;
+        s.timerStopped = f & DEV_TIMER_STOPPED;
+        s.motorMoving = f & DEV_MOTOR_MOVING;
+        s.startTime = (int64_t)(((uint64_t)hi << 32) | lo);
+        s.autoSync = cf & DEV_CFG_AUTO_SYNC;
+        s.useCurrentOnStart = cf & DEV_CFG_USE_CURRENT;
+        s.calibrateOnStart = cf & DEV_CFG_CALIBRATE;
+        s.version = before / 2;
+        return s;
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef DEVICE_STATE_H
+#define DEVICE_STATE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "SegmentArray.h"
+
+/**
+ * @file DeviceState.h
+ * Shared device state (displayed digits, run flags, timer config) read by
+ * the web handlers and written by the motor, calibration and loop tasks.
+ *
+ * Every field is an atomic, so single‑field reads are always safe. For a
+ * coherent view across fields, snapshot() uses a seqlock: writers bump an
+ * odd/even sequence around their stores, readers retry until they copy a
+ * stable even sequence. Readers never take a lock, so they cannot stall
+ * the motor path; writers only serialise against each other.
+ */
+
+enum DeviceFlag : uint8_t {
+    DEV_MOTORS_HOMED   = 1 << 0,
+    DEV_CALIBRATING    = 1 << 1,
+    DEV_TIMER_STOPPED  = 1 << 2,
+    DEV_MOTOR_MOVING   = 1 << 3
+};
+
+enum DeviceConfigFlag : uint8_t {
+    DEV_CFG_AUTO_SYNC   = 1 << 0,
+    DEV_CFG_USE_CURRENT = 1 << 1,
+    DEV_CFG_CALIBRATE   = 1 << 2
+};
+
+/**
+ * Coherent copy of the shared state.
+ */
+struct DeviceSnapshot {
+    int digits[DISPLAY_DIGITS];
+    bool motorsHomed;
+    bool calibrationInProgress;
+    bool timerStopped;
+    bool motorMoving;
+
+    int64_t startTime;
+    int durationValue;
+    uint8_t durationUnit;        // DurationUnit
+    int syncHour24;
+    bool autoSync;
+    bool useCurrentOnStart;
+    bool calibrateOnStart;
+
+    uint32_t version;            // number of completed writes
+
+    int displayedValue() const {
+        return DisplayArray::compose(digits);
+    }
+};
+
+class DeviceState {
+public:
+    DeviceState();
+
+    /**
+     * Coherent copy of all fields (lock‑free, retries on a concurrent write).
+     */
+    DeviceSnapshot snapshot() const;
+
+    // Single‑field reads
+    int digit(int segment) const {
+        return digits[segment].load(std::memory_order_relaxed);
+    }
+    bool hasFlag(DeviceFlag f) const {
+        return (flags.load(std::memory_order_relaxed) & f) != 0;
+    }
+
+    // Writers
+    void setDigit(int segment, int value);
+    void setDigits(const int* values);
+    void setFlag(DeviceFlag f, bool on);
+    void publishConfig(int64_t startTime, int durationValue, uint8_t durationUnit,
+                       int syncHour24, uint8_t configFlags);
+
+    /**
+     * Snapshot attempts that had to be repeated because of a writer.
+     */
+    uint32_t getSnapshotRetries() const {
+        return snapshotRetries.load(std::memory_order_relaxed);
+    }
+
+private:
+    void beginWrite();
+    void endWrite();
+
+    std::atomic<uint32_t> seq;
+    std::atomic<int8_t> digits[DISPLAY_DIGITS];
+    std::atomic<uint8_t> flags;
+    std::atomic<uint32_t> startTimeLo;       // 64‑bit epoch in two halves –
+    std::atomic<uint32_t> startTimeHi;       // 32‑bit atomics are lock‑free on Xtensa
+    std::atomic<int32_t> durationValue;
+    std::atomic<uint8_t> durationUnit;
+    std::atomic<uint8_t> syncHour24;
+    std::atomic<uint8_t> configFlags;
+    mutable std::atomic<uint32_t> snapshotRetries;
+};
+
+extern DeviceState deviceState;
+
+#endif
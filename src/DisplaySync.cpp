@@ -0,0 +1,520 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <sys/time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#ifdef NATIVE_BUILD
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#else
+#include <lwip/sockets.h>
+#endif
+
+#include "DisplaySync.h"
+#include "ConfigManager.h"
+#include "SegmentController.h"
+#include "TimerController.h"
+#include "TimeWarp.h"
+#include "Log.h"
+
+extern ConfigManager configManager;
+
+#define SYNC_MAGIC   0x59534653UL    // "SFSY"
+#define SYNC_VERSION 1
+
+enum SyncPacketType : uint8_t {
+    SYNC_BEACON = 1,
+    SYNC_DELAY_REQ = 2,
+    SYNC_DELAY_RESP = 3
+};
+
+/**
+ * Wire format (little‑endian on every supported target). One layout for
+ * all packet types; unused fields are zero.
+ */
+struct __attribute__((packed)) SyncPacket {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  type;                   // SyncPacketType
+    uint16_t seq;
+    uint32_t senderId;
+    uint32_t targetId;               // DELAY_RESP: requesting follower
+    int64_t  t1Us;                   // follower send time (DELAY_REQ/RESP)
+    int64_t  t2Us;                   // leader receive time (DELAY_RESP)
+    int64_t  t3Us;                   // leader send time (DELAY_RESP, BEACON)
+    // Beacon payload
+    int64_t  startTime;
+    int32_t  durationValue;
+    uint8_t  durationUnit;
+    uint8_t  running;
+    uint8_t  reserved[2];
+    int64_t  flipAtUs;               // next flip in leader time, 0 = none
+    int32_t  flipValue;
+};
+
+struct OffsetSample {
+    int64_t offsetUs;
+    uint32_t rttUs;
+};
+
+static SyncStatus status = {};
+static int sock = -1;
+static struct sockaddr_in groupAddr;
+
+static unsigned long lastBeaconTxMs = 0;
+static unsigned long lastBeaconRxMs = 0;
+static unsigned long lastExchangeMs = 0;
+static uint16_t txSeq = 0;
+
+// Outstanding delay requests. The leader may answer late (busy loop), so
+// a response is matched against the last few requests, not just the
+// newest one. Cleared on a clock step – older t1 values are void then.
+#define SYNC_PENDING_REQS 4
+static uint16_t pendingSeq[SYNC_PENDING_REQS];
+static int64_t pendingT1[SYNC_PENDING_REQS];
+static int pendingNext = 0;
+
+static OffsetSample samples[SYNC_SAMPLE_WINDOW];
+static int sampleCount = 0;
+static int sampleNext = 0;
+
+// Flip announced by the leader (followers) or computed locally (leader)
+static int64_t armedFlipUs = 0;
+static int armedFlipValue = 0;
+static int64_t lastFiredFlipUs = 0;
+
+static SyncFlip flips[SYNC_FLIP_HISTORY];
+static int flipCount = 0;
+static int flipNext = 0;
+
+// -------------------------------------------------------------------
+// Wall clock in epoch microseconds.
+// -------------------------------------------------------------------
+static int64_t wallClockUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static void stepClock(int64_t offsetUs) {
+    int64_t target = wallClockUs() + offsetUs;
+    struct timeval tv = {(time_t)(target / 1000000LL), (suseconds_t)(target % 1000000LL)};
+    settimeofday(&tv, nullptr);
+    status.clockSteps++;
+}
+
+const char* getSyncRoleName(SyncRole role) {
+    switch (role) {
+        case SYNC_LEADER:   return "leader";
+        case SYNC_FOLLOWER: return "follower";
+        default:            return "off";
+    }
+}
+
+// -------------------------------------------------------------------
+// Next change of the displayed value (see header).
+// -------------------------------------------------------------------
+bool computeNextFlip(const DeviceSnapshot& s, int64_t nowUs, int64_t& atUs, int& value) {
+    if (s.timerStopped || s.durationValue <= 0) return false;
+
+    int64_t unitUs = (int64_t)ConfigManager::unitToSeconds((DurationUnit)s.durationUnit) * 1000000LL;
+    int64_t startUs = s.startTime * 1000000LL;
+    int64_t k = 1;                   // remaining drops at start + k·unit
+    if (nowUs >= startUs) k = (nowUs - startUs) / unitUs + 1;
+    if (k > s.durationValue) return false;
+
+    atUs = startUs + k * unitUs;
+    value = (int)(s.durationValue - k);
+    return true;
+}
+
+// -------------------------------------------------------------------
+// Socket
+// -------------------------------------------------------------------
+static void closeSocket() {
+    if (sock >= 0) close(sock);
+    sock = -1;
+    status.running = false;
+}
+
+static bool openSocket() {
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) return false;
+
+    int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(SYNC_PORT);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (struct sockaddr*)&local, sizeof(local)) < 0) {
+        closeSocket();
+        return false;
+    }
+
+    struct ip_mreq mreq = {};
+    mreq.imr_multiaddr.s_addr = inet_addr(SYNC_GROUP);
+    mreq.imr_interface.s_addr = inet_addr(SYNC_INTERFACE);
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        closeSocket();
+        return false;
+    }
+    struct in_addr iface;
+    iface.s_addr = inet_addr(SYNC_INTERFACE);
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+    uint8_t loop = 1, ttl = 1;       // own packets are filtered by senderId
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#if defined(NATIVE_BUILD) && defined(SO_TIMESTAMP)
+    setsockopt(sock, SOL_SOCKET, SO_TIMESTAMP, &yes, sizeof(yes));
+#endif
+
+    memset(&groupAddr, 0, sizeof(groupAddr));
+    groupAddr.sin_family = AF_INET;
+    groupAddr.sin_port = htons(SYNC_PORT);
+    groupAddr.sin_addr.s_addr = inet_addr(SYNC_GROUP);
+    status.running = true;
+    return true;
+}
+
+static void sendPacket(SyncPacket& p, SyncPacketType type) {
+    p.magic = SYNC_MAGIC;
+    p.version = SYNC_VERSION;
+    p.type = type;
+    p.senderId = status.unitId;
+    if (type == SYNC_BEACON || type == SYNC_DELAY_RESP) p.t3Us = wallClockUs();
+    sendto(sock, &p, sizeof(p), 0, (struct sockaddr*)&groupAddr, sizeof(groupAddr));
+}
+
+// -------------------------------------------------------------------
+// Leader side
+// -------------------------------------------------------------------
+static void sendBeacon() {
+    DeviceSnapshot s = deviceState.snapshot();
+    SyncPacket p = {};
+    p.seq = ++txSeq;
+    p.startTime = s.startTime;
+    p.durationValue = s.durationValue;
+    p.durationUnit = s.durationUnit;
+    p.running = s.timerStopped ? 0 : 1;
+    int64_t at;
+    int value;
+    if (computeNextFlip(s, wallClockUs(), at, value)) {
+        p.flipAtUs = at;
+        p.flipValue = value;
+    }
+    sendPacket(p, SYNC_BEACON);
+    status.beaconsSent++;
+}
+
+static void answerDelayRequest(const SyncPacket& req, int64_t rxUs) {
+    SyncPacket p = {};
+    p.seq = req.seq;
+    p.targetId = req.senderId;
+    p.t1Us = req.t1Us;
+    p.t2Us = rxUs;
+    sendPacket(p, SYNC_DELAY_RESP);
+}
+
+// -------------------------------------------------------------------
+// Follower side
+// -------------------------------------------------------------------
+static void resetSamples() {
+    sampleCount = 0;
+    sampleNext = 0;
+    memset(pendingSeq, 0, sizeof(pendingSeq));
+}
+
+static void adoptLeaderState(const SyncPacket& p) {
+    DeviceSnapshot s = deviceState.snapshot();
+    if (s.startTime != p.startTime || s.durationValue != p.durationValue ||
+        s.durationUnit != p.durationUnit) {
+        TimerConfig& c = configManager.getConfig();
+        c.startTime = (time_t)p.startTime;
+        c.duration.value = p.durationValue;
+        c.duration.unit = (DurationUnit)p.durationUnit;
+        configManager.save();
+        status.configApplied++;
+        LOG_I("[SYNC] Config from leader %08X: %d (unit %u)\n",
+              (unsigned)p.senderId, (int)p.durationValue, p.durationUnit);
+    }
+    bool running = p.running != 0;
+    if (running == s.timerStopped) {
+        if (running) startTimer(); else stopTimer();
+        status.configApplied++;
+    }
+}
+
+static void handleBeacon(const SyncPacket& p) {
+    // Several leaders by mistake: follow the lowest id
+    if (status.leaderId != 0 && p.senderId != status.leaderId) {
+        bool stale = millis() - lastBeaconRxMs > SYNC_LOCK_TIMEOUT_MS;
+        if (!stale && p.senderId > status.leaderId) return;
+        resetSamples();
+        status.locked = false;
+    }
+    if (status.leaderId != p.senderId) {
+        LOG_I("[SYNC] Following leader %08X\n", (unsigned)p.senderId);
+    }
+    status.leaderId = p.senderId;
+    lastBeaconRxMs = millis();
+    status.beaconsReceived++;
+
+    adoptLeaderState(p);
+
+    if (p.flipAtUs > lastFiredFlipUs) {
+        armedFlipUs = p.flipAtUs;
+        armedFlipValue = p.flipValue;
+    } else if (p.flipAtUs == 0) {
+        armedFlipUs = 0;
+    }
+}
+
+static void handleDelayResponse(const SyncPacket& p, int64_t t4) {
+    if (p.targetId != status.unitId || p.seq == 0) return;
+    int slot = -1;
+    for (int i = 0; i < SYNC_PENDING_REQS; i++) {
+        if (pendingSeq[i] == p.seq && pendingT1[i] == p.t1Us) slot = i;
+    }
+    if (slot < 0) return;
+    pendingSeq[slot] = 0;
+
+    int64_t rtt = (t4 - p.t1Us) - (p.t3Us - p.t2Us);
+    if (rtt < 0 || rtt > SYNC_MAX_RTT_US) return;
+    int64_t offset = ((p.t2Us - p.t1Us) + (p.t3Us - t4)) / 2;
+
+    samples[sampleNext] = {offset, (uint32_t)rtt};
+    sampleNext = (sampleNext + 1) % SYNC_SAMPLE_WINDOW;
+    if (sampleCount < SYNC_SAMPLE_WINDOW) sampleCount++;
+    status.exchanges++;
+
+    // The lowest‑RTT sample has the least queuing asymmetry in it
+    int best = 0;
+    for (int i = 1; i < sampleCount; i++) {
+        if (samples[i].rttUs < samples[best].rttUs) best = i;
+    }
+    status.lastOffsetUs = (int32_t)samples[best].offsetUs;
+    status.lastRttUs = samples[best].rttUs;
+
+    int64_t absOffset = samples[best].offsetUs < 0 ? -samples[best].offsetUs : samples[best].offsetUs;
+    if (absOffset <= SYNC_STEP_THRESHOLD_US) {
+        status.locked = true;
+    } else if (sampleCount == SYNC_SAMPLE_WINDOW || absOffset > 1000000LL) {
+        // Full window (or far off, e.g. first contact): step and re‑measure
+        stepClock(samples[best].offsetUs);
+        LOG_I("[SYNC] Clock stepped by %ld us (rtt %lu us)\n",
+              (long)samples[best].offsetUs, (unsigned long)samples[best].rttUs);
+        resetSamples();
+        status.locked = true;
+    }
+}
+
+static void sendDelayRequest() {
+    SyncPacket p = {};
+    p.seq = ++txSeq;
+    if (p.seq == 0) p.seq = ++txSeq;
+    p.targetId = status.leaderId;
+    p.t1Us = wallClockUs();
+    pendingSeq[pendingNext] = p.seq;
+    pendingT1[pendingNext] = p.t1Us;
+    pendingNext = (pendingNext + 1) % SYNC_PENDING_REQS;
+    sendPacket(p, SYNC_DELAY_REQ);
+}
+
+// -------------------------------------------------------------------
+// Receive one packet and its arrival time on the wall clock.
+// On the device the loop task polls every few ms and the min‑RTT filter
+// absorbs that. On the host, motion runs on the loop thread, so a packet
+// can sit in the queue for a whole move – the kernel receive timestamp
+// gives its age.
+// -------------------------------------------------------------------
+static ssize_t receivePacket(SyncPacket& p, int64_t& rxUs) {
+#if defined(NATIVE_BUILD) && defined(SO_TIMESTAMP)
+    struct iovec iov = {&p, sizeof(p)};
+    char control[CMSG_SPACE(sizeof(struct timeval))];
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t n = recvmsg(sock, &msg, 0);
+    rxUs = wallClockUs();
+    if (n < 0) return n;
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_TIMESTAMP) continue;
+        struct timeval arrived;
+        memcpy(&arrived, CMSG_DATA(c), sizeof(arrived));
+        struct timespec real;
+        clock_gettime(CLOCK_REALTIME, &real);    // not on the virtual clock
+        int64_t ageUs = ((int64_t)real.tv_sec - arrived.tv_sec) * 1000000LL +
+                        real.tv_nsec / 1000 - arrived.tv_usec;
+        if (ageUs > 0) rxUs -= ageUs;
+    }
+    return n;
+#else
+    ssize_t n = recvfrom(sock, &p, sizeof(p), 0, NULL, NULL);
+    rxUs = wallClockUs();
+    return n;
+#endif
+}
+
+// -------------------------------------------------------------------
+// Receive everything queued on the socket.
+// -------------------------------------------------------------------
+static void pollSocket() {
+    SyncPacket p;
+    for (;;) {
+        int64_t rxUs;
+        ssize_t n = receivePacket(p, rxUs);
+        if (n < 0) break;            // EAGAIN: queue drained
+        if (n != (ssize_t)sizeof(p) || p.magic != SYNC_MAGIC || p.version != SYNC_VERSION) {
+            status.packetsRejected++;
+            continue;
+        }
+        if (p.senderId == status.unitId) continue;   // own multicast echo
+
+        if (status.role == SYNC_LEADER) {
+            if (p.type == SYNC_DELAY_REQ && p.targetId == status.unitId) answerDelayRequest(p, rxUs);
+        } else if (status.role == SYNC_FOLLOWER) {
+            if (p.type == SYNC_BEACON) handleBeacon(p);
+            else if (p.type == SYNC_DELAY_RESP) handleDelayResponse(p, rxUs);
+        }
+    }
+}
+
+// -------------------------------------------------------------------
+// Scheduled flip: spin the last few ms so the tick starts on time
+// regardless of the loop period.
+// -------------------------------------------------------------------
+static void serviceFlip() {
+    if (status.role == SYNC_LEADER && armedFlipUs <= lastFiredFlipUs) {
+        int64_t at;
+        int value;
+        armedFlipUs = 0;
+        if (computeNextFlip(deviceState.snapshot(), wallClockUs(), at, value) && at > lastFiredFlipUs) {
+            armedFlipUs = at;
+            armedFlipValue = value;
+        }
+    }
+    if (status.role == SYNC_FOLLOWER && !status.locked) armedFlipUs = 0;
+    status.nextFlipUs = armedFlipUs;
+    if (armedFlipUs == 0 || armedFlipUs <= lastFiredFlipUs) return;
+
+    int64_t now = wallClockUs();
+    if (now < armedFlipUs - SYNC_FLIP_SPIN_US) return;
+    while ((now = wallClockUs()) < armedFlipUs) {
+        delayMicroseconds(50);
+    }
+
+    SyncFlip& f = flips[flipNext];
+    f.value = armedFlipValue;
+    f.scheduledUs = armedFlipUs;
+    f.lateUs = (uint32_t)(now - armedFlipUs);
+    f.fireMicros = micros();
+    flipNext = (flipNext + 1) % SYNC_FLIP_HISTORY;
+    if (flipCount < SYNC_FLIP_HISTORY) flipCount++;
+    status.flipsFired++;
+    if (f.lateUs > status.maxFlipLateUs) status.maxFlipLateUs = f.lateUs;
+
+    lastFiredFlipUs = armedFlipUs;
+    runTimerTick();
+}
+
+// -------------------------------------------------------------------
+// Public API
+// -------------------------------------------------------------------
+bool startDisplaySync(SyncRole role, uint32_t unitId) {
+    closeSocket();
+    status = SyncStatus();
+    status.role = role;
+    status.unitId = unitId;
+    resetSamples();
+    armedFlipUs = 0;
+    lastFiredFlipUs = 0;
+    if (role == SYNC_OFF) return true;
+
+    resetTimeWarp();                // the group shares real time only
+    if (!openSocket()) {
+        LOG_E("[SYNC] Cannot open %s:%d (errno %d)\n", SYNC_GROUP, SYNC_PORT, errno);
+        return false;
+    }
+    LOG_I("[SYNC] %s %08X on %s:%d\n", getSyncRoleName(role), (unsigned)unitId, SYNC_GROUP, SYNC_PORT);
+    return true;
+}
+
+static uint32_t defaultUnitId() {
+#ifdef NATIVE_BUILD
+    return (uint32_t)getpid();
+#else
+    uint64_t mac = ESP.getEfuseMac();
+    return (uint32_t)(mac ^ (mac >> 32));
+#endif
+}
+
+bool setupDisplaySync() {
+    Preferences prefs;
+    prefs.begin("display-sync", true);
+    SyncRole role = (SyncRole)prefs.getUChar("role", SYNC_OFF);
+    prefs.end();
+    if (role > SYNC_FOLLOWER) role = SYNC_OFF;
+    return startDisplaySync(role, defaultUnitId());
+}
+
+bool setDisplaySyncRole(SyncRole role) {
+    if (role > SYNC_FOLLOWER) return false;
+    Preferences prefs;
+    prefs.begin("display-sync", false);
+    prefs.putUChar("role", role);
+    prefs.end();
+    return startDisplaySync(role, status.unitId ? status.unitId : defaultUnitId());
+}
+
+void updateDisplaySync() {
+    if (!status.running) return;
+    unsigned long nowMs = millis();
+
+    pollSocket();
+
+    if (status.role == SYNC_LEADER) {
+        if (nowMs - lastBeaconTxMs >= SYNC_BEACON_MS) {
+            lastBeaconTxMs = nowMs;
+            sendBeacon();
+        }
+    } else {
+        if (status.leaderId != 0 && nowMs - lastBeaconRxMs > SYNC_LOCK_TIMEOUT_MS) {
+            if (status.locked) LOG_W("[SYNC] Leader lost – running free");
+            status.locked = false;
+            status.leaderId = 0;
+            resetSamples();
+        }
+        if (status.leaderId != 0 && nowMs - lastExchangeMs >= SYNC_EXCHANGE_MS) {
+            lastExchangeMs = nowMs;
+            sendDelayRequest();
+        }
+    }
+
+    serviceFlip();
+}
+
+bool isSyncFollowerLocked() {
+    return status.role == SYNC_FOLLOWER && status.locked;
+}
+
+const SyncStatus& getSyncStatus() {
+    return status;
+}
+
+int getSyncFlipCount() {
+    return flipCount;
+}
+
+const SyncFlip& getSyncFlip(int i) {
+    int oldest = (flipNext - flipCount + SYNC_FLIP_HISTORY) % SYNC_FLIP_HISTORY;
+    return flips[(oldest + i) % SYNC_FLIP_HISTORY];
+}
@@ -0,0 +1,136 @@
+#ifndef DISPLAY_SYNC_H
+#define DISPLAY_SYNC_H
+
+#include <Arduino.h>
+
+#include "DeviceState.h"
+
+/**
+ * @file DisplaySync.h
+ * Keeps several displays in one hall flipping together.
+ *
+ * One unit is the leader, the others are followers. They talk over UDP
+ * multicast:
+ *   - The leader sends a beacon every second. It carries the countdown
+ *     config, the run state and the next flip instant in the leader's
+ *     time base.
+ *   - Each follower measures its clock offset to the leader with
+ *     NTP‑style request/response exchanges. It keeps the lowest‑RTT
+ *     sample of the last few and steps its system clock when the offset
+ *     exceeds SYNC_STEP_THRESHOLD_US.
+ *   - Followers adopt the leader's config and start/stop state.
+ *   - Every unit runs the timer tick at the announced flip instant,
+ *     instead of at its own free‑running one‑second phase.
+ *
+ * All packets go to the group, including request/response. Several
+ * native instances can then share one port on loopback, where unicast
+ * would reach only one of them.
+ */
+
+#ifndef SYNC_GROUP
+#define SYNC_GROUP "239.255.42.99"
+#endif
+#ifndef SYNC_PORT
+#define SYNC_PORT 4210
+#endif
+#ifndef SYNC_INTERFACE
+#ifdef NATIVE_BUILD
+#define SYNC_INTERFACE "127.0.0.1"      // loopback between host instances
+#else
+#define SYNC_INTERFACE "0.0.0.0"        // default (WiFi STA) interface
+#endif
+#endif
+
+#define SYNC_BEACON_MS          1000    // leader beacon period
+#define SYNC_EXCHANGE_MS        1000    // follower offset measurement period
+#define SYNC_LOCK_TIMEOUT_MS    5000    // no beacon for this long → unlocked
+#define SYNC_SAMPLE_WINDOW      4       // offset samples kept, lowest RTT wins
+#define SYNC_MAX_RTT_US         50000   // slower exchanges are discarded
+#define SYNC_STEP_THRESHOLD_US  2000    // step the clock beyond this offset
+#define SYNC_FLIP_SPIN_US       12000   // busy‑wait the last stretch before a flip
+#define SYNC_FLIP_HISTORY       16
+
+enum SyncRole : uint8_t {
+    SYNC_OFF = 0,
+    SYNC_LEADER = 1,
+    SYNC_FOLLOWER = 2
+};
+
+/**
+ * Sync status and counters (for /api/group and metrics).
+ */
+struct SyncStatus {
+    SyncRole role;
+    bool running;               // socket open, packets flowing
+    bool locked;                // follower: time base aligned to a live leader
+    uint32_t unitId;
+    uint32_t leaderId;          // leader being followed (0 = none)
+    int32_t lastOffsetUs;       // leader − local, best sample of the window
+    uint32_t lastRttUs;
+    uint32_t clockSteps;
+    uint32_t beaconsSent;
+    uint32_t beaconsReceived;
+    uint32_t exchanges;         // completed offset measurements
+    uint32_t configApplied;     // config/run‑state changes taken from the leader
+    uint32_t packetsRejected;   // wrong magic, version or size
+    uint32_t flipsFired;
+    int64_t nextFlipUs;         // armed flip (epoch µs), 0 = none
+    uint32_t maxFlipLateUs;
+};
+
+/**
+ * One fired flip.
+ */
+struct SyncFlip {
+    int32_t value;              // remaining value the flip moves to
+    int64_t scheduledUs;        // epoch µs (leader time base)
+    uint32_t lateUs;            // fire time − scheduled, on the local clock
+    uint64_t fireMicros;        // micros() at fire (host: CLOCK_MONOTONIC)
+};
+
+/**
+ * Load the role from NVS and start if it is not SYNC_OFF. Call once the
+ * network is up (boot stage "sync").
+ */
+bool setupDisplaySync();
+
+/**
+ * Start (or restart) with an explicit role and unit id.
+ * @return false if the socket could not be opened.
+ */
+bool startDisplaySync(SyncRole role, uint32_t unitId);
+
+/**
+ * Persist a new role and restart with it (SYNC_OFF closes the socket).
+ */
+bool setDisplaySyncRole(SyncRole role);
+
+/**
+ * Called from loop(): beacons, offset exchanges, adopting leader state
+ * and firing scheduled flips.
+ */
+void updateDisplaySync();
+
+/**
+ * True on a follower whose clock is slaved to a live leader. Other clock
+ * sources must not step the system clock then.
+ */
+bool isSyncFollowerLocked();
+
+const SyncStatus& getSyncStatus();
+const char* getSyncRoleName(SyncRole role);
+
+int getSyncFlipCount();
+const SyncFlip& getSyncFlip(int i);      // 0 = oldest kept
+
+/**
+ * Next instant at which the displayed countdown value changes.
+ * @param s snapshot with the countdown config and run state
+ * @param nowUs wall clock in epoch µs
+ * @param atUs receives the flip instant (epoch µs)
+ * @param value receives the remaining value from that instant on
+ * @return false if the timer is stopped or already expired
+ */
+bool computeNextFlip(const DeviceSnapshot& s, int64_t nowUs, int64_t& atUs, int& value);
+
+#endif
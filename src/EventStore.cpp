@@ -0,0 +1,467 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include "EventStore.h"
+#include "MemoryPlan.h"
+#include "Log.h"
+
+#define EVENT_FILE_MAGIC    0x31545645      // "EVT1"
+#define EVENT_READ_BLOCK    32              // records per query read
+
+/**
+ * 16‑byte segment file header; records follow.
+ */
+struct __attribute__((packed)) SegmentHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t generation;        // higher = newer
+    uint32_t reserved;
+};
+
+struct SegmentIndex {
+    uint32_t generation;        // 0 = no valid segment file
+    uint32_t count;             // valid records
+    uint32_t first;             // time of the first / last record
+    uint32_t last;
+};
+
+struct QueuedEvent {
+    EventRecord record;         // time 0 = clock not valid yet
+    uint32_t ms;                // uptime when recorded
+};
+
+static char rootPath[40];
+static bool ready = false;
+
+// Segment files and their index: written by the loop task, read by queries
+// on the AsyncTCP task
+static SemaphoreHandle_t fileLock = NULL;
+static SegmentIndex segments[EVENT_SEGMENTS];
+static int active = 0;
+static uint32_t lastTime = 0;           // newest stored time (stored times never go back)
+
+static QueuedEvent queue[EVENT_QUEUE_SIZE];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+static portMUX_TYPE queueMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t lastFlushMs = 0;
+
+static EventStoreStats stats = {};
+
+static const char* const TYPE_NAMES[EVT_TYPE_COUNT] = {
+    "", "boot", "move", "homing", "calibration", "ntp_sync"
+};
+
+// Anything before 2023‑11‑14 means the clock was never set
+static uint32_t nowEpoch() {
+    time_t now = time(nullptr);
+    return now > 1700000000 ? (uint32_t)now : 0;
+}
+
+// FNV‑1a over the record without its check field
+static uint16_t recordCheck(const EventRecord& r) {
+    const uint8_t* p = (const uint8_t*)&r;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < sizeof(r); i++) {
+        if (i == offsetof(EventRecord, check) || i == offsetof(EventRecord, check) + 1) continue;
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+static void segmentPath(int segment, char* buf, size_t len) {
+    snprintf(buf, len, "%s/%d.bin", rootPath, segment);
+}
+
+static bool readRecords(FILE* f, uint32_t index, EventRecord* out, size_t n) {
+    if (fseek(f, sizeof(SegmentHeader) + (long)index * sizeof(EventRecord), SEEK_SET) != 0) return false;
+    return fread(out, sizeof(EventRecord), n, f) == n;
+}
+
+// -------------------------------------------------------------------
+// Segment files (caller holds fileLock, except at setup)
+// -------------------------------------------------------------------
+
+/**
+ * Index one segment file: header, valid record count (a torn record at
+ * the tail is dropped and later overwritten), first and last time.
+ */
+static void indexSegment(int segment) {
+    SegmentIndex& s = segments[segment];
+    s = {};
+    char path[64];
+    segmentPath(segment, path, sizeof(path));
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return;
+
+    SegmentHeader h;
+    if (fread(&h, sizeof(h), 1, f) == 1 && h.magic == EVENT_FILE_MAGIC &&
+        h.recordSize == sizeof(EventRecord) && h.generation != 0) {
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        uint32_t count = size > (long)sizeof(h) ? (size - sizeof(h)) / sizeof(EventRecord) : 0;
+        if (count > EVENT_SEGMENT_RECORDS) count = EVENT_SEGMENT_RECORDS;
+        EventRecord r;
+        while (count > 0 && (!readRecords(f, count - 1, &r, 1) || r.check != recordCheck(r))) count--;
+        s.generation = h.generation;
+        s.count = count;
+        if (count > 0) {
+            s.last = r.time;
+            if (readRecords(f, 0, &r, 1)) s.first = r.time;
+        }
+    }
+    fclose(f);
+}
+
+/**
+ * Empty a segment file and make it the newest.
+ */
+static bool startSegment(int segment, uint32_t generation) {
+    char path[64];
+    segmentPath(segment, path, sizeof(path));
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) return false;
+    SegmentHeader h = { EVENT_FILE_MAGIC, 1, sizeof(EventRecord), generation, 0 };
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = fclose(f) == 0 && ok;
+    segments[segment] = { ok ? generation : 0, 0, 0, 0 };
+    return ok;
+}
+
+/**
+ * Open the active segment for appending after its last valid record.
+ */
+static FILE* openActive() {
+    char path[64];
+    segmentPath(active, path, sizeof(path));
+    FILE* f = fopen(path, "r+b");
+    if (f == NULL) return NULL;
+    if (fseek(f, sizeof(SegmentHeader) + (long)segments[active].count * sizeof(EventRecord), SEEK_SET) != 0) {
+        fclose(f);
+        return NULL;
+    }
+    return f;
+}
+
+// -------------------------------------------------------------------
+// Setup and recording
+// -------------------------------------------------------------------
+bool setupEventStore(const char* root) {
+    snprintf(rootPath, sizeof(rootPath), "%s", root);
+    mkdir(rootPath, 0775);                  // already there is fine
+    if (fileLock == NULL) fileLock = xSemaphoreCreateMutex();
+    planRegisterStatic("event queue", sizeof(queue));
+
+    int newest = -1;
+    lastTime = 0;
+    for (int i = 0; i < EVENT_SEGMENTS; i++) {
+        indexSegment(i);
+        const SegmentIndex& s = segments[i];
+        if (s.generation && (newest < 0 || s.generation > segments[newest].generation)) newest = i;
+        if (s.count && s.last > lastTime) lastTime = s.last;
+    }
+    if (newest < 0) {
+        newest = 0;
+        if (!startSegment(0, 1)) {
+            LOG_E("[EVENTS] Cannot create the event store");
+            return false;
+        }
+    }
+    active = newest;
+    ready = true;
+
+    EventStoreStats s = getEventStoreStats();
+    LOG_I("[EVENTS] %u records, %u … %u\n", (unsigned)s.records, (unsigned)s.oldest, (unsigned)s.newest);
+    return true;
+}
+
+void recordEvent(uint8_t type, uint8_t channel, int32_t value, int32_t extra) {
+    QueuedEvent e;
+    e.record = { nowEpoch(), type, channel, 0, value, extra };
+    e.ms = millis();
+    portENTER_CRITICAL(&queueMux);
+    if (queueCount < EVENT_QUEUE_SIZE) {
+        queue[(queueHead + queueCount) % EVENT_QUEUE_SIZE] = e;
+        queueCount++;
+        stats.recorded++;
+    } else {
+        stats.dropped++;
+    }
+    portEXIT_CRITICAL(&queueMux);
+}
+
+/**
+ * Append queued records. The stdio buffer turns a batch into one flash
+ * write; a full segment rotates to the oldest one.
+ */
+void serviceEventStore(bool force) {
+    if (!ready) return;
+    uint32_t nowMs = millis();
+    portENTER_CRITICAL(&queueMux);
+    uint8_t pending = queueCount;
+    portEXIT_CRITICAL(&queueMux);
+    if (pending == 0) return;
+    if (!force && nowMs - lastFlushMs < EVENT_FLUSH_MS && pending < EVENT_QUEUE_SIZE / 2) return;
+    uint32_t now = nowEpoch();
+    if (now == 0) return;                   // hold until the clock is valid
+    lastFlushMs = nowMs;
+
+    static QueuedEvent batch[EVENT_QUEUE_SIZE];
+    int n = 0;
+    portENTER_CRITICAL(&queueMux);
+    while (queueCount > 0) {
+        batch[n++] = queue[queueHead];
+        queueHead = (queueHead + 1) % EVENT_QUEUE_SIZE;
+        queueCount--;
+    }
+    portEXIT_CRITICAL(&queueMux);
+
+    xSemaphoreTake(fileLock, portMAX_DELAY);
+    FILE* f = NULL;
+    int written = 0;
+    for (; written < n; written++) {
+        EventRecord r = batch[written].record;
+        if (r.time == 0) r.time = now - (nowMs - batch[written].ms) / 1000;
+        if (r.time < lastTime) r.time = lastTime;
+        r.check = recordCheck(r);
+
+        if (segments[active].count >= EVENT_SEGMENT_RECORDS) {
+            if (f) fclose(f);
+            f = NULL;
+            int next = (active + 1) % EVENT_SEGMENTS;
+            if (!startSegment(next, segments[active].generation + 1)) break;
+            active = next;
+            stats.rotations++;
+        }
+        if (f == NULL && (f = openActive()) == NULL) break;
+        if (fwrite(&r, sizeof(r), 1, f) != 1) break;
+
+        SegmentIndex& s = segments[active];
+        if (s.count == 0) s.first = r.time;
+        s.last = r.time;
+        s.count++;
+        lastTime = r.time;
+    }
+    if (f && fclose(f) != 0) written = 0;  // the buffered records did not make it
+    if (written < n) indexSegment(active);  // resync with what reached the file
+    xSemaphoreGive(fileLock);
+
+    stats.written += written;
+    if (written < n) {
+        stats.writeErrors++;
+        stats.dropped += n - written;
+        LOG_E("[EVENTS] Write failed, %d records lost\n", n - written);
+    }
+}
+
+// -------------------------------------------------------------------
+// Queries: segments in generation order, binary search for the first
+// record, then forward in blocks. Constant memory.
+// -------------------------------------------------------------------
+static struct {
+    volatile bool busy;
+    EventQuery q;
+    int order[EVENT_SEGMENTS];
+    int segmentCount;
+    int segmentPos;
+    bool positioned;
+    bool done;
+    uint32_t generation;        // of the segment being read (reused → skip it)
+    uint32_t next;
+    uint32_t end;
+    uint32_t blockBase;
+    uint32_t blockLen;
+    bool haveBucket;
+    EventBucket bucket;
+} cursor;
+
+static EventRecord block[EVENT_READ_BLOCK];
+
+/**
+ * First record of the current segment with time >= q.from.
+ */
+static bool positionSegment() {
+    while (cursor.segmentPos < cursor.segmentCount) {
+        int seg = cursor.order[cursor.segmentPos];
+        xSemaphoreTake(fileLock, portMAX_DELAY);
+        SegmentIndex s = segments[seg];
+        if (s.count == 0 || s.last < cursor.q.from) {
+            xSemaphoreGive(fileLock);
+            cursor.segmentPos++;
+            continue;
+        }
+        if (s.first > cursor.q.to) {
+            xSemaphoreGive(fileLock);
+            return false;                   // later segments are newer still
+        }
+        uint32_t lo = 0, hi = s.count;
+        char path[64];
+        segmentPath(seg, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+        if (f == NULL) {
+            xSemaphoreGive(fileLock);
+            cursor.segmentPos++;
+            continue;
+        }
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            EventRecord r;
+            if (!readRecords(f, mid, &r, 1)) break;
+            if (r.time < cursor.q.from) lo = mid + 1;
+            else hi = mid;
+        }
+        fclose(f);
+        xSemaphoreGive(fileLock);
+
+        cursor.generation = s.generation;
+        cursor.next = lo;
+        cursor.end = s.count;
+        cursor.blockLen = 0;
+        cursor.positioned = true;
+        return true;
+    }
+    return false;
+}
+
+static bool loadBlock() {
+    int seg = cursor.order[cursor.segmentPos];
+    uint32_t n = cursor.end - cursor.next;
+    if (n > EVENT_READ_BLOCK) n = EVENT_READ_BLOCK;
+    bool ok = false;
+    xSemaphoreTake(fileLock, portMAX_DELAY);
+    if (segments[seg].generation == cursor.generation) {
+        char path[64];
+        segmentPath(seg, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+        if (f) {
+            ok = readRecords(f, cursor.next, block, n);
+            fclose(f);
+        }
+    }
+    xSemaphoreGive(fileLock);
+    cursor.blockBase = cursor.next;
+    cursor.blockLen = ok ? n : 0;
+    return ok;
+}
+
+static bool nextRecord(EventRecord& r) {
+    while (!cursor.done) {
+        if (!cursor.positioned && !positionSegment()) {
+            cursor.done = true;
+            break;
+        }
+        if (cursor.next >= cursor.end ||
+            (cursor.next >= cursor.blockBase + cursor.blockLen && !loadBlock())) {
+            cursor.positioned = false;
+            cursor.segmentPos++;
+            continue;
+        }
+        r = block[cursor.next - cursor.blockBase];
+        cursor.next++;
+        if (r.time > cursor.q.to) {
+            cursor.done = true;
+            break;
+        }
+        if (r.check != recordCheck(r)) continue;
+        if (cursor.q.type && r.type != cursor.q.type) continue;
+        if (cursor.q.channel >= 0 && r.channel != cursor.q.channel) continue;
+        return true;
+    }
+    return false;
+}
+
+bool eventQueryBegin(const EventQuery& query) {
+    if (!ready || cursor.busy) return false;
+    cursor.busy = true;
+    cursor.q = query;
+    cursor.positioned = false;
+    cursor.done = false;
+    cursor.haveBucket = false;
+    cursor.segmentPos = 0;
+    cursor.segmentCount = 0;
+
+    // Oldest first (insertion sort by generation)
+    xSemaphoreTake(fileLock, portMAX_DELAY);
+    for (int i = 0; i < EVENT_SEGMENTS; i++) {
+        if (!segments[i].generation) continue;
+        int j = cursor.segmentCount++;
+        while (j > 0 && segments[cursor.order[j - 1]].generation > segments[i].generation) {
+            cursor.order[j] = cursor.order[j - 1];
+            j--;
+        }
+        cursor.order[j] = i;
+    }
+    xSemaphoreGive(fileLock);
+    return true;
+}
+
+bool eventQueryNext(EventRecord& record, EventBucket& bucket) {
+    if (!cursor.busy) return false;
+    if (cursor.q.bucketS == 0) return nextRecord(record);
+
+    EventRecord r;
+    while (nextRecord(r)) {
+        int32_t v = cursor.q.useExtra ? r.extra : r.value;
+        uint32_t start = r.time - r.time % cursor.q.bucketS;
+        if (cursor.haveBucket && start == cursor.bucket.start) {
+            EventBucket& b = cursor.bucket;
+            b.count++;
+            if (v < b.min) b.min = v;
+            if (v > b.max) b.max = v;
+            b.sum += v;
+            continue;
+        }
+        bool finished = cursor.haveBucket;
+        if (finished) bucket = cursor.bucket;
+        cursor.bucket = { start, 1, v, v, v };
+        cursor.haveBucket = true;
+        if (finished) return true;
+    }
+    if (!cursor.haveBucket) return false;
+    bucket = cursor.bucket;
+    cursor.haveBucket = false;
+    return true;
+}
+
+void eventQueryEnd() {
+    cursor.busy = false;
+}
+
+// -------------------------------------------------------------------
+// Status
+// -------------------------------------------------------------------
+EventStoreStats getEventStoreStats() {
+    EventStoreStats s = stats;
+    s.records = 0;
+    s.oldest = 0;
+    s.newest = 0;
+    if (!ready) return s;
+    xSemaphoreTake(fileLock, portMAX_DELAY);
+    uint32_t oldestGeneration = 0;
+    for (const SegmentIndex& seg : segments) {
+        if (!seg.generation || !seg.count) continue;
+        s.records += seg.count;
+        if (!oldestGeneration || seg.generation < oldestGeneration) {
+            oldestGeneration = seg.generation;
+            s.oldest = seg.first;
+        }
+    }
+    s.newest = s.records ? lastTime : 0;
+    xSemaphoreGive(fileLock);
+    return s;
+}
+
+const char* eventTypeName(uint8_t type) {
+    return type > 0 && type < EVT_TYPE_COUNT ? TYPE_NAMES[type] : "?";
+}
+
+uint8_t eventTypeFromName(const char* name) {
+    if (name == NULL) return 0;
+    for (int i = 1; i < EVT_TYPE_COUNT; i++) {
+        if (strcmp(name, TYPE_NAMES[i]) == 0) return (uint8_t)i;
+    }
+    return 0;
+}
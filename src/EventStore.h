@@ -0,0 +1,125 @@
+#ifndef EVENT_STORE_H
+#define EVENT_STORE_H
+
+#include <Arduino.h>
+
+/**
+ * @file EventStore.h
+ * Append‑only history of device events on LittleFS: restarts, moves,
+ * homing runs with their Hall trigger steps, calibrations and NTP offsets.
+ *
+ * Fixed 16‑byte records are appended to EVENT_SEGMENTS segment files of
+ * EVENT_SEGMENT_RECORDS records each. When the active segment is full the
+ * oldest one is emptied and reused, so the history never takes more than
+ * EVENT_SEGMENTS × segment size of flash. RAM use is constant whatever
+ * the history length: a queue of records waiting to be written, a per
+ * segment index (generation, record count, first and last time) and a
+ * small read block for queries.
+ *
+ * recordEvent() never blocks and never touches the file system; the loop
+ * task writes queued records in batches (serviceEventStore()). Records
+ * queued before the clock is valid are back‑dated from uptime when the
+ * clock becomes valid. Stored times never go backwards (a clock stepped
+ * back is clamped to the last stored time), so every segment is sorted
+ * and a query binary‑searches its first record.
+ *
+ * Files are accessed through stdio (LittleFS is mounted in the VFS), so
+ * the host build runs the same code against a local directory.
+ */
+
+#define EVENT_STORE_ROOT        "/littlefs/events"
+#define EVENT_SEGMENTS          8
+#define EVENT_SEGMENT_RECORDS   1024        // 16 KB per segment, 128 KB in total
+#define EVENT_QUEUE_SIZE        32          // records waiting for the next write
+#define EVENT_FLUSH_MS          10000       // batch writes (flash wear)
+#define EVENT_NO_CHANNEL        0xFF
+
+enum EventType : uint8_t {
+    EVT_BOOT = 1,               // value = reset reason
+    EVT_MOVE = 2,               // value = displayed value reached, extra = duration ms
+    EVT_HOMING = 3,             // channel = segment, value = Hall trigger half‑step (‑1 = failed), extra = duration ms
+    EVT_CALIBRATION = 4,        // value = 1 ok / 0 failed, extra = duration ms
+    EVT_NTP_SYNC = 5,           // value = clock offset corrected, ms
+    EVT_TYPE_COUNT
+};
+
+/**
+ * On‑flash record (little endian). `check` catches a record torn by a
+ * reset during the write.
+ */
+struct __attribute__((packed)) EventRecord {
+    uint32_t time;              // epoch seconds
+    uint8_t type;               // EventType
+    uint8_t channel;            // segment, EVENT_NO_CHANNEL if none
+    uint16_t check;
+    int32_t value;
+    int32_t extra;
+};
+
+/**
+ * Query: one type (0 = all types, raw only), optionally one channel,
+ * between two times. bucketS > 0 aggregates per bucket.
+ */
+struct EventQuery {
+    uint8_t type;
+    int16_t channel;            // ‑1 = all channels
+    uint32_t from;              // inclusive, epoch seconds
+    uint32_t to;                // inclusive, epoch seconds
+    uint32_t bucketS;           // 0 = raw records, e.g. 3600 = per hour
+    bool useExtra;              // aggregate `extra` instead of `value`
+};
+
+/**
+ * Aggregate of one bucket; buckets without records are not reported.
+ */
+struct EventBucket {
+    uint32_t start;             // bucket start, epoch seconds (multiple of bucketS)
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+    int64_t sum;
+};
+
+struct EventStoreStats {
+    uint32_t recorded;          // records queued since boot
+    uint32_t written;           // records written since boot
+    uint32_t dropped;           // queue full
+    uint32_t writeErrors;
+    uint32_t rotations;         // segments reused since boot
+    uint32_t records;           // records on flash
+    uint32_t oldest;            // epoch of the oldest record, 0 = empty
+    uint32_t newest;
+};
+
+/**
+ * Open the store under `root` (created if missing) and index the
+ * existing segments. Without it records are queued but never written.
+ */
+bool setupEventStore(const char* root = EVENT_STORE_ROOT);
+
+/**
+ * Queue one event. Safe from any task; drops (and counts) when the queue
+ * is full.
+ */
+void recordEvent(uint8_t type, uint8_t channel, int32_t value, int32_t extra = 0);
+
+/**
+ * Write queued records when EVENT_FLUSH_MS passed or the queue is half
+ * full. Called from loop(); `force` writes now (if the clock is valid).
+ */
+void serviceEventStore(bool force = false);
+
+/**
+ * Streaming query – one at a time (returns false while another runs).
+ * Call eventQueryNext() until it returns false, then eventQueryEnd().
+ * Raw queries fill `record`; bucketed queries fill `bucket`.
+ */
+bool eventQueryBegin(const EventQuery& query);
+bool eventQueryNext(EventRecord& record, EventBucket& bucket);
+void eventQueryEnd();
+
+EventStoreStats getEventStoreStats();
+const char* eventTypeName(uint8_t type);
+uint8_t eventTypeFromName(const char* name);     // 0 if unknown
+
+#endif
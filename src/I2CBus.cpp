@@ -0,0 +1,448 @@
+#include <Arduino.h>
+#ifdef NATIVE_BUILD
+#include <Wire.h>
+#else
+#include <driver/i2c.h>
+#endif
+
+#include "I2CBus.h"
+#include "TaskPlan.h"
+
+// Transfer result codes (same values as Wire.endTransmission())
+#define I2C_OK            0
+#define I2C_NACK_ADDR     2
+#define I2C_NACK_DATA     3
+#define I2C_TIMEOUT       5
+#define I2C_OTHER         4
+
+// Recover after this many transactions in a row gave up
+#define I2C_RECOVER_AFTER 3
+
+static I2CDeviceStats deviceStats[I2C_MAX_DEVICES];
+static int deviceCount = 0;
+static I2CBusStats busStats = {};
+
+static int sdaPin = -1;
+static int sclPin = -1;
+static uint32_t busFrequency = 100000;
+
+// -------------------------------------------------------------------
+// Jobs. A job is copied into the queue by value, so the submitter's
+// buffers may go away at once; blocking callers pass a SyncWait that
+// the engine fills in and signals.
+// -------------------------------------------------------------------
+enum I2COp : uint8_t {
+    I2C_OP_TRANSFER = 0,        // write outLen bytes, then read inLen (either may be 0)
+    I2C_OP_BARRIER,             // no bus traffic, completes after everything before it
+    I2C_OP_BURST,               // write burstLen bytes from the submitter's buffer, no retry
+};
+
+struct SyncWait {
+    SemaphoreHandle_t done;     // NULL when the job runs inline
+    uint8_t* in;
+    bool ok;
+};
+
+struct I2CJob {
+    uint8_t op;
+    uint8_t address;
+    uint8_t outLen;
+    uint8_t inLen;
+    uint8_t out[I2C_JOB_MAX_BYTES];
+    const uint8_t* burst;       // I2C_OP_BURST: caller's buffer, valid until completion
+    uint16_t burstLen;
+    I2CCallback callback;
+    void* context;
+    SyncWait* wait;
+};
+
+#ifndef NATIVE_BUILD
+static const i2c_port_t I2C_PORT = I2C_NUM_0;
+static const uint32_t I2C_TRANSFER_TIMEOUT_MS = 5;    // bounded wait on a stuck bus
+static uint8_t cmdLinkBuffer[I2C_LINK_RECOMMENDED_SIZE(3)];
+
+static QueueHandle_t jobQueue = NULL;
+static StaticQueue_t jobQueueStorage;
+static uint8_t jobQueueBuffer[I2C_QUEUE_DEPTH * sizeof(I2CJob)];
+static TaskHandle_t engineTask = NULL;
+#endif
+
+// -------------------------------------------------------------------
+// Stats slot for an address (created on first use).
+// -------------------------------------------------------------------
+static I2CDeviceStats* statsFor(uint8_t address) {
+    for (int i = 0; i < deviceCount; i++) {
+        if (deviceStats[i].address == address) return &deviceStats[i];
+    }
+    if (deviceCount >= I2C_MAX_DEVICES) return &deviceStats[I2C_MAX_DEVICES - 1];
+    I2CDeviceStats* s = &deviceStats[deviceCount++];
+    memset(s, 0, sizeof(*s));
+    s->address = address;
+    return s;
+}
+
+static void recordLatency(I2CDeviceStats* s, uint32_t us) {
+    int bucket = 0;
+    uint32_t limit = 16;
+    while (bucket < I2C_HIST_BUCKETS - 1 && us > limit) {
+        bucket++;
+        limit <<= 1;
+    }
+    s->latencyHist[bucket]++;
+    s->latencySumUs += us;
+    if (us > s->maxLatencyUs) s->maxLatencyUs = us;
+}
+
+static void recordError(I2CDeviceStats* s, uint8_t code) {
+    switch (code) {
+        case I2C_NACK_ADDR:
+        case I2C_NACK_DATA: s->nacks++; break;
+        case I2C_TIMEOUT:   s->timeouts++; break;
+        default:            s->otherErrors++; break;
+    }
+}
+
+// -------------------------------------------------------------------
+// Bookkeeping after a transaction finished (with or without success).
+// -------------------------------------------------------------------
+static void finishTransaction(I2CDeviceStats* s, bool ok) {
+    if (ok) {
+        s->transactions++;
+        busStats.consecutiveFailures = 0;
+        return;
+    }
+    s->failures++;
+    if (++busStats.consecutiveFailures >= I2C_RECOVER_AFTER) {
+        i2cRecoverBus();
+    }
+}
+
+// -------------------------------------------------------------------
+// Bus backend: one transfer (address probe, write, read or write +
+// repeated‑start read) → result code.
+// -------------------------------------------------------------------
+#ifdef NATIVE_BUILD
+
+static void backendBegin() {
+    Wire.begin(sdaPin, sclPin);
+    Wire.setClock(busFrequency);
+    Wire.setTimeOut(5);               // ms – bounded wait on a stuck bus
+}
+
+static void backendEnd() {
+    Wire.end();
+}
+
+static uint8_t busTransfer(uint8_t address, const uint8_t* out, size_t outLen,
+                           uint8_t* in, size_t inLen) {
+    if (outLen || !inLen) {
+        Wire.beginTransmission(address);
+        if (outLen) Wire.write(out, outLen);
+        uint8_t code = Wire.endTransmission(inLen == 0);
+        if (code != I2C_OK) return code;
+    }
+    if (!inLen) return I2C_OK;
+    size_t got = Wire.requestFrom(address, (uint8_t)inLen);
+    if (got != inLen) {
+        while (Wire.available()) Wire.read();
+        return I2C_NACK_DATA;                // requestFrom() can't tell why
+    }
+    for (size_t i = 0; i < inLen; i++) in[i] = Wire.read();
+    return I2C_OK;
+}
+
+#else
+
+static void backendBegin() {
+    i2c_config_t conf = {};
+    conf.mode = I2C_MODE_MASTER;
+    conf.sda_io_num = sdaPin;
+    conf.scl_io_num = sclPin;
+    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.master.clk_speed = busFrequency;
+    i2c_param_config(I2C_PORT, &conf);
+    i2c_driver_install(I2C_PORT, I2C_MODE_MASTER, 0, 0, 0);
+}
+
+static void backendEnd() {
+    i2c_driver_delete(I2C_PORT);
+}
+
+static uint8_t busTransfer(uint8_t address, const uint8_t* out, size_t outLen,
+                           uint8_t* in, size_t inLen) {
+    // Only the engine task (or boot code before it exists) gets here, so
+    // the static command link is never shared
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(cmdLinkBuffer, sizeof(cmdLinkBuffer));
+    i2c_master_start(cmd);
+    if (outLen || !inLen) {
+        i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+        if (outLen) i2c_master_write(cmd, out, outLen, true);
+        if (inLen) i2c_master_start(cmd);
+    }
+    if (inLen) {
+        i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_READ, true);
+        i2c_master_read(cmd, in, inLen, I2C_MASTER_LAST_NACK);
+    }
+    i2c_master_stop(cmd);
+    // Bursts stay on the wire for milliseconds: allow for their length
+    uint32_t wireMs = (uint32_t)((outLen + inLen) * 9000ULL / busFrequency);
+    esp_err_t err = i2c_master_cmd_begin(I2C_PORT, cmd, pdMS_TO_TICKS(I2C_TRANSFER_TIMEOUT_MS + wireMs));
+    i2c_cmd_link_delete_static(cmd);
+
+    // The driver reports any missing ACK as ESP_FAIL – address or data
+    // NACK alike, it can't tell which. runJob() retries it once before
+    // taking it for an absent device
+    switch (err) {
+        case ESP_OK:          return I2C_OK;
+        case ESP_FAIL:        return I2C_NACK_ADDR;
+        case ESP_ERR_TIMEOUT: return I2C_TIMEOUT;
+        default:              return I2C_OTHER;
+    }
+}
+
+#endif
+
+// -------------------------------------------------------------------
+// Run one job with retries and bookkeeping. Always on the bus owner.
+// -------------------------------------------------------------------
+static bool runJob(const I2CJob& job, uint8_t* in) {
+    if (job.op == I2C_OP_BARRIER) return true;
+    I2CDeviceStats* s = statsFor(job.address);
+    bool isBurst = job.op == I2C_OP_BURST;
+    const uint8_t* out = isBurst ? job.burst : job.out;
+    size_t outLen = isBurst ? job.burstLen : job.outLen;
+    int attempts = isBurst ? 1 : I2C_MAX_ATTEMPTS;
+    unsigned long start = micros();
+    bool ok = false;
+
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        if (attempt > 0) {
+            if (micros() - start > I2C_RETRY_BUDGET_US) break;
+            s->retries++;
+        }
+        unsigned long t0 = micros();
+        uint8_t code = busTransfer(job.address, out, outLen, in, job.inLen);
+        recordLatency(s, micros() - t0);
+        if (code == I2C_OK) {
+            s->bytesOut += outLen;
+            s->bytesIn += job.inLen;
+            ok = true;
+            break;
+        }
+        recordError(s, code);
+        // A NACK twice in a row means no device – further retries won't
+        // help. The first one may be a data NACK or a glitch (ESP_FAIL
+        // doesn't say), so it gets one retry within the budget.
+        if (code == I2C_NACK_ADDR && attempt > 0) break;
+    }
+
+    finishTransaction(s, ok);
+    return ok;
+}
+
+static void completeJob(const I2CJob& job) {
+    uint8_t in[I2C_JOB_MAX_BYTES];
+    bool ok = runJob(job, in);
+    if (job.callback) job.callback(job.context, ok, ok && job.inLen ? in : NULL, ok ? job.inLen : 0);
+    if (job.wait) {
+        if (ok && job.inLen) memcpy(job.wait->in, in, job.inLen);
+        job.wait->ok = ok;
+#ifndef NATIVE_BUILD
+        if (job.wait->done) xSemaphoreGive(job.wait->done);
+#endif
+    }
+}
+
+#ifndef NATIVE_BUILD
+static void i2cEngineTask(void* pvParameters) {
+    I2CJob job;
+    for (;;) {
+        if (xQueueReceive(jobQueue, &job, portMAX_DELAY) == pdTRUE) completeJob(job);
+    }
+}
+
+// True when a job must go through the queue rather than run here
+static bool useQueue() {
+    return jobQueue && xTaskGetCurrentTaskHandle() != engineTask;
+}
+#endif
+
+// -------------------------------------------------------------------
+// Hand a job to the engine. Inline in the native build, before the
+// engine is up and on the engine task itself (callbacks doing I2C).
+// -------------------------------------------------------------------
+static bool enqueue(const I2CJob& job) {
+#ifndef NATIVE_BUILD
+    if (useQueue()) {
+        if (xQueueSend(jobQueue, &job, 0) != pdTRUE) {
+            busStats.queueFullWaits++;
+            if (xQueueSend(jobQueue, &job, pdMS_TO_TICKS(I2C_SUBMIT_WAIT_MS)) != pdTRUE) {
+                busStats.submitFailures++;
+                return false;
+            }
+        }
+        busStats.jobsQueued++;
+        uint32_t depth = uxQueueMessagesWaiting(jobQueue);
+        if (depth > busStats.queueHighWater) busStats.queueHighWater = depth;
+        return true;
+    }
+#endif
+    completeJob(job);
+    return true;
+}
+
+// Submit and wait for the outcome
+static bool transact(I2CJob& job, uint8_t* in) {
+    SyncWait wait = { NULL, in, false };
+#ifndef NATIVE_BUILD
+    StaticSemaphore_t doneStorage;
+    if (useQueue()) wait.done = xSemaphoreCreateBinaryStatic(&doneStorage);
+#endif
+    job.wait = &wait;
+    if (!enqueue(job)) return false;
+#ifndef NATIVE_BUILD
+    if (wait.done) xSemaphoreTake(wait.done, portMAX_DELAY);
+#endif
+    return wait.ok;
+}
+
+static bool makeJob(I2CJob& job, uint8_t address, const uint8_t* out, size_t outLen, size_t inLen) {
+    if (outLen > I2C_JOB_MAX_BYTES || inLen > I2C_JOB_MAX_BYTES) return false;
+    job.op = I2C_OP_TRANSFER;
+    job.address = address;
+    job.outLen = (uint8_t)outLen;
+    job.inLen = (uint8_t)inLen;
+    if (outLen) memcpy(job.out, out, outLen);
+    job.burst = NULL;
+    job.burstLen = 0;
+    job.callback = NULL;
+    job.context = NULL;
+    job.wait = NULL;
+    return true;
+}
+
+// -------------------------------------------------------------------
+// Public API
+// -------------------------------------------------------------------
+void i2cBusBegin(int sda, int scl, uint32_t frequency) {
+    sdaPin = sda;
+    sclPin = scl;
+    busFrequency = frequency;
+    backendBegin();
+#ifndef NATIVE_BUILD
+    if (!jobQueue) {
+        jobQueue = xQueueCreateStatic(I2C_QUEUE_DEPTH, sizeof(I2CJob), jobQueueBuffer, &jobQueueStorage);
+        startPlannedTask(TASK_I2C_ENGINE, i2cEngineTask, NULL, &engineTask);
+    }
+#endif
+}
+
+uint32_t i2cBusFrequency() {
+    return busFrequency;
+}
+
+bool i2cSubmitWrite(uint8_t address, const uint8_t* data, size_t len,
+                    I2CCallback callback, void* context) {
+    I2CJob job;
+    if (!makeJob(job, address, data, len, 0)) return false;
+    job.callback = callback;
+    job.context = context;
+    return enqueue(job);
+}
+
+bool i2cSubmitRead(uint8_t address, size_t len, I2CCallback callback, void* context) {
+    I2CJob job;
+    if (!makeJob(job, address, NULL, 0, len)) return false;
+    job.callback = callback;
+    job.context = context;
+    return enqueue(job);
+}
+
+void i2cDrain() {
+    I2CJob job;
+    makeJob(job, 0, NULL, 0, 0);
+    job.op = I2C_OP_BARRIER;
+    transact(job, NULL);
+}
+
+bool i2cWriteBurst(uint8_t address, const uint8_t* data, size_t len) {
+    if (len > I2C_BURST_MAX_BYTES) return false;
+    I2CJob job;
+    makeJob(job, address, NULL, 0, 0);
+    job.op = I2C_OP_BURST;
+    job.burst = data;
+    job.burstLen = (uint16_t)len;
+    return transact(job, NULL);
+}
+
+uint32_t i2cBytesMicros(size_t bytes) {
+    uint64_t bits = (uint64_t)bytes * 9;     // 8 data bits + ACK
+    return (uint32_t)((bits * 1000000ULL + busFrequency - 1) / busFrequency);
+}
+
+bool i2cWrite(uint8_t address, const uint8_t* data, size_t len) {
+    I2CJob job;
+    if (!makeJob(job, address, data, len, 0)) return false;
+    return transact(job, NULL);
+}
+
+bool i2cRead(uint8_t address, uint8_t* data, size_t len) {
+    I2CJob job;
+    if (!makeJob(job, address, NULL, 0, len)) return false;
+    return transact(job, data);
+}
+
+bool i2cReadRegister(uint8_t address, uint8_t reg, uint8_t* data, size_t len) {
+    I2CJob job;
+    if (!makeJob(job, address, &reg, 1, len)) return false;
+    return transact(job, data);
+}
+
+// Called from finishTransaction(), i.e. on the bus owner
+void i2cRecoverBus() {
+    busStats.recoveries++;
+    busStats.consecutiveFailures = 0;
+    if (sdaPin < 0 || sclPin < 0) return;
+
+    Serial.println("[I2C] Bus recovery: clocking SCL");
+    backendEnd();
+
+    // Up to 9 clocks let a slave finish the byte it is holding SDA for
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, OUTPUT_OPEN_DRAIN);
+    for (int i = 0; i < 9 && digitalRead(sdaPin) == LOW; i++) {
+        digitalWrite(sclPin, LOW);
+        delayMicroseconds(5);
+        digitalWrite(sclPin, HIGH);
+        delayMicroseconds(5);
+    }
+
+    // STOP: SDA low → high while SCL is high
+    pinMode(sdaPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(sdaPin, LOW);
+    delayMicroseconds(5);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(sdaPin, HIGH);
+    delayMicroseconds(5);
+
+    backendBegin();
+}
+
+int i2cDeviceCount() {
+    return deviceCount;
+}
+
+const I2CDeviceStats& i2cDeviceStats(int index) {
+    return deviceStats[index];
+}
+
+const I2CBusStats& i2cBusStats() {
+    return busStats;
+}
+
+uint32_t i2cHistBucketLimit(int bucket) {
+    if (bucket >= I2C_HIST_BUCKETS - 1) return 0;
+    return 16UL << bucket;
+}
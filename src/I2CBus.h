@@ -0,0 +1,145 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+/**
+ * @file I2CBus.h
+ * Instrumented, queued I2C master: per‑address counters, latency
+ * histograms, bounded‑time retry and bus recovery by clocking SCL.
+ * All firmware I2C traffic (PCF8575s, DS3231) goes through here.
+ *
+ * On the device one engine task owns the bus (ESP‑IDF master driver).
+ * Every transaction is a job in a FIFO queue: the motor task enqueues
+ * step frames and carries on computing the next one while the current
+ * frame is on the wire; the RTC and Hall reads queue behind them, so the
+ * bus is arbitrated without a lock and transactions are never
+ * interleaved. The blocking calls below submit a job and wait for it.
+ * In the native build jobs run inline on the caller through Wire.
+ *
+ * Retry policy: up to I2C_MAX_ATTEMPTS tries within I2C_RETRY_BUDGET_US.
+ * An address NACK is retried once (the IDF driver reports every missing
+ * ACK as ESP_FAIL) and then taken as an absent device; bursts are never
+ * retried.
+ */
+
+#define I2C_MAX_DEVICES     8
+#define I2C_HIST_BUCKETS    12    // ≤16, ≤32, … ≤16384 µs, then overflow
+#define I2C_MAX_ATTEMPTS    3
+#define I2C_RETRY_BUDGET_US 2000  // stop retrying once this much time is spent
+#define I2C_QUEUE_DEPTH     8     // jobs waiting for the engine
+#define I2C_JOB_MAX_BYTES   16    // payload per job, each direction
+#define I2C_SUBMIT_WAIT_MS  20    // a full queue blocks the submitter this long
+#define I2C_BURST_MAX_BYTES 256   // longest single write transaction
+
+/**
+ * Completion callback, called on the engine task (inline in the native
+ * build). data/len are the bytes read (NULL/0 for writes or on failure).
+ */
+typedef void (*I2CCallback)(void* context, bool ok, const uint8_t* data, size_t len);
+
+/**
+ * Counters for one device address.
+ */
+struct I2CDeviceStats {
+    uint8_t address;
+    uint32_t transactions;        // completed successfully
+    uint32_t bytesOut;            // payload bytes written
+    uint32_t bytesIn;             // payload bytes read
+    uint32_t nacks;               // address or data NACK
+    uint32_t timeouts;
+    uint32_t otherErrors;
+    uint32_t retries;
+    uint32_t failures;            // gave up after retries
+    uint32_t latencyHist[I2C_HIST_BUCKETS];
+    uint32_t maxLatencyUs;
+    uint64_t latencySumUs;
+};
+
+/**
+ * Bus‑wide counters.
+ */
+struct I2CBusStats {
+    uint32_t recoveries;          // SCL clock‑out recoveries performed
+    uint32_t consecutiveFailures;
+    uint32_t jobsQueued;          // jobs handed to the engine
+    uint32_t queueHighWater;      // most jobs waiting at once
+    uint32_t queueFullWaits;      // submitter had to wait for a free slot
+    uint32_t submitFailures;      // queue stayed full for I2C_SUBMIT_WAIT_MS
+};
+
+/**
+ * Start the bus and, on the device, the engine task (replaces
+ * Wire.begin/setClock).
+ */
+void i2cBusBegin(int sda, int scl, uint32_t frequency);
+
+uint32_t i2cBusFrequency();
+
+/**
+ * Queue a write and return without waiting for it.
+ * @param callback optional, told the outcome once the job ran
+ * @return false if len exceeds I2C_JOB_MAX_BYTES or the queue stayed full
+ */
+bool i2cSubmitWrite(uint8_t address, const uint8_t* data, size_t len,
+                    I2CCallback callback = NULL, void* context = NULL);
+
+/**
+ * Queue a read of len bytes; the bytes are handed to the callback.
+ */
+bool i2cSubmitRead(uint8_t address, size_t len, I2CCallback callback, void* context = NULL);
+
+/**
+ * Block until every job queued so far has completed.
+ */
+void i2cDrain();
+
+/**
+ * Write a long run of bytes in one transaction and wait. Meant for
+ * devices that act on every byte/word as it is ACKed (PCF8575 bursts):
+ * the data is sent straight from the caller's buffer and a failed burst
+ * is not retried, since part of it has already taken effect.
+ * @return false if len exceeds I2C_BURST_MAX_BYTES or the write failed
+ */
+bool i2cWriteBurst(uint8_t address, const uint8_t* data, size_t len);
+
+/**
+ * Time on the wire of `bytes` data bytes at the bus clock, rounded up (µs).
+ */
+uint32_t i2cBytesMicros(size_t bytes);
+
+/**
+ * Write bytes to a device and wait. Returns true on ACK of all bytes.
+ * len 0 probes the address.
+ */
+bool i2cWrite(uint8_t address, const uint8_t* data, size_t len);
+
+/**
+ * Read exactly len bytes and wait. Returns true if all bytes were received.
+ */
+bool i2cRead(uint8_t address, uint8_t* data, size_t len);
+
+/**
+ * Write a register pointer, then read len bytes (repeated start). One
+ * job, so no other transaction can get between pointer and read.
+ */
+bool i2cReadRegister(uint8_t address, uint8_t reg, uint8_t* data, size_t len);
+
+/**
+ * Free a stuck bus: clock SCL until SDA is released, send STOP, re‑init.
+ */
+void i2cRecoverBus();
+
+/**
+ * Number of tracked device entries and access to them.
+ */
+int i2cDeviceCount();
+const I2CDeviceStats& i2cDeviceStats(int index);
+const I2CBusStats& i2cBusStats();
+
+/**
+ * Upper bound (µs) of a histogram bucket, 0 for the overflow bucket.
+ */
+uint32_t i2cHistBucketLimit(int bucket);
+
+#endif
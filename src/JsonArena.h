@@ -0,0 +1,100 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * @file JsonArena.h
+ * ArduinoJson allocator over a fixed, preallocated buffer. A document
+ * using it never touches the shared heap: blocks are carved from the
+ * buffer and the whole arena rewinds once the last block is released
+ * (i.e. when the document is destroyed or cleared).
+ *
+ * One arena per task – it is not thread‑safe.
+ */
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    JsonArena(void* buffer, size_t size)
+        : base((uint8_t*)buffer), cap(size) {}
+
+    /**
+     * Hand the arena its buffer later (e.g. a PSRAM block at boot).
+     * Only valid while no block is allocated.
+     */
+    void attach(void* buffer, size_t size) {
+        base = (uint8_t*)buffer;
+        cap = size;
+        top = 0;
+        live = 0;
+    }
+
+    void* allocate(size_t size) override {
+        size_t need = blockSize(size);
+        if (base == NULL || top + need > cap) {
+            failures++;
+            return NULL;
+        }
+        Header* h = (Header*)(base + top);
+        h->size = size;
+        top += need;
+        live++;
+        if (top > peak) peak = top;
+        return h + 1;
+    }
+
+    void deallocate(void* ptr) override {
+        if (ptr == NULL) return;
+        Header* h = (Header*)ptr - 1;
+        if (isLast(h)) top -= blockSize(h->size);   // LIFO release shrinks in place
+        if (--live == 0) top = 0;
+    }
+
+    void* reallocate(void* ptr, size_t newSize) override {
+        if (ptr == NULL) return allocate(newSize);
+        Header* h = (Header*)ptr - 1;
+        if (isLast(h)) {
+            size_t start = (uint8_t*)h - base;
+            if (start + blockSize(newSize) > cap) {
+                failures++;
+                return NULL;
+            }
+            top = start + blockSize(newSize);
+            if (top > peak) peak = top;
+            h->size = newSize;
+            return ptr;
+        }
+        void* moved = allocate(newSize);
+        if (moved == NULL) return NULL;
+        memcpy(moved, ptr, h->size < newSize ? h->size : newSize);
+        deallocate(ptr);
+        return moved;
+    }
+
+    size_t capacity() const { return cap; }
+    size_t peakUsage() const { return peak; }        // high‑water mark, bytes
+    uint32_t failedAllocations() const { return failures; }
+
+private:
+    struct Header {
+        uint32_t size;
+        uint32_t reserved;          // keeps payloads 8‑byte aligned
+    };
+
+    static size_t blockSize(size_t size) {
+        return sizeof(Header) + ((size + 7) & ~(size_t)7);
+    }
+
+    bool isLast(const Header* h) const {
+        return (const uint8_t*)h + blockSize(h->size) == base + top;
+    }
+
+    uint8_t* base;
+    size_t cap;
+    size_t top = 0;
+    size_t live = 0;
+    size_t peak = 0;
+    uint32_t failures = 0;
+};
+
+#endif
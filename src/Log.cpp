@@ -0,0 +1,140 @@
+#include <Arduino.h>
+#include <atomic>
+
+#include "Log.h"
+#include "TaskPlan.h"
+#include "MemoryPlan.h"
+
+/**
+ * Ring slot. `seq` implements a bounded MPMC queue (Vyukov): a slot is
+ * free for write position p when seq == p and readable when seq == p + 1.
+ */
+struct LogSlot {
+    std::atomic<uint32_t> seq;
+    uint32_t timestampUs;
+    const char* fmt;
+    uint8_t level;
+    uint8_t nargs;
+    uintptr_t args[LOG_MAX_ARGS];
+};
+
+static LogSlot ring[LOG_RING_SIZE];
+static std::atomic<uint32_t> writePos(0);
+static uint32_t readPos = 0;              // single consumer
+static std::atomic<uint32_t> droppedCount(0);   // since last drain
+static std::atomic<uint32_t> droppedTotal(0);
+static LogSink extraSink = NULL;
+static bool ringReady = false;
+
+static const char LEVEL_CHARS[] = {'D', 'I', 'W', 'E'};
+
+static void initRing() {
+    for (uint32_t i = 0; i < LOG_RING_SIZE; i++) {
+        ring[i].seq.store(i, std::memory_order_relaxed);
+    }
+    ringReady = true;
+}
+
+void logWrite(uint8_t level, const char* fmt, uint8_t nargs, const uintptr_t* args) {
+    if (!ringReady) initRing();
+
+    uint32_t pos = writePos.load(std::memory_order_relaxed);
+    LogSlot* slot;
+    for (;;) {
+        slot = &ring[pos & (LOG_RING_SIZE - 1)];
+        uint32_t seq = slot->seq.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);   // ring full
+            droppedTotal.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = writePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->timestampUs = micros();
+    slot->fmt = fmt;
+    slot->level = level;
+    slot->nargs = nargs;
+    for (uint8_t i = 0; i < nargs; i++) slot->args[i] = args[i];
+    slot->seq.store(pos + 1, std::memory_order_release);
+
+#ifdef NATIVE_BUILD
+    drainLog();   // single‑threaded host: keep output in program order
+#endif
+}
+
+// -------------------------------------------------------------------
+// Format one record into a line and hand it to the outputs.
+// -------------------------------------------------------------------
+static void emitRecord(const LogSlot& r) {
+    char line[192];
+    unsigned long ms = r.timestampUs / 1000;
+    int n = snprintf(line, sizeof(line), "[%lu.%03lu] %c ", ms / 1000, ms % 1000,
+                     LEVEL_CHARS[r.level & 3]);
+    if (n < 0) return;
+    // Unused trailing arguments are ignored by snprintf
+    snprintf(line + n, sizeof(line) - n, r.fmt,
+             r.args[0], r.args[1], r.args[2], r.args[3]);
+
+    size_t len = strlen(line);
+    if (len > 0 && line[len - 1] == '\n') line[--len] = '\0';
+
+    Serial.println(line);
+    if (extraSink) extraSink(line);
+}
+
+void drainLog() {
+    if (!ringReady) return;
+    for (;;) {
+        LogSlot& slot = ring[readPos & (LOG_RING_SIZE - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != readPos + 1) break;
+
+        LogSlot copy;
+        copy.timestampUs = slot.timestampUs;
+        copy.fmt = slot.fmt;
+        copy.level = slot.level;
+        copy.nargs = slot.nargs;
+        for (int i = 0; i < LOG_MAX_ARGS; i++) copy.args[i] = i < slot.nargs ? slot.args[i] : 0;
+        slot.seq.store(readPos + LOG_RING_SIZE, std::memory_order_release);
+        readPos++;
+
+        emitRecord(copy);
+    }
+
+    uint32_t lost = droppedCount.exchange(0, std::memory_order_relaxed);
+    if (lost) {
+        Serial.printf("[log] %lu records dropped (ring full)\n", (unsigned long)lost);
+    }
+}
+
+void setLogSink(LogSink sink) {
+    extraSink = sink;
+}
+
+uint32_t getLogDropped() {
+    return droppedTotal.load(std::memory_order_relaxed);
+}
+
+#ifndef NATIVE_BUILD
+// -------------------------------------------------------------------
+// Low‑priority drain task (core 0, below the network tasks).
+// -------------------------------------------------------------------
+static void logDrainTask(void *pvParameters) {
+    for (;;) {
+        drainLog();
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+#endif
+
+void setupLogging() {
+    if (!ringReady) initRing();
+    planRegisterStatic("log ring", sizeof(ring));
+#ifndef NATIVE_BUILD
+    startPlannedTask(TASK_LOG_DRAIN, logDrainTask, NULL, NULL);
+#endif
+}
@@ -0,0 +1,93 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+/**
+ * @file Log.h
+ * Deferred logging for hot paths. A log call stores a timestamp, the
+ * format string pointer and up to four word‑sized arguments into a
+ * lock‑free ring; a low‑priority task formats and writes them to Serial
+ * and to the /api/logs WebSocket.
+ *
+ * Format strings must be literals and %s arguments must point to static
+ * strings – both are only read when the record is drained. Arguments are
+ * stored as uintptr_t, so use %d/%u/%x/%p/%s/%c (no %lld or %f).
+ */
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+// Compile‑time filter: calls below this level compile to nothing
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_RING_SIZE 256            // records, power of two
+#define LOG_MAX_ARGS  4
+
+/**
+ * Store one record (never blocks; drops and counts if the ring is full).
+ */
+void logWrite(uint8_t level, const char* fmt, uint8_t nargs, const uintptr_t* args);
+
+template <typename T>
+inline uintptr_t logArg(T v) { return (uintptr_t)v; }
+
+template <typename... Args>
+inline void logRecord(uint8_t level, const char* fmt, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    const uintptr_t packed[LOG_MAX_ARGS + 1] = { logArg(args)... };
+    logWrite(level, fmt, sizeof...(Args), packed);
+}
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_D(fmt, ...) logRecord(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_I(fmt, ...) logRecord(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_W(fmt, ...) logRecord(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_E(fmt, ...) logRecord(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...) do {} while (0)
+#endif
+
+/**
+ * Extra output for formatted lines (e.g. the /api/logs WebSocket).
+ */
+typedef void (*LogSink)(const char* line);
+void setLogSink(LogSink sink);
+
+/**
+ * Start the drain task. Call once, early in setup().
+ * On the native build records are formatted synchronously instead.
+ */
+void setupLogging();
+
+/**
+ * Format and output everything currently in the ring (drain task body).
+ */
+void drainLog();
+
+/**
+ * Records lost because the ring was full.
+ */
+uint32_t getLogDropped();
+
+#endif
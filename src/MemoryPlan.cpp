@@ -0,0 +1,87 @@
+#include <Arduino.h>
+
+#include "MemoryPlan.h"
+#include "TaskPlan.h"
+
+#ifndef NATIVE_BUILD
+#include <esp_heap_caps.h>
+#endif
+
+static MemoryBudgetEntry entries[MEMORY_PLAN_MAX_ENTRIES];
+static int entryCount = 0;
+static portMUX_TYPE planMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void addEntry(const char* name, size_t bytes, MemRegion region) {
+    portENTER_CRITICAL(&planMux);
+    if (entryCount < MEMORY_PLAN_MAX_ENTRIES) {
+        entries[entryCount++] = { name, bytes, region };
+    }
+    portEXIT_CRITICAL(&planMux);
+}
+
+void* planAllocate(const char* name, size_t bytes, MemRegion prefer) {
+    void* p = NULL;
+    MemRegion region = MEM_INTERNAL;
+#ifdef NATIVE_BUILD
+    p = malloc(bytes);
+    region = prefer;
+#else
+    if (prefer == MEM_PSRAM) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (p) region = MEM_PSRAM;
+    }
+    if (!p) p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#endif
+    if (p) {
+        addEntry(name, bytes, region);
+    } else {
+        Serial.printf("[MEM] %s: %u bytes not available\n", name, (unsigned)bytes);
+    }
+    return p;
+}
+
+void planRegisterStatic(const char* name, size_t bytes) {
+    addEntry(name, bytes, MEM_STATIC);
+}
+
+int getMemoryPlanCount() {
+    return entryCount;
+}
+
+const MemoryBudgetEntry& getMemoryPlanEntry(int index) {
+    return entries[index];
+}
+
+const char* getMemRegionName(MemRegion region) {
+    switch (region) {
+        case MEM_STATIC:   return "static";
+        case MEM_INTERNAL: return "internal";
+        case MEM_PSRAM:    return "psram";
+    }
+    return "?";
+}
+
+void printMemoryBudget() {
+    size_t totals[3] = {0, 0, 0};
+    Serial.println("[MEM] Memory plan:");
+    for (int i = 0; i < entryCount; i++) {
+        const MemoryBudgetEntry& e = entries[i];
+        Serial.printf("  %-20s %8u  %s\n", e.name, (unsigned)e.bytes, getMemRegionName(e.region));
+        totals[e.region] += e.bytes;
+    }
+    for (int r = 0; r < TASK_ROLE_COUNT; r++) {
+        const TaskPlacement& p = getTaskPlacement((TaskRole)r);
+        if (!p.staticStack) continue;
+        Serial.printf("  %-20s %8u  static (task stack)\n", p.name, (unsigned)p.stackSize);
+        totals[MEM_STATIC] += p.stackSize;
+    }
+    Serial.printf("  total: static %u, internal %u, psram %u\n",
+                  (unsigned)totals[MEM_STATIC], (unsigned)totals[MEM_INTERNAL],
+                  (unsigned)totals[MEM_PSRAM]);
+#ifndef NATIVE_BUILD
+    Serial.printf("  heap left: internal %u (largest %u), psram %u\n",
+                  (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+                  (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+                  (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+#endif
+}
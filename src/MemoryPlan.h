@@ -0,0 +1,50 @@
+#ifndef MEMORY_PLAN_H
+#define MEMORY_PLAN_H
+
+#include <Arduino.h>
+
+/**
+ * @file MemoryPlan.h
+ * Boot‑time memory budget. Long‑lived buffers are either static or
+ * allocated once during boot through planAllocate(), so the steady‑state
+ * firmware does not churn the shared heap. Large, latency‑tolerant
+ * buffers go to PSRAM when present. printMemoryBudget() lists every
+ * planned block, the static task stacks and the remaining heap.
+ */
+
+enum MemRegion {
+    MEM_STATIC = 0,          // .bss / .data, internal RAM
+    MEM_INTERNAL,            // internal heap, allocated at boot
+    MEM_PSRAM                // external PSRAM, allocated at boot
+};
+
+struct MemoryBudgetEntry {
+    const char* name;
+    size_t bytes;
+    MemRegion region;
+};
+
+#define MEMORY_PLAN_MAX_ENTRIES 16
+
+/**
+ * Allocate a long‑lived block at boot. With MEM_PSRAM the block falls
+ * back to internal RAM if PSRAM is missing or full.
+ * @return NULL if neither region has room (the entry is still listed).
+ */
+void* planAllocate(const char* name, size_t bytes, MemRegion prefer);
+
+/**
+ * List a static buffer in the budget report.
+ */
+void planRegisterStatic(const char* name, size_t bytes);
+
+int getMemoryPlanCount();
+const MemoryBudgetEntry& getMemoryPlanEntry(int index);
+const char* getMemRegionName(MemRegion region);
+
+/**
+ * Print the budget (planned blocks, static task stacks, free heap).
+ */
+void printMemoryBudget();
+
+#endif
@@ -0,0 +1,188 @@
+#include <Arduino.h>
+#include <stdarg.h>
+
+#include "Metrics.h"
+#include "ConfigManager.h"
+#include "SegmentController.h"
+#include "TimerController.h"
+#include "I2CBus.h"
+#include "Log.h"
+#include "DeviceState.h"
+#include "DisplaySync.h"
+#include "TimeWarp.h"
+#include "StepTuner.h"
+#include "EventStore.h"
+
+extern ConfigManager configManager;
+
+NetworkMetrics networkMetrics;
+
+static const char* const ROUTE_NAMES[ROUTE_COUNT] = {
+    "/api/state", "/api/config GET", "/api/config POST", "/api/stop", "/api/sync",
+    "/api/calibrate", "/api/reset", "/api/test", "/api/testall", "/api/storage",
+    "/api/boot", "/api/clock", "/api/i2c", "/api/bench/motion", "/metrics",
+    "/api/profiler", "/api/trace", "/api/jitter", "/api/group", "/api/warp", "/api/tune",
+    "/api/batch", "/api/events"
+};
+
+/**
+ * Bounded appender over a fixed buffer.
+ */
+struct MetricsWriter {
+    char* buf;
+    size_t cap;
+    size_t len;
+
+    void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        if (len >= cap) return;
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(buf + len, cap - len, fmt, args);
+        va_end(args);
+        if (n > 0) len += ((size_t)n < cap - len) ? (size_t)n : cap - len - 1;
+    }
+
+    void header(const char* name, const char* type, const char* help) {
+        printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    void counter(const char* name, const char* help, unsigned long long v) {
+        header(name, "counter", help);
+        printf("%s %llu\n", name, v);
+    }
+
+    void gauge(const char* name, const char* help, long long v) {
+        header(name, "gauge", help);
+        printf("%s %lld\n", name, v);
+    }
+};
+
+size_t renderMetrics(char* buf, size_t cap) {
+    if (cap == 0) return 0;
+    MetricsWriter w = {buf, cap, 0};
+    buf[0] = '\0';
+
+    // ---- Timer ----
+    w.gauge("splitflap_timer_running", "1 if the countdown is running", isTimerStopped() ? 0 : 1);
+    w.gauge("splitflap_remaining_value", "Remaining countdown value in the configured unit",
+            configManager.getCurrentValueRemaining());
+    w.gauge("splitflap_clock_valid", "1 once the wall clock is set", isTimeValid() ? 1 : 0);
+    w.gauge("splitflap_time_warp_factor", "Countdown clock speed (1 = real time)", getTimeWarpFactor());
+
+    // ---- Motion ----
+    const MotionStats& m = getMotionStats();
+    w.counter("splitflap_moves_completed_total", "Display moves completed", m.movesCompleted);
+    w.counter("splitflap_steps_issued_total", "Motor half-steps issued", m.halfSteps);
+    w.counter("splitflap_values_skipped_total", "Countdown values passed without being shown", m.valuesSkipped);
+    w.counter("splitflap_targets_replaced_total", "Queued move targets replaced before their move", m.targetsReplaced);
+    w.counter("splitflap_pcf_writes_total", "PCF8575 single-frame writes", m.i2cWrites);
+    w.counter("splitflap_pcf_bursts_total", "PCF8575 burst transactions", m.burstWrites);
+    w.counter("splitflap_pcf_burst_words_total", "Words sent in PCF8575 bursts, padding included", m.burstWords);
+    w.counter("splitflap_hall_reads_total", "Hall sensor reads", m.i2cReads);
+    w.gauge("splitflap_motors_homed", "1 if all segments are homed", areMotorsHomed() ? 1 : 0);
+    w.gauge("splitflap_calibration_in_progress", "1 while homing runs", isCalibrationInProgress() ? 1 : 0);
+
+    w.header("splitflap_homing_duration_ms", "gauge", "Duration of the last homing per segment");
+    for (int i = 0; i < DISPLAY_DIGITS; i++) {
+        w.printf("splitflap_homing_duration_ms{segment=\"%d\"} %lu\n", i,
+                 (unsigned long)getHomingStats(i).durationMs);
+    }
+    w.header("splitflap_hall_trigger_steps", "gauge", "Half-steps until the Hall sensor triggered at last homing");
+    for (int i = 0; i < DISPLAY_DIGITS; i++) {
+        w.printf("splitflap_hall_trigger_steps{segment=\"%d\"} %ld\n", i,
+                 (long)getHomingStats(i).triggerStep);
+    }
+    w.counter("splitflap_homing_runs_total", "Segment homing runs", getHomingRuns());
+    w.header("splitflap_step_period_us", "gauge", "Settle time after each step frame per segment");
+    for (int i = 0; i < DISPLAY_DIGITS; i++) {
+        w.printf("splitflap_step_period_us{segment=\"%d\"} %u\n", i, (unsigned)getStepPeriodUs(i));
+    }
+    w.gauge("splitflap_step_tuned_at_seconds", "Epoch of the last step-rate tuning (0 = never)", getStepTunedAt());
+
+    // ---- I2C ----
+    w.header("splitflap_i2c_transactions_total", "counter", "Successful I2C transactions per address");
+    for (int i = 0; i < i2cDeviceCount(); i++) {
+        const I2CDeviceStats& s = i2cDeviceStats(i);
+        w.printf("splitflap_i2c_transactions_total{addr=\"0x%02X\"} %lu\n", s.address, (unsigned long)s.transactions);
+    }
+    w.header("splitflap_i2c_errors_total", "counter", "I2C errors per address and kind");
+    for (int i = 0; i < i2cDeviceCount(); i++) {
+        const I2CDeviceStats& s = i2cDeviceStats(i);
+        w.printf("splitflap_i2c_errors_total{addr=\"0x%02X\",kind=\"nack\"} %lu\n", s.address, (unsigned long)s.nacks);
+        w.printf("splitflap_i2c_errors_total{addr=\"0x%02X\",kind=\"timeout\"} %lu\n", s.address, (unsigned long)s.timeouts);
+        w.printf("splitflap_i2c_errors_total{addr=\"0x%02X\",kind=\"other\"} %lu\n", s.address, (unsigned long)s.otherErrors);
+        w.printf("splitflap_i2c_errors_total{addr=\"0x%02X\",kind=\"failed\"} %lu\n", s.address, (unsigned long)s.failures);
+    }
+    w.header("splitflap_i2c_latency_us", "histogram", "I2C transaction latency per address");
+    for (int i = 0; i < i2cDeviceCount(); i++) {
+        const I2CDeviceStats& s = i2cDeviceStats(i);
+        unsigned long cumulative = 0;
+        for (int b = 0; b < I2C_HIST_BUCKETS; b++) {
+            cumulative += s.latencyHist[b];
+            uint32_t limit = i2cHistBucketLimit(b);
+            if (limit) {
+                w.printf("splitflap_i2c_latency_us_bucket{addr=\"0x%02X\",le=\"%lu\"} %lu\n",
+                         s.address, (unsigned long)limit, cumulative);
+            } else {
+                w.printf("splitflap_i2c_latency_us_bucket{addr=\"0x%02X\",le=\"+Inf\"} %lu\n",
+                         s.address, cumulative);
+            }
+        }
+        w.printf("splitflap_i2c_latency_us_sum{addr=\"0x%02X\"} %llu\n", s.address,
+                 (unsigned long long)s.latencySumUs);
+        w.printf("splitflap_i2c_latency_us_count{addr=\"0x%02X\"} %lu\n", s.address, cumulative);
+    }
+    const I2CBusStats& bus = i2cBusStats();
+    w.counter("splitflap_i2c_bus_recoveries_total", "I2C bus recoveries", bus.recoveries);
+    w.counter("splitflap_i2c_jobs_queued_total", "I2C jobs handed to the bus engine", bus.jobsQueued);
+    w.gauge("splitflap_i2c_queue_high_water", "Most I2C jobs waiting at once", bus.queueHighWater);
+    w.counter("splitflap_i2c_queue_full_waits_total", "I2C submits that waited for a free queue slot", bus.queueFullWaits);
+    w.counter("splitflap_i2c_submit_failures_total", "I2C jobs dropped on a full queue", bus.submitFailures);
+
+    // ---- Network ----
+    w.header("splitflap_http_requests_total", "counter", "HTTP requests per route");
+    for (int r = 0; r < ROUTE_COUNT; r++) {
+        w.printf("splitflap_http_requests_total{route=\"%s\"} %lu\n", ROUTE_NAMES[r],
+                 (unsigned long)networkMetrics.httpRequests[r].load(std::memory_order_relaxed));
+    }
+    w.gauge("splitflap_ws_clients", "Connected WebSocket clients",
+            networkMetrics.wsClients.load(std::memory_order_relaxed));
+    w.header("splitflap_ws_subscribers", "gauge", "WebSocket clients per topic");
+    for (int t = 0; t < WS_TOPIC_COUNT; t++) {
+        w.printf("splitflap_ws_subscribers{topic=\"%s\"} %lu\n", wsTopicName(t),
+                 (unsigned long)networkMetrics.wsSubscribers[t].load(std::memory_order_relaxed));
+    }
+    w.counter("splitflap_ws_frames_sent_total", "WebSocket frames queued",
+              networkMetrics.wsFramesSent.load(std::memory_order_relaxed));
+    w.counter("splitflap_ws_frames_dropped_total", "WebSocket frames dropped (client queue full)",
+              networkMetrics.wsFramesDropped.load(std::memory_order_relaxed));
+    w.gauge("splitflap_ntp_offset_ms", "NTP minus system clock at the last sync",
+            networkMetrics.ntpOffsetMs.load(std::memory_order_relaxed));
+    w.counter("splitflap_ntp_syncs_total", "Successful NTP syncs",
+              networkMetrics.ntpSyncs.load(std::memory_order_relaxed));
+    const SyncStatus& sync = getSyncStatus();
+    w.gauge("splitflap_sync_locked", "1 while following a live sync leader", sync.locked ? 1 : 0);
+    w.gauge("splitflap_sync_offset_us", "Leader minus local clock, best sample of the window", sync.lastOffsetUs);
+    w.gauge("splitflap_sync_rtt_us", "Round trip of the best offset sample", sync.lastRttUs);
+    w.counter("splitflap_sync_clock_steps_total", "System clock steps towards the leader", sync.clockSteps);
+    w.counter("splitflap_sync_flips_total", "Timer ticks fired at a scheduled flip", sync.flipsFired);
+    w.gauge("splitflap_sync_flip_late_max_us", "Worst start delay of a scheduled flip", sync.maxFlipLateUs);
+
+    // ---- Storage / memory ----
+    const StorageStats& st = configManager.getStats();
+    w.counter("splitflap_nvs_writes_total", "Config blobs written to NVS", st.flashWrites);
+    w.counter("splitflap_nvs_skipped_writes_total", "Flushes skipped because bytes were unchanged", st.skippedWrites);
+    EventStoreStats ev = getEventStoreStats();
+    w.counter("splitflap_events_recorded_total", "History events queued", ev.recorded);
+    w.counter("splitflap_events_written_total", "History events written to LittleFS", ev.written);
+    w.counter("splitflap_events_dropped_total", "History events lost (queue full or write error)", ev.dropped);
+    w.gauge("splitflap_event_store_records", "History events on flash", ev.records);
+    w.gauge("splitflap_free_heap_bytes", "Free heap", ESP.getFreeHeap());
+    w.gauge("splitflap_largest_free_block_bytes", "Largest allocatable heap block", ESP.getMaxAllocHeap());
+    w.counter("splitflap_log_dropped_total", "Log records dropped because the ring was full", getLogDropped());
+    w.counter("splitflap_state_snapshot_retries_total", "Device state snapshots repeated due to a concurrent write",
+              deviceState.getSnapshotRetries());
+    w.gauge("splitflap_uptime_seconds", "Seconds since boot", millis() / 1000);
+
+    return w.len;
+}
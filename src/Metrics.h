@@ -0,0 +1,73 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "WsTopics.h"
+
+/**
+ * @file Metrics.h
+ * Lock‑free counters/gauges and a Prometheus text renderer for /metrics.
+ * Rendering writes into a caller‑supplied buffer – no heap allocation.
+ */
+
+/**
+ * HTTP routes counted by the request counter.
+ */
+enum HttpRoute {
+    ROUTE_STATE = 0,
+    ROUTE_CONFIG_GET,
+    ROUTE_CONFIG_POST,
+    ROUTE_STOP,
+    ROUTE_SYNC,
+    ROUTE_CALIBRATE,
+    ROUTE_RESET,
+    ROUTE_TEST,
+    ROUTE_TESTALL,
+    ROUTE_STORAGE,
+    ROUTE_BOOT,
+    ROUTE_CLOCK,
+    ROUTE_I2C,
+    ROUTE_BENCH,
+    ROUTE_METRICS,
+    ROUTE_PROFILER,
+    ROUTE_TRACE,
+    ROUTE_JITTER,
+    ROUTE_GROUP,
+    ROUTE_WARP,
+    ROUTE_TUNE,
+    ROUTE_BATCH,
+    ROUTE_EVENTS,
+    ROUTE_COUNT
+};
+
+/**
+ * Counters updated from the network side.
+ */
+struct NetworkMetrics {
+    std::atomic<uint32_t> httpRequests[ROUTE_COUNT];
+    std::atomic<uint32_t> wsFramesSent;
+    std::atomic<uint32_t> wsFramesDropped;   // client queue full at broadcast
+    std::atomic<uint32_t> wsClients;
+    std::atomic<uint32_t> wsSubscribers[WS_TOPIC_COUNT];    // clients per /ws topic
+    std::atomic<int32_t> ntpOffsetMs;        // NTP − system clock at last sync
+    std::atomic<uint32_t> ntpSyncs;
+};
+
+extern NetworkMetrics networkMetrics;
+
+/**
+ * Count one request to a route.
+ */
+inline void metricsCountRequest(HttpRoute route) {
+    networkMetrics.httpRequests[route].fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Render all metrics in Prometheus text exposition format (0.0.4).
+ * @return bytes written (output is truncated, never overflowed, if cap is small)
+ */
+size_t renderMetrics(char* buf, size_t cap);
+
+#endif
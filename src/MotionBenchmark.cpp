@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <stdarg.h>
+
+#include "MotionBenchmark.h"
+#include "SegmentController.h"
+#include "SegmentArray.h"
+#include "TimerController.h"
+#include "TaskPlan.h"
+#include "I2CBus.h"
+
+#ifdef NATIVE_BUILD
+#define BENCH_PLATFORM "native"
+#else
+#include <LittleFS.h>
+#define BENCH_PLATFORM "esp32s3"
+#endif
+
+// -------------------------------------------------------------------
+// Emit helper: format into a small stack buffer and pass to the sink.
+// -------------------------------------------------------------------
+static void emitf(BenchSink sink, void* ctx, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+static void emitf(BenchSink sink, void* ctx, const char* fmt, ...) {
+    char buf[192];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    sink(buf, ctx);
+}
+
+static bool validParams(int from, int to, int stride) {
+    return from >= 0 && from <= DisplayArray::maxValue() && to >= 0 && to <= from && stride >= 1;
+}
+
+// -------------------------------------------------------------------
+// The run itself; the caller holds the motion lock, so no other move
+// or calibration touches the drums meanwhile.
+// -------------------------------------------------------------------
+static void runLocked(int from, int to, int stride,
+                      BenchSink sink, void* ctx, MotionBenchSummary* summary) {
+    MotionBenchSummary sum = {};
+
+    // Position the display at the first value (not measured)
+    moveToValueBlocking(from);
+
+    emitf(sink, ctx,
+          "{\"benchmark\":\"motion\",\"firmware\":\"%s\",\"platform\":\"%s\","
+          "\"i2cClockHz\":%lu,\"from\":%d,\"to\":%d,\"stride\":%d,\"transitions\":[\n",
+          FIRMWARE_VERSION, BENCH_PLATFORM, (unsigned long)i2cBusFrequency(), from, to, stride);
+
+    for (int value = from; value - stride >= to; value -= stride) {
+        int next = value - stride;
+        MotionStats before = getMotionStats();
+        unsigned long t0 = micros();
+
+        moveToValueBlocking(next);
+
+        uint32_t us = (uint32_t)(micros() - t0);
+        const MotionStats& after = getMotionStats();
+        uint32_t halfSteps = after.halfSteps - before.halfSteps;
+        uint32_t i2c = (after.i2cWrites - before.i2cWrites) + (after.burstWrites - before.burstWrites) +
+                       (after.i2cReads - before.i2cReads);
+        uint32_t bytes = after.i2cBytes - before.i2cBytes;
+
+        emitf(sink, ctx, "%s{\"from\":%d,\"to\":%d,\"us\":%lu,\"halfSteps\":%lu,\"i2c\":%lu,\"bytes\":%lu}",
+              sum.transitions ? ",\n" : "", value, next, (unsigned long)us,
+              (unsigned long)halfSteps, (unsigned long)i2c, (unsigned long)bytes);
+
+        sum.transitions++;
+        sum.totalMicros += us;
+        if (us > sum.maxMicros) {
+            sum.maxMicros = us;
+            sum.worstFrom = value;
+        }
+        sum.totalHalfSteps += halfSteps;
+        if (halfSteps > sum.maxHalfSteps) sum.maxHalfSteps = halfSteps;
+        sum.totalI2cTransactions += i2c;
+        sum.totalI2cBytes += bytes;
+    }
+
+    uint32_t n = sum.transitions ? sum.transitions : 1;
+    emitf(sink, ctx,
+          "\n],\"summary\":{\"transitions\":%lu,\"meanUs\":%llu,\"maxUs\":%lu,\"worstFrom\":%d,"
+          "\"totalHalfSteps\":%llu,\"maxHalfSteps\":%lu,",
+          (unsigned long)sum.transitions, (unsigned long long)(sum.totalMicros / n),
+          (unsigned long)sum.maxMicros, sum.worstFrom,
+          (unsigned long long)sum.totalHalfSteps, (unsigned long)sum.maxHalfSteps);
+    emitf(sink, ctx,
+          "\"totalI2c\":%llu,\"totalBytes\":%llu,\"meanI2c\":%llu,\"meanBytes\":%llu}}\n",
+          (unsigned long long)sum.totalI2cTransactions, (unsigned long long)sum.totalI2cBytes,
+          (unsigned long long)(sum.totalI2cTransactions / n), (unsigned long long)(sum.totalI2cBytes / n));
+
+    if (summary) *summary = sum;
+}
+
+bool runMotionBenchmark(int from, int to, int stride,
+                        BenchSink sink, void* ctx, MotionBenchSummary* summary) {
+    if (!validParams(from, to, stride) || !areMotorsHomed()) return false;
+    if (!acquireMotionLock()) return false;
+    runLocked(from, to, stride, sink, ctx, summary);
+    releaseMotionLock();
+    return true;
+}
+
+#ifndef NATIVE_BUILD
+// -------------------------------------------------------------------
+// Background run on the device, output to LittleFS.
+// -------------------------------------------------------------------
+struct BenchParams {
+    int from;
+    int to;
+    int stride;
+};
+
+static BenchParams benchParams;
+static MotionBenchSummary lastSummary = {};
+static volatile bool benchRunning = false;
+
+static void fileSink(const char* text, void* ctx) {
+    ((File*)ctx)->print(text);
+}
+
+static void motionBenchTask(void *pvParameters) {
+    File f = LittleFS.open(MOTION_BENCH_FILE, "w");
+    if (f) {
+        MotionBenchSummary sum;
+        runLocked(benchParams.from, benchParams.to, benchParams.stride, fileSink, &f, &sum);
+        lastSummary = sum;
+        f.close();
+    } else {
+        Serial.println("Benchmark: cannot open " MOTION_BENCH_FILE);
+    }
+    Serial.printf("Motion benchmark finished: %lu transitions\n",
+                  (unsigned long)lastSummary.transitions);
+    releaseMotionLock();
+    benchRunning = false;
+    vTaskDelete(NULL);
+}
+
+bool startMotionBenchmarkTask(int from, int to, int stride) {
+    if (benchRunning) return false;
+    if (!validParams(from, to, stride) || !areMotorsHomed() || !isTimerStopped()) return false;
+    // Held until the task ends: timer ticks, test moves and calibration
+    // are refused while the benchmark drives the drums
+    if (!acquireMotionLock()) return false;
+
+    benchParams = {from, to, stride};
+    benchRunning = true;
+    startPlannedTask(TASK_MOTION_BENCH, motionBenchTask, NULL, NULL);
+    return true;
+}
+
+bool isMotionBenchmarkRunning() {
+    return benchRunning;
+}
+
+const MotionBenchSummary& getLastMotionBenchSummary() {
+    return lastSummary;
+}
+#endif
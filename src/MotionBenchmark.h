@@ -0,0 +1,66 @@
+#ifndef MOTION_BENCHMARK_H
+#define MOTION_BENCHMARK_H
+
+#include <Arduino.h>
+
+/**
+ * @file MotionBenchmark.h
+ * Replays countdown transitions through the real motion path and reports,
+ * per transition, move time, half‑steps, I2C transactions and bytes as
+ * JSON. Runs on the device and on the native build (simulated expanders).
+ */
+
+#ifndef FIRMWARE_VERSION
+#define FIRMWARE_VERSION "dev"
+#endif
+
+/**
+ * Aggregate over all measured transitions.
+ */
+struct MotionBenchSummary {
+    uint32_t transitions;
+    uint64_t totalMicros;
+    uint32_t maxMicros;
+    int worstFrom;               // transition with the longest move
+    uint64_t totalHalfSteps;
+    uint32_t maxHalfSteps;
+    uint64_t totalI2cTransactions;
+    uint64_t totalI2cBytes;
+};
+
+/**
+ * Receives the JSON output in chunks (no trailing newline guarantees).
+ */
+typedef void (*BenchSink)(const char* text, void* ctx);
+
+/**
+ * Move to `from`, then count down to `to` in steps of `stride`, measuring
+ * every transition. Blocks the caller. Motors must be homed; the motion
+ * lock is held for the whole run.
+ * @return false if parameters are invalid, motors are not homed or busy.
+ */
+bool runMotionBenchmark(int from, int to, int stride,
+                        BenchSink sink, void* ctx, MotionBenchSummary* summary);
+
+#ifndef NATIVE_BUILD
+/**
+ * Start the benchmark in a background task; JSON goes to
+ * MOTION_BENCH_FILE on LittleFS. Takes the motion lock before returning.
+ * Returns false if busy (benchmark, move or calibration) or not allowed.
+ */
+bool startMotionBenchmarkTask(int from, int to, int stride);
+
+/**
+ * True while the background benchmark runs.
+ */
+bool isMotionBenchmarkRunning();
+
+/**
+ * Summary of the last completed background run.
+ */
+const MotionBenchSummary& getLastMotionBenchSummary();
+
+#define MOTION_BENCH_FILE "/bench_motion.json"
+#endif
+
+#endif
@@ -0,0 +1,119 @@
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <stddef.h>
+
+#include "MotionJournal.h"
+#include "SegmentArray.h"
+
+#define JOURNAL_MAGIC 0x4D4A524EUL   // "MJRN"
+
+/**
+ * Journal record. Every update rewrites the whole record and its CRC,
+ * so a reset in the middle of an update is detected as corrupted.
+ */
+struct MotionJournalRecord {
+    uint32_t magic;
+    uint32_t sequence;               // incremented on every update
+    int8_t   committed[DISPLAY_DIGITS];   // digit last fully reached
+    int8_t   target[DISPLAY_DIGITS];      // digit being moved to
+    uint8_t  stepIndex[DISPLAY_DIGITS];   // half‑step phase at last commit
+    uint8_t  inFlight;               // bit per segment currently moving
+    uint8_t  segments;               // DISPLAY_DIGITS of the firmware that wrote it
+    uint8_t  reserved[2];
+    uint32_t crc;
+};
+
+// RTC slow memory, not cleared on reset
+RTC_NOINIT_ATTR static MotionJournalRecord journal;
+
+// -------------------------------------------------------------------
+// CRC32 over the record (without the crc field).
+// -------------------------------------------------------------------
+static uint32_t journalCrc(const MotionJournalRecord& rec) {
+    const uint8_t* data = (const uint8_t*)&rec;
+    size_t len = offsetof(MotionJournalRecord, crc);
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static bool journalValid() {
+    return journal.magic == JOURNAL_MAGIC && journal.segments == DISPLAY_DIGITS &&
+           journal.crc == journalCrc(journal);
+}
+
+static void journalSeal() {
+    journal.sequence++;
+    journal.crc = journalCrc(journal);
+}
+
+// -------------------------------------------------------------------
+// Start a fresh journal: all segments at 0, nothing moving.
+// -------------------------------------------------------------------
+static void journalReset() {
+    memset(&journal, 0, sizeof(journal));
+    journal.magic = JOURNAL_MAGIC;
+    journal.segments = DISPLAY_DIGITS;
+    journalSeal();
+}
+
+JournalState restoreMotionJournal(int* digits, int* stepIndices, uint8_t& inFlightMask) {
+    esp_reset_reason_t reason = esp_reset_reason();
+    inFlightMask = 0;
+
+    if (reason == ESP_RST_POWERON) {
+        Serial.printf("[JOURNAL] No valid journal (reset reason %d)\n", (int)reason);
+        journalReset();
+        return JOURNAL_EMPTY;
+    }
+    // Warm reset: RTC memory survived, so a bad journal means the drums
+    // may be anywhere (e.g. brown‑out while the record was rewritten)
+    if (!journalValid()) {
+        Serial.printf("[JOURNAL] No valid journal (reset reason %d)\n", (int)reason);
+        journalReset();
+        return JOURNAL_INVALID;
+    }
+
+    for (int i = 0; i < DISPLAY_DIGITS; i++) {
+        if (journal.committed[i] < 0 || journal.committed[i] > 9) {
+            Serial.println("[JOURNAL] Digit out of range – discarding");
+            journalReset();
+            return JOURNAL_INVALID;
+        }
+        digits[i] = journal.committed[i];
+        stepIndices[i] = journal.stepIndex[i] & 0x07;
+    }
+    inFlightMask = journal.inFlight;
+
+    Serial.printf("[JOURNAL] Restored %0*d (seq %u, in‑flight 0x%02X)\n",
+                  DISPLAY_DIGITS, DisplayArray::compose(digits),
+                  journal.sequence, inFlightMask);
+
+    return inFlightMask ? JOURNAL_IN_FLIGHT : JOURNAL_CONSISTENT;
+}
+
+void journalBeginMove(int segment, int target) {
+    if (segment < 0 || segment >= DISPLAY_DIGITS) return;
+    journal.target[segment] = (int8_t)target;
+    journal.inFlight |= (1 << segment);
+    journalSeal();
+}
+
+void journalCommitDigit(int segment, int digit, int stepIndex) {
+    if (segment < 0 || segment >= DISPLAY_DIGITS) return;
+    journal.committed[segment] = (int8_t)digit;
+    journal.stepIndex[segment] = (uint8_t)stepIndex;
+    journal.inFlight &= ~(1 << segment);
+    journalSeal();
+}
+
+void clearMotionJournal() {
+    journal.inFlight = (uint8_t)((1 << DISPLAY_DIGITS) - 1);
+    journalSeal();
+}
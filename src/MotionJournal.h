@@ -0,0 +1,55 @@
+#ifndef MOTION_JOURNAL_H
+#define MOTION_JOURNAL_H
+
+#include <Arduino.h>
+
+/**
+ * @file MotionJournal.h
+ * Reset‑safe journal of segment positions kept in RTC memory.
+ * Survives software resets, watchdog and brown‑out resets (not a full
+ * power removal), so the display can resume without homing.
+ */
+
+/**
+ * Result of restoring the journal at boot.
+ */
+enum JournalState {
+    JOURNAL_EMPTY = 0,        // cold power‑on – no journal expected
+    JOURNAL_CONSISTENT = 1,   // all segments at rest – positions are exact
+    JOURNAL_IN_FLIGHT = 2,    // reset hit during a move – homing required
+    JOURNAL_INVALID = 3       // warm reset, journal torn or corrupted – homing required
+};
+
+/**
+ * Validate the journal and copy out committed digits and coil phases.
+ * @param digits receives the committed digit for each segment (DISPLAY_DIGITS)
+ * @param stepIndices receives the half‑step phase for each motor (DISPLAY_DIGITS)
+ * @param inFlightMask receives a bit per segment that was moving
+ */
+JournalState restoreMotionJournal(int* digits, int* stepIndices, uint8_t& inFlightMask);
+
+/**
+ * Record that a segment is about to leave its committed digit.
+ * Call before each digit hop; the segment stays "in flight" until
+ * the next journalCommitDigit().
+ * @param segment 0 … DISPLAY_DIGITS‑1
+ * @param target digit the segment is heading to
+ */
+void journalBeginMove(int segment, int target);
+
+/**
+ * Record that a segment rests exactly on a digit.
+ * @param segment 0 … DISPLAY_DIGITS‑1
+ * @param digit digit now in the window
+ * @param stepIndex current half‑step phase of the motor
+ */
+void journalCommitDigit(int segment, int digit, int stepIndex);
+
+/**
+ * Forget the journalled positions after a failed homing: every segment
+ * is marked in flight, so a reset before the next successful homing
+ * starts calibration. Each segment homed afterwards clears its mark.
+ */
+void clearMotionJournal();
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef SEGMENT_ARRAY_H
+#define SEGMENT_ARRAY_H
+
+#include <Arduino.h>
+
+/**
+ * @file SegmentArray.h
+ * Compile‑time layout of the display: how many digits there are, which
+ * expander and pins drive each drum, and how a display value splits into
+ * digits.
+ *
+ * Segment 0 is the most significant digit. Segments are packed onto
+ * expanders in order, Board::MOTORS_PER_EXPANDER per chip, at consecutive
+ * I2C addresses starting at Board::FIRST_ADDRESS.
+ *
+ * The array also keeps a shadow output word per expander. Changing a
+ * segment's coils only marks its expander dirty; flush() writes each dirty
+ * expander once. A single half‑step therefore costs one frame to one chip
+ * however many digits the build has, and segments sharing a chip that
+ * change together go out in the same frame.
+ */
+
+/**
+ * Board profile: PCF8575 expanders, two ULN2003/28BYJ‑48 motors per chip
+ * on pins 3‑6 and 11‑14, Hall sensors on pins 8 and 9.
+ *
+ * A profile provides FIRST_ADDRESS, MOTORS_PER_EXPANDER, MAX_EXPANDERS,
+ * motorBase(slot), hallPin(slot) and idleWord().
+ */
+struct PCF8575PairBoard {
+    static constexpr uint8_t FIRST_ADDRESS = 0x20;
+    static constexpr int MOTORS_PER_EXPANDER = 2;
+    static constexpr int MAX_EXPANDERS = 8;          // A0‑A2 address pins
+
+    /** First of 4 consecutive coil pins for a motor slot on the chip. */
+    static constexpr int motorBase(int slot) { return slot == 0 ? 3 : 11; }
+    /** Active‑low Hall input for a motor slot. */
+    static constexpr int hallPin(int slot) { return slot == 0 ? 8 : 9; }
+    /** Output word with coils off and Hall pins released as inputs. */
+    static constexpr uint16_t idleWord() { return (1 << 8) | (1 << 9); }
+};
+
+template <int N, class Board>
+class SegmentArray {
+public:
+    static_assert(N >= 1 && N <= 8, "1‑8 segments (journal keeps one in‑flight bit each)");
+
+    static constexpr int SEGMENTS = N;
+    static constexpr int EXPANDERS = (N + Board::MOTORS_PER_EXPANDER - 1) / Board::MOTORS_PER_EXPANDER;
+
+    static_assert(EXPANDERS <= Board::MAX_EXPANDERS, "not enough expander addresses for N segments");
+
+    // ---------------------------------------------------------------
+    // Pin map
+    // ---------------------------------------------------------------
+    static constexpr int expanderOf(int segment) { return segment / Board::MOTORS_PER_EXPANDER; }
+    static constexpr uint8_t address(int expander) { return (uint8_t)(Board::FIRST_ADDRESS + expander); }
+    static constexpr uint8_t addressOf(int segment) { return address(expanderOf(segment)); }
+    static constexpr int motorBase(int segment) { return Board::motorBase(segment % Board::MOTORS_PER_EXPANDER); }
+    static constexpr int hallPin(int segment) { return Board::hallPin(segment % Board::MOTORS_PER_EXPANDER); }
+    static constexpr uint16_t coilMask(int segment) { return (uint16_t)(0x0F << motorBase(segment)); }
+
+    // ---------------------------------------------------------------
+    // Digit decomposition (segment 0 = most significant)
+    // ---------------------------------------------------------------
+    /** 10^(N‑1‑segment): weight of a segment's digit in the value. */
+    static constexpr int placeValue(int segment) {
+        return segment >= N - 1 ? 1 : 10 * placeValue(segment + 1);
+    }
+    /** Largest displayable value (9999 for 4 digits). */
+    static constexpr int maxValue() { return placeValue(0) * 10 - 1; }
+    static constexpr int clampValue(int value) {
+        return value < 0 ? 0 : (value > maxValue() ? maxValue() : value);
+    }
+    static constexpr int digitOf(int value, int segment) { return (value / placeValue(segment)) % 10; }
+    /** `value` with one digit replaced. */
+    static constexpr int withDigit(int value, int segment, int digit) {
+        return value + (digit - digitOf(value, segment)) * placeValue(segment);
+    }
+
+    static void decompose(int value, int* digits) {
+        for (int i = 0; i < N; i++) digits[i] = digitOf(value, i);
+    }
+    static int compose(const int* digits) {
+        int value = 0;
+        for (int i = 0; i < N; i++) value = value * 10 + digits[i];
+        return value;
+    }
+
+    // ---------------------------------------------------------------
+    // Shadow outputs
+    // ---------------------------------------------------------------
+    SegmentArray() : dirty(0) {
+        for (int e = 0; e < EXPANDERS; e++) outputs[e] = Board::idleWord();
+    }
+
+    /** Put a 4‑bit coil pattern on a segment's pins (not written yet). */
+    void setCoils(int segment, uint8_t pattern) {
+        int e = expanderOf(segment);
+        outputs[e] = (uint16_t)((outputs[e] & ~coilMask(segment)) | ((pattern & 0x0F) << motorBase(segment)));
+        dirty |= (1u << e);
+    }
+
+    uint16_t output(int expander) const { return outputs[expander]; }
+
+    /** Force a full rewrite on the next flush() (e.g. at init). */
+    void markAllDirty() { dirty = (1u << EXPANDERS) - 1; }
+
+    /**
+     * Write every dirty expander once, in address order.
+     * @param write called as write(address, word) → bool
+     * @return number of frames sent
+     */
+    template <typename Writer>
+    int flush(Writer write) {
+        int frames = 0;
+        for (int e = 0; e < EXPANDERS && dirty; e++) {
+            if (!(dirty & (1u << e))) continue;
+            write(address(e), outputs[e]);
+            dirty &= ~(1u << e);
+            frames++;
+        }
+        return frames;
+    }
+
+private:
+    uint16_t outputs[EXPANDERS];
+    uint32_t dirty;                 // bit per expander with unwritten changes
+};
+
+// -------------------------------------------------------------------
+// The display this firmware is built for. Override with build flags,
+// e.g. -DDISPLAY_DIGITS=6 for a six‑digit counter on three PCF8575s.
+// -------------------------------------------------------------------
+#ifndef DISPLAY_DIGITS
+#define DISPLAY_DIGITS 4
+#endif
+
+#ifndef DISPLAY_BOARD
+#define DISPLAY_BOARD PCF8575PairBoard
+#endif
+
+typedef SegmentArray<DISPLAY_DIGITS, DISPLAY_BOARD> DisplayArray;
+
+#endif
@@ -3,22 +3,35 @@
 
 #include "ConfigManager.h"
 #include "SegmentController.h"
+#include "SegmentArray.h"
+#include "MotionJournal.h"
+#include "I2CBus.h"
+#include "Log.h"
+#include "StepTrace.h"
+#include "TaskPlan.h"
+#include "DeviceState.h"
 #include "TimerController.h"  // for stopTimer() and startTimer()
+#include "TimeWarp.h"
+#include "StepTuner.h"
+#include "WsTopics.h"
+#include "EventStore.h"
+#ifndef NATIVE_BUILD
+#include <esp_timer.h>
+#endif
 
 // External references
 extern ConfigManager configManager;
-extern bool timerStopped;
 
-// Forward declaration of broadcast function from WebServices
-extern void broadcastState();
 
 // -------------------------------------------------------------------
 // Hardware constants
 // -------------------------------------------------------------------
-#define PCF1_ADDRESS 0x20          // I2C address for first PCF8575 (segments 0,1)
-#define PCF2_ADDRESS 0x21          // I2C address for second PCF8575 (segments 2,3)
+// Pin map, expander grouping and digit decomposition come from
+// DisplayArray (SegmentArray.h); the default build is 4 digits on two
+// PCF8575s at 0x20/0x21.
+const int SEGMENTS = DisplayArray::SEGMENTS;
 
-const int STEPS_PER_REV = 4080;    // 28BYJ-48 full rotation steps (with gearbox)
+const int STEPS_PER_REV = STEPS_PER_REVOLUTION;
 const int DIGITS = 10;             // 0-9
 const int STEPS_PER_DIGIT = STEPS_PER_REV / DIGITS; // ~407 steps per digit
 
@@ -46,69 +59,107 @@ const uint8_t steps[8] = {
     0b0010, 0b0011, 0b0001, 0b1001
 };
 
-// Base pin index for each motor on its PCF8575 (4 consecutive pins per motor)
-const int MOTOR_BASES[4] = {3, 11, 3, 11};
-
-const int HALL_PINS[2] = {8, 9};
-
 // Current step index (0-7) for each motor
-int stepIndices[4] = {0,0,0,0};
+int stepIndices[SEGMENTS] = {};
 
-// Current displayed digit (0-9) for each segment
-int currentDigits[4] = {0,0,0,0};
+// Settle time after each frame per segment, 0 = STEP_PERIOD_DEFAULT_US
+// (tuned by StepTuner)
+static uint16_t stepPeriodUs[SEGMENTS] = {};
 
-// Homing status
-bool motorsHomed = true;           // assume homed until calibration needed
-bool calibrationInProgress = false;
+// Current displayed digit (0-9) for each segment. Owned by the motion
+// path; every change is published to deviceState for other tasks.
+static int currentDigits[SEGMENTS] = {};
 
-// Current output states for the two PCF8575 (both outputs always written together)
-uint16_t motorState1 = (1 << 8) | (1 << 9);  // default: Hall pull‑ups active
-uint16_t motorState2 = (1 << 8) | (1 << 9);
+// Homing/calibration status lives in deviceState (DEV_MOTORS_HOMED starts
+// set – assume homed until calibration is needed)
+
+// Shadow output word per expander (default: Hall pull‑ups active)
+static DisplayArray display;
 
 unsigned long lastUpdate = 0;
 const unsigned long UPDATE_INTERVAL = 1000;  // timer check interval
+const unsigned long MIN_WARP_INTERVAL = 10;  // fastest tick under time‑warp
+static volatile bool tickRequested = false;
+static int lastTickValue = -1;               // remaining value of the last tick
 
 TaskHandle_t calibrationTaskHandle = NULL;
 
 // -------------------------------------------------------------------
-// Non‑blocking motor movement (FreeRTOS task)
+// Non‑blocking motor movement. The motor and calibration tasks are
+// created once (static stacks, see TaskPlan) and wait for work; the
+// motor target goes through a one‑slot queue where the newest value
+// overwrites a pending one.
 // -------------------------------------------------------------------
 TaskHandle_t motorTaskHandle = NULL;
-volatile int targetDisplayValue = -1;         // desired 4‑digit value
 volatile bool motorTaskActive = false;
-SemaphoreHandle_t motorMutex = NULL;
+#ifndef NATIVE_BUILD
+static QueueHandle_t motorQueue = NULL;
+static StaticQueue_t motorQueueStorage;
+static uint8_t motorQueueBuffer[sizeof(int)];
+void motorControlTask(void *pvParameters);
+void calibrationTask(void *pvParameters);
+
+// Coil settling (see settleCoils()): a one‑shot esp_timer gives the
+// semaphore, the stepping task sleeps on it
+static esp_timer_handle_t settleTimer = NULL;
+static SemaphoreHandle_t settleDone = NULL;
+static StaticSemaphore_t settleStorage;
+#endif
+
+// Motion lock (see acquireMotionLock()); the mux also covers the
+// busy checks in startMotorMovement() and startCalibration()
+static volatile bool motionLocked = false;
+static portMUX_TYPE motionMux = portMUX_INITIALIZER_UNLOCKED;
 
 // Прапорець, що після завершення руху треба запустити таймер
 volatile bool startAfterMovement = false;
 
+// Motion/bus cost counters (see getMotionStats())
+MotionStats motionStats = {};
+
+// Last homing result per segment
+HomingStats homingStats[SEGMENTS] = {};
+uint32_t homingRuns = 0;
+
 // -------------------------------------------------------------------
-// Low‑level I2C write to a PCF8575
+// Low‑level I2C write to a PCF8575. Queued, not awaited: the frame goes
+// out on the I2C engine while the caller settles and computes the next
+// one. Returns false only if the frame could not be queued; bus errors
+// show up in the I2C bus stats.
 // -------------------------------------------------------------------
-void writePCF(uint8_t address, uint16_t state) {
-    Wire.beginTransmission(address);
-    Wire.write(state & 0xFF);        // low byte first
-    Wire.write((state >> 8) & 0xFF); // high byte
-    Wire.endTransmission();
+bool writePCF(uint8_t address, uint16_t state) {
+    uint8_t frame[2] = {
+        (uint8_t)(state & 0xFF),         // low byte first
+        (uint8_t)((state >> 8) & 0xFF)   // high byte
+    };
+    bool ok = i2cSubmitWrite(address, frame, sizeof(frame));
+    motionStats.i2cWrites++;
+    motionStats.i2cBytes += 3;       // address + 2 data bytes
+    return ok;
 }
 
 // -------------------------------------------------------------------
 // Read Hall sensor for a given segment.
 // Returns true if magnet is near (active low on PCF8575 input).
+// The read queues behind any frames still pending, so it always sees
+// the drum after the last step. A read that still fails after retries
+// counts as "not active"; the failure is visible in the I2C bus stats.
 // -------------------------------------------------------------------
 bool readHallSensor(int segmentIndex) {
-    int pcfAddress = (segmentIndex < 2) ? PCF1_ADDRESS : PCF2_ADDRESS;
-    int pin = HALL_PINS[segmentIndex % 2];   // Hall on pins 8 or 9
-
-    Wire.requestFrom((uint8_t)pcfAddress, (uint8_t)2);
-    if (Wire.available()) {
-        uint8_t lowByte = Wire.read();
-        uint8_t highByte = Wire.read();
-        uint16_t state = (highByte << 8) | lowByte;
+    int pin = DisplayArray::hallPin(segmentIndex);
+
+    uint8_t data[2];
+    bool ok = i2cRead(DisplayArray::addressOf(segmentIndex), data, sizeof(data));
+    motionStats.i2cReads++;
+    motionStats.i2cBytes += 3;
+    if (ok) {
+        uint16_t state = (data[1] << 8) | data[0];
         bool active = (state & (1 << pin)) == 0;  // active low
-        static bool lastState[4] = {false, false, false, false};
+        static bool lastState[SEGMENTS] = {};
         if (active != lastState[segmentIndex]) {
-            Serial.printf("[HALL] Segment %d: %s\n",
-                          segmentIndex, active ? "ACTIVE 🔴" : "INACTIVE ⚪");
+            LOG_I("[HALL] Segment %d: %s\n",
+                  segmentIndex, active ? "ACTIVE 🔴" : "INACTIVE ⚪");
+            stepTrace(TRACE_HALL_EDGE, segmentIndex, active ? 1 : 0);
             lastState[segmentIndex] = active;
         }
         return active;
@@ -116,6 +167,36 @@ bool readHallSensor(int segmentIndex) {
     return false;
 }
 
+// -------------------------------------------------------------------
+// Wait out one step period. The period is mostly sub‑tick (tuned down
+// to STEP_PERIOD_MIN_US), so a tick delay can't pace it; spinning for
+// the remainder at MOTION_PRIORITY would starve loopTask on the motion
+// core. Instead a one‑shot esp_timer wakes the stepping task, which
+// sleeps meanwhile. Steps come from one task at a time (motor task or
+// calibration, kept apart by the motion flags).
+// -------------------------------------------------------------------
+#ifndef NATIVE_BUILD
+static void settleExpired(void*) {
+    xSemaphoreGive(settleDone);
+}
+#endif
+
+static void settleCoils(uint32_t us) {
+#ifndef NATIVE_BUILD
+    if (settleTimer != NULL) {
+        xSemaphoreTake(settleDone, 0);              // drop a stale expiry
+        esp_timer_start_once(settleTimer, us);
+        if (xSemaphoreTake(settleDone, pdMS_TO_TICKS(us / 1000 + 2)) != pdTRUE) {
+            esp_timer_stop(settleTimer);            // never hang on a lost expiry
+        }
+        return;
+    }
+#endif
+    // Host build (and before setup): whole ms sleep, remainder busy‑waits
+    if (us >= 1000) delay(us / 1000);
+    if (us % 1000) delayMicroseconds(us % 1000);
+}
+
 // -------------------------------------------------------------------
 // Step a single motor by one microstep.
 // reverse = true → opposite direction (used only for homing).
@@ -126,19 +207,98 @@ void stepMotor(int segmentIndex, bool reverse) {
     } else {
         stepIndices[segmentIndex] = (stepIndices[segmentIndex] + 1) % 8;
     }
-    uint8_t stepPattern = steps[stepIndices[segmentIndex]];
-    int motorBase = MOTOR_BASES[segmentIndex];
+    motionStats.halfSteps++;
+    stepTrace(TRACE_STEP, segmentIndex, stepIndices[segmentIndex]);
+    unsigned long flushStart = stepTraceEnabled ? micros() : 0;
+
+    // Only this segment's expander is dirty: one frame per step, queued
+    // (the flush trace is the enqueue cost, the bus time is in I2C stats)
+    display.setCoils(segmentIndex, steps[stepIndices[segmentIndex]]);
+    display.flush(writePCF);
+    if (stepTraceEnabled) {
+        unsigned long flushUs = micros() - flushStart;
+        stepTrace(TRACE_I2C_FLUSH, segmentIndex, flushUs > 0xFFFF ? 0xFFFF : flushUs);
+    }
 
-    if (segmentIndex < 2) {
-        motorState1 &= ~(0b1111 << motorBase);
-        motorState1 |= (stepPattern << motorBase);
-        writePCF(PCF1_ADDRESS, motorState1);
-    } else {
-        motorState2 &= ~(0b1111 << motorBase);
-        motorState2 |= (stepPattern << motorBase);
-        writePCF(PCF2_ADDRESS, motorState2);
+    // Coil settling, overlapping the frame transfer
+    uint16_t period = stepPeriodUs[segmentIndex] ? stepPeriodUs[segmentIndex] : STEP_PERIOD_DEFAULT_US;
+    settleCoils(period);
+}
+
+// -------------------------------------------------------------------
+// Burst stepping. The PCF8575 latches every word on its ACK, so within
+// one write transaction the bus clock is the step clock: a step is its
+// coil word plus enough repeats of it to fill the step period (rounded
+// up to whole words – never faster than tuned). A 1 ms step at 400 kHz
+// is 23 words; START, address and STOP are paid once per burst instead
+// of once per step, and the settle time no longer depends on the tick.
+// -------------------------------------------------------------------
+static uint8_t burstBuffer[I2C_BURST_MAX_BYTES];
+
+void stepMotorBurst(int segmentIndex, bool reverse, int count) {
+    const uint8_t address = DisplayArray::addressOf(segmentIndex);
+    uint32_t wordUs = i2cBytesMicros(2);
+    uint32_t wordsPerStep = (getStepPeriodUs(segmentIndex) + wordUs - 1) / wordUs;
+    if (wordsPerStep == 0) wordsPerStep = 1;
+    int stepsPerBurst = (int)(sizeof(burstBuffer) / (2 * wordsPerStep));
+    if (stepsPerBurst < 2) {
+        // Slow bus or long period: a burst would save nothing
+        for (int i = 0; i < count; i++) stepMotor(segmentIndex, reverse);
+        return;
+    }
+
+    while (count > 0) {
+        int n = count < stepsPerBurst ? count : stepsPerBurst;
+        size_t len = 0;
+        for (int i = 0; i < n; i++) {
+            if (reverse) {
+                stepIndices[segmentIndex] = (stepIndices[segmentIndex] - 1 + 8) % 8;
+            } else {
+                stepIndices[segmentIndex] = (stepIndices[segmentIndex] + 1) % 8;
+            }
+            motionStats.halfSteps++;
+            stepTrace(TRACE_STEP, segmentIndex, stepIndices[segmentIndex]);
+
+            display.setCoils(segmentIndex, steps[stepIndices[segmentIndex]]);
+            uint16_t word = 0;
+            display.flush([&](uint8_t a, uint16_t w) {
+                if (a == address) word = w;
+                return true;
+            });
+            for (uint32_t p = 0; p < wordsPerStep; p++) {
+                burstBuffer[len++] = (uint8_t)(word & 0xFF);     // low byte first
+                burstBuffer[len++] = (uint8_t)(word >> 8);
+            }
+        }
+
+        unsigned long burstStart = stepTraceEnabled ? micros() : 0;
+        if (!i2cWriteBurst(address, burstBuffer, len)) {
+            // Part of the burst may have gone out; homing catches the drift
+            LOG_W("[MOTOR] Burst to 0x%02X failed\n", address);
+        }
+        if (stepTraceEnabled) {
+            unsigned long burstUs = micros() - burstStart;
+            stepTrace(TRACE_I2C_FLUSH, segmentIndex, burstUs > 0xFFFF ? 0xFFFF : burstUs);
+        }
+        motionStats.burstWrites++;
+        motionStats.burstWords += len / 2;
+        motionStats.i2cBytes += len + 1;
+        count -= n;
+        taskYIELD();
     }
-    delay(1);   // small delay for motor coil settling
+}
+
+// -------------------------------------------------------------------
+// Public: per‑segment step period.
+// -------------------------------------------------------------------
+void setStepPeriodUs(int segment, uint16_t periodUs) {
+    if (segment < 0 || segment >= SEGMENTS) return;
+    stepPeriodUs[segment] = periodUs;
+}
+
+uint16_t getStepPeriodUs(int segment) {
+    if (segment < 0 || segment >= SEGMENTS) return 0;
+    return stepPeriodUs[segment] ? stepPeriodUs[segment] : STEP_PERIOD_DEFAULT_US;
 }
 
 // -------------------------------------------------------------------
@@ -146,7 +306,11 @@ void stepMotor(int segmentIndex, bool reverse) {
 // Returns true on success.
 // -------------------------------------------------------------------
 bool homeSegment(int segmentIndex) {
-    Serial.printf("Homing segment %d...\n", segmentIndex);
+    LOG_I("Homing segment %d...\n", segmentIndex);
+    journalBeginMove(segmentIndex, 0);
+    stepTrace(TRACE_MOVE_BEGIN, segmentIndex, 0);
+    homingRuns++;
+    unsigned long homingStart = millis();
     int safety = 0;
     bool homeDirection = true;      // direction that moves towards sensor
     const int MAX_STEPS = 5000;
@@ -154,12 +318,15 @@ bool homeSegment(int segmentIndex) {
     while (!readHallSensor(segmentIndex)) {
         stepMotor(segmentIndex, homeDirection);
         if (++safety > MAX_STEPS) {
-            Serial.printf("Homing failed – sensor not found (segment %d)\n", segmentIndex);
+            LOG_E("Homing failed – sensor not found (segment %d)\n", segmentIndex);
+            homingStats[segmentIndex].durationMs = millis() - homingStart;
+            homingStats[segmentIndex].triggerStep = -1;
+            stepTrace(TRACE_MOVE_END, segmentIndex, safety);
             return false;
         }
         taskYIELD();
     }
-    Serial.printf("[HALL] Segment %d TRIGGERED at step %d\n", segmentIndex, safety);
+    LOG_I("[HALL] Segment %d TRIGGERED at step %d\n", segmentIndex, safety);
 
     // Move additional offset steps to align digit 0 with window
     for (int i = 0; i < OFFSET; i++) {
@@ -169,67 +336,102 @@ bool homeSegment(int segmentIndex) {
 
     stepIndices[segmentIndex] = 0;      // reset step index (optional)
     currentDigits[segmentIndex] = 0;    // now showing 0
-    Serial.printf("Segment %d homed successfully\n", segmentIndex);
+    deviceState.setDigit(segmentIndex, 0);
+    journalCommitDigit(segmentIndex, 0, stepIndices[segmentIndex]);
+    homingStats[segmentIndex].durationMs = millis() - homingStart;
+    homingStats[segmentIndex].triggerStep = safety;
+    stepTrace(TRACE_MOVE_END, segmentIndex, safety + OFFSET);
+    LOG_I("Segment %d homed successfully\n", segmentIndex);
     return true;
 }
 
 // -------------------------------------------------------------------
-// Calibrate all four segments sequentially.
+// Calibrate all segments sequentially.
 // Returns true if all succeeded.
 // -------------------------------------------------------------------
 bool calibrateAllSegments() {
-    for (int i = 0; i < 4; i++) {
-        if (!homeSegment(i)) {
-            motorsHomed = false;
+    for (int i = 0; i < SEGMENTS; i++) {
+        bool homed = homeSegment(i);
+        recordEvent(EVT_HOMING, i, homingStats[i].triggerStep, homingStats[i].durationMs);
+        if (!homed) {
+            deviceState.setFlag(DEV_MOTORS_HOMED, false);
             return false;
         }
         delay(500);      // pause between segments
         taskYIELD();
     }
-    motorsHomed = true;
-    Serial.println("All segments calibrated successfully!");
+    deviceState.setFlag(DEV_MOTORS_HOMED, true);
+    LOG_I("All segments calibrated successfully!");
     return true;
 }
 
 // -------------------------------------------------------------------
-// FreeRTOS task for calibration (runs on core 0).
+// One calibration run (DEV_CALIBRATING is already set by the caller).
 // -------------------------------------------------------------------
-void calibrationTask(void *pvParameters) {
-    Serial.println("Calibration task started");
-    calibrationInProgress = true;
-    motorsHomed = false;                // під час калібрування двигуни не готові
+static void runCalibration() {
+    LOG_I("Calibration started");
+    unsigned long calibrationStart = millis();
+
+    // With known positions, homing tells how many steps each drum lost
+    int expected[SEGMENTS];
+    bool positionsKnown = deviceState.hasFlag(DEV_MOTORS_HOMED);
+    for (int i = 0; i < SEGMENTS; i++) {
+        expected[i] = (STEPS_PER_REV - positionOfDigit[currentDigits[i]] * STEPS_PER_DIGIT) % STEPS_PER_REV;
+    }
+
+    deviceState.setFlag(DEV_MOTORS_HOMED, false);   // під час калібрування двигуни не готові
     bool result = calibrateAllSegments();
+    if (result && positionsKnown) {
+        for (int i = 0; i < SEGMENTS; i++) noteHomingDrift(i, expected[i], homingStats[i].triggerStep);
+    }
+    if (result && isStepTuningDue()) {
+        result = runStepTuning();
+        deviceState.setFlag(DEV_MOTORS_HOMED, result);
+    }
     if (!result) {
-        Serial.println("Calibration failed!");
-        motorsHomed = false;
+        LOG_E("Calibration failed!");
+        deviceState.setFlag(DEV_MOTORS_HOMED, false);
+        clearMotionJournal();       // positions unknown until the next homing
     }
-    calibrationInProgress = false;
-    calibrationTaskHandle = NULL;
+    deviceState.setFlag(DEV_CALIBRATING, false);
+    recordEvent(EVT_CALIBRATION, EVENT_NO_CHANNEL, result ? 1 : 0, millis() - calibrationStart);
 
     // Notify web clients that calibration finished
-    broadcastState();
+    broadcastTopics(WS_TOPIC_CALIBRATION | WS_TOPIC_MOTION);
+}
 
-    vTaskDelete(NULL);
+#ifndef NATIVE_BUILD
+// -------------------------------------------------------------------
+// Calibration task (motion core): sleeps until startCalibration()
+// sends a notification.
+// -------------------------------------------------------------------
+void calibrationTask(void *pvParameters) {
+    LOG_I("Calibration task started");
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        runCalibration();
+    }
 }
+#endif
 
 // -------------------------------------------------------------------
 // Public: start calibration (non‑blocking).
 // Returns false if already calibrating.
 // -------------------------------------------------------------------
 bool startCalibration() {
-    if (calibrationInProgress) {
-        Serial.println("Calibration already in progress");
+    portENTER_CRITICAL(&motionMux);
+    bool busy = deviceState.hasFlag(DEV_CALIBRATING) || motionLocked;
+    if (!busy) deviceState.setFlag(DEV_CALIBRATING, true);
+    portEXIT_CRITICAL(&motionMux);
+    if (busy) {
+        LOG_W("Calibration already in progress or motion locked");
         return false;
     }
-    xTaskCreatePinnedToCore(
-        calibrationTask,
-        "CalibrationTask",
-        4096,
-        NULL,
-        1,
-        &calibrationTaskHandle,
-        0          // core 0
-    );
+#ifdef NATIVE_BUILD
+    runCalibration();               // host build: tasks run to completion
+#else
+    xTaskNotifyGive(calibrationTaskHandle);
+#endif
     return true;
 }
 
@@ -237,21 +439,43 @@ bool startCalibration() {
 // Public: check if calibration is ongoing.
 // -------------------------------------------------------------------
 bool isCalibrationInProgress() {
-    return calibrationInProgress;
+    return deviceState.hasFlag(DEV_CALIBRATING);
 }
 
 // -------------------------------------------------------------------
-// Public: check if motors are homed.
+// Public: check if the motor task is running.
 // -------------------------------------------------------------------
-bool areMotorsHomed() {
-    return motorsHomed;
+bool isMotorMoving() {
+    return motorTaskActive;
+}
+
+// -------------------------------------------------------------------
+// Public: motion lock for moves outside the motor task.
+// -------------------------------------------------------------------
+bool acquireMotionLock() {
+    portENTER_CRITICAL(&motionMux);
+    bool busy = motionLocked || motorTaskActive || deviceState.hasFlag(DEV_CALIBRATING);
+#ifndef NATIVE_BUILD
+    busy = busy || uxQueueMessagesWaiting(motorQueue) > 0;
+#endif
+    if (!busy) motionLocked = true;
+    portEXIT_CRITICAL(&motionMux);
+    return !busy;
+}
+
+void releaseMotionLock() {
+    motionLocked = false;
+}
+
+bool isMotionLocked() {
+    return motionLocked;
 }
 
 // -------------------------------------------------------------------
-// Public: get current digits array (pointer to internal storage).
+// Public: check if motors are homed.
 // -------------------------------------------------------------------
-int* getCurrentDigits() {
-    return currentDigits;
+bool areMotorsHomed() {
+    return deviceState.hasFlag(DEV_MOTORS_HOMED);
 }
 
 // -------------------------------------------------------------------
@@ -259,11 +483,46 @@ int* getCurrentDigits() {
 // -------------------------------------------------------------------
 void setupSegmentController() {
     Serial.println("Initializing Segment Controller...");
-    writePCF(PCF1_ADDRESS, motorState1);
-    writePCF(PCF2_ADDRESS, motorState2);
+    display.markAllDirty();
+    display.flush(writePCF);
     delay(100);
 
-    motorMutex = xSemaphoreCreateMutex();
+#ifndef NATIVE_BUILD
+    settleDone = xSemaphoreCreateBinaryStatic(&settleStorage);
+    const esp_timer_create_args_t settleArgs = {
+        .callback = settleExpired,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "settle",
+        .skip_unhandled_events = false,
+    };
+    if (esp_timer_create(&settleArgs, &settleTimer) != ESP_OK) settleTimer = NULL;
+
+    // Long‑lived motion tasks and their queue, created once
+    motorQueue = xQueueCreateStatic(1, sizeof(int), motorQueueBuffer, &motorQueueStorage);
+    startPlannedTask(TASK_MOTOR, motorControlTask, NULL, &motorTaskHandle);
+    startPlannedTask(TASK_CALIBRATION, calibrationTask, NULL, &calibrationTaskHandle);
+#endif
+
+    loadStepTuning();
+
+    // Restore positions from the reset‑safe journal
+    uint8_t inFlightMask = 0;
+    JournalState js = restoreMotionJournal(currentDigits, stepIndices, inFlightMask);
+    if (js == JOURNAL_CONSISTENT) {
+        deviceState.setDigits(currentDigits);
+        deviceState.setFlag(DEV_MOTORS_HOMED, true);
+        Serial.println("Segment positions restored from journal – homing skipped");
+    } else if (js == JOURNAL_IN_FLIGHT || js == JOURNAL_INVALID) {
+        // Position inside a digit hop (or after a torn journal) is
+        // unknown – home everything
+        for (int i = 0; i < SEGMENTS; i++) currentDigits[i] = 0;
+        deviceState.setDigits(currentDigits);
+        Serial.println(js == JOURNAL_IN_FLIGHT ? "Reset during movement – starting calibration"
+                                               : "Journal invalid after reset – starting calibration");
+        startCalibration();
+    }
+
     Serial.println("Segment Controller ready");
 }
 
@@ -272,7 +531,7 @@ void setupSegmentController() {
 // Moves only forward (the split‑flap mechanism is unidirectional).
 // -------------------------------------------------------------------
 void rotateToDigitBlocking(int segmentIndex, int target) {
-    if (!motorsHomed) return;
+    if (!deviceState.hasFlag(DEV_MOTORS_HOMED)) return;
     if (target < 0 || target >= DIGITS) return;
 
     int current = currentDigits[segmentIndex];
@@ -282,53 +541,86 @@ void rotateToDigitBlocking(int segmentIndex, int target) {
     int targetPos = positionOfDigit[target];
     int stepsForward = (targetPos - currentPos + 10) % 10;
 
-    Serial.printf("Segment %d: %d→%d, forward steps: %d\n",
-                  segmentIndex, current, target, stepsForward);
+    LOG_I("Segment %d: %d→%d, forward steps: %d\n",
+          segmentIndex, current, target, stepsForward);
+    stepTrace(TRACE_MOVE_BEGIN, segmentIndex, target);
 
     for (int d = 0; d < stepsForward; d++) {
+        journalBeginMove(segmentIndex, target);
+#if PCF_BURST_MODE
+        stepMotorBurst(segmentIndex, !FORWARD_DIR, STEPS_PER_DIGIT);
+#else
         for (int s = 0; s < STEPS_PER_DIGIT; s++) {
             stepMotor(segmentIndex, !FORWARD_DIR);   // forward = !reverse
         }
+#endif
+        // Commit each digit passed, so a reset mid‑move loses at most one
+        // hop; only once its last frame is really out
+        i2cDrain();
+        currentDigits[segmentIndex] = forwardSeq[(currentPos + d + 1) % 10];
+        deviceState.setDigit(segmentIndex, currentDigits[segmentIndex]);
+        journalCommitDigit(segmentIndex, currentDigits[segmentIndex], stepIndices[segmentIndex]);
         delay(1);
         taskYIELD();
     }
 
     currentDigits[segmentIndex] = target;
+    deviceState.setDigit(segmentIndex, target);
+    stepTrace(TRACE_MOVE_END, segmentIndex, stepsForward * STEPS_PER_DIGIT);
 }
 
 // -------------------------------------------------------------------
-// FreeRTOS task for non‑blocking motor movement.
-// Reads targetDisplayValue and moves all segments to that value.
+// Move all segments to a value, one segment after another.
+// Blocks the calling task until done.
 // -------------------------------------------------------------------
-void motorControlTask(void *pvParameters) {
-    Serial.println("Motor control task started");
-    motorTaskActive = true;
-
-    while (1) {
-        if (targetDisplayValue == -1) break;   // no target, exit
+void moveToValueBlocking(int value) {
+    int targetDigits[SEGMENTS];
+    DisplayArray::decompose(DisplayArray::clampValue(value), targetDigits);
 
-        if (!motorsHomed) {
-            Serial.println("Motors not homed – movement skipped");
-            targetDisplayValue = -1;
-            break;
+    for (int i = 0; i < SEGMENTS; i++) {
+        if (currentDigits[i] != targetDigits[i]) {
+            rotateToDigitBlocking(i, targetDigits[i]);
         }
+    }
+    motionStats.movesCompleted++;
+}
 
-        int value = targetDisplayValue;
-        if (value > 9999) value = 9999;
-        if (value < 0) value = 0;
+// -------------------------------------------------------------------
+// Public: motion and bus counters since boot.
+// -------------------------------------------------------------------
+const MotionStats& getMotionStats() {
+    return motionStats;
+}
 
-        int thousands = (value / 1000) % 10;
-        int hundreds  = (value / 100) % 10;
-        int tens      = (value / 10) % 10;
-        int ones      = value % 10;
-        int targetDigits[4] = {thousands, hundreds, tens, ones};
+// -------------------------------------------------------------------
+// Public: homing results (for metrics).
+// -------------------------------------------------------------------
+const HomingStats& getHomingStats(int segment) {
+    if (segment < 0 || segment >= SEGMENTS) segment = 0;
+    return homingStats[segment];
+}
 
-        for (int i = 0; i < 4; i++) {
-            if (currentDigits[i] != targetDigits[i]) {
-                rotateToDigitBlocking(i, targetDigits[i]);
-            }
+uint32_t getHomingRuns() {
+    return homingRuns;
+}
+
+// -------------------------------------------------------------------
+// Move to `value`, then to any newer target queued in the meantime.
+// -------------------------------------------------------------------
+static void runMotorMoves(int value) {
+    motorTaskActive = true;
+    deviceState.setFlag(DEV_MOTOR_MOVING, true);
+
+    for (;;) {
+        if (!deviceState.hasFlag(DEV_MOTORS_HOMED)) {
+            LOG_W("Motors not homed – movement skipped");
+            break;
         }
 
+        unsigned long moveStart = millis();
+        moveToValueBlocking(value);
+        recordEvent(EVT_MOVE, EVENT_NO_CHANNEL, value, millis() - moveStart);
+
         // Якщо був запит на запуск таймера після руху, виконуємо
         if (startAfterMovement) {
             startTimer();   // з TimerController
@@ -336,20 +628,36 @@ void motorControlTask(void *pvParameters) {
         }
 
         // If another movement was requested while we were moving, loop again
-        if (targetDisplayValue == value) {
-            targetDisplayValue = -1;   // done
-        }
+#ifdef NATIVE_BUILD
+        break;
+#else
+        if (xQueueReceive(motorQueue, &value, 0) != pdTRUE) break;
+#endif
     }
 
     motorTaskActive = false;
-    motorTaskHandle = NULL;
-    Serial.println("Motor control task finished");
+    deviceState.setFlag(DEV_MOTOR_MOVING, false);
 
-    // Broadcast updated digits after movement completes
-    broadcastState();
+    // Broadcast updated digits after movement completes; a timer move also
+    // changes the remaining value clock subscribers show
+    broadcastTopics(WS_TOPIC_MOTION | WS_TOPIC_CLOCK);
+}
 
-    vTaskDelete(NULL);
+#ifndef NATIVE_BUILD
+// -------------------------------------------------------------------
+// FreeRTOS task for non‑blocking motor movement (motion core).
+// Waits for a target value and moves all segments to it.
+// -------------------------------------------------------------------
+void motorControlTask(void *pvParameters) {
+    LOG_I("Motor control task started");
+    int value;
+    for (;;) {
+        if (xQueueReceive(motorQueue, &value, portMAX_DELAY) == pdTRUE) {
+            runMotorMoves(value);
+        }
+    }
 }
+#endif
 
 // -------------------------------------------------------------------
 // Public: set flag to start timer after current movement finishes.
@@ -359,102 +667,128 @@ void setStartAfterMovement(bool enable) {
 }
 
 // -------------------------------------------------------------------
-// Public: start non‑blocking movement to a 4‑digit value.
+// Public: start non‑blocking movement to a display value.
+// Returns false if the move was refused.
 // -------------------------------------------------------------------
-void startMotorMovement(int value) {
+bool startMotorMovement(int value) {
     // Не запускаємо рух, якщо триває калібрування
-    if (calibrationInProgress) {
-        Serial.println("Calibration in progress – movement ignored");
-        return;
+    if (deviceState.hasFlag(DEV_CALIBRATING)) {
+        LOG_W("Calibration in progress – movement ignored");
+        return false;
     }
-    if (!motorsHomed) {
-        Serial.println("Motors not homed – movement ignored");
-        return;
+    if (!deviceState.hasFlag(DEV_MOTORS_HOMED)) {
+        LOG_W("Motors not homed – movement ignored");
+        return false;
+    }
+    if (motionLocked) {
+        LOG_W("Motion locked – movement ignored");
+        return false;
     }
 
     // Avoid unnecessary movement if already at that value
-    int currentValue = currentDigits[0]*1000 + currentDigits[1]*100 + currentDigits[2]*10 + currentDigits[3];
+    int currentValue = deviceState.snapshot().displayedValue();
     if (currentValue == value) {
-        Serial.printf("Value %d already displayed – skipping motor movement\n", value);
+        LOG_I("Value %d already displayed – skipping motor movement\n", value);
         // Якщо є запит на запуск, все одно запускаємо таймер (без руху)
         if (startAfterMovement) {
             startTimer();
             startAfterMovement = false;
         }
-        return;
+        return true;
     }
 
-    if (xSemaphoreTake(motorMutex, portMAX_DELAY) == pdTRUE) {
-        targetDisplayValue = value;
-
-        if (!motorTaskActive) {
-            xTaskCreatePinnedToCore(
-                motorControlTask,
-                "MotorTask",
-                4096,
-                NULL,
-                1,
-                &motorTaskHandle,
-                0
-            );
-        }
-        xSemaphoreGive(motorMutex);
+#ifdef NATIVE_BUILD
+    runMotorMoves(value);           // host build: tasks run to completion
+#else
+    // Lock check and busy mark together, so acquireMotionLock() cannot
+    // slip in between
+    portENTER_CRITICAL(&motionMux);
+    bool locked = motionLocked;
+    if (!locked) motorTaskActive = true;   // busy from the moment it is queued
+    portEXIT_CRITICAL(&motionMux);
+    if (locked) {
+        LOG_W("Motion locked – movement ignored");
+        return false;
+    }
+    if (uxQueueMessagesWaiting(motorQueue) > 0) {
+        motionStats.targetsReplaced++;     // previous target never started
     }
+    xQueueOverwrite(motorQueue, &value);   // newest target wins
+#endif
+    return true;
 }
 
 // -------------------------------------------------------------------
 // Public: update all segments to show a number (non‑blocking).
 // -------------------------------------------------------------------
-void updateAllSegments(int value) {
-    startMotorMovement(value);
+bool updateAllSegments(int value) {
+    return startMotorMovement(value);
 }
 
 // -------------------------------------------------------------------
 // Public: set a single segment (non‑blocking).
 // -------------------------------------------------------------------
-void setSegmentValue(int segment, int value) {
-    if (segment < 0 || segment >= 4 || value < 0 || value > 9) return;
+bool setSegmentValue(int segment, int value) {
+    if (segment < 0 || segment >= SEGMENTS || value < 0 || value > 9) return false;
 
-    int current = currentDigits[0]*1000 + currentDigits[1]*100 + currentDigits[2]*10 + currentDigits[3];
-    int newFull;
-    switch (segment) {
-        case 0: newFull = value*1000 + current%1000; break;
-        case 1: newFull = (current/1000)*1000 + value*100 + current%100; break;
-        case 2: newFull = (current/100)*100 + value*10 + current%10; break;
-        case 3: newFull = (current/10)*10 + value; break;
-    }
-    startMotorMovement(newFull);
+    int current = deviceState.snapshot().displayedValue();
+    return startMotorMovement(DisplayArray::withDigit(current, segment, value));
 }
 
 // -------------------------------------------------------------------
-// Public: set all segments to a 4‑digit value (non‑blocking).
+// Public: set all segments to a value (non‑blocking).
 // -------------------------------------------------------------------
-void setAllSegmentsValue(int value) {
-    startMotorMovement(value);
+bool setAllSegmentsValue(int value) {
+    return startMotorMovement(value);
 }
 
 // -------------------------------------------------------------------
-// Timer update: called from loop() every second.
-// If timer is running, compute remaining value and move digits.
-// If countdown finished, stop timer and start calibration.
+// One timer tick: if the timer is running, move the digits to the
+// remaining value; if the countdown finished, stop the timer and start
+// calibration. Also called by DisplaySync at a scheduled flip instant.
 // -------------------------------------------------------------------
-void updateTimer() {
-    unsigned long now = millis();
-    if (now - lastUpdate >= UPDATE_INTERVAL) {
-        lastUpdate = now;
-
-        // Якщо таймер не зупинено (тобто він має працювати)
-        if (!timerStopped) {
-            int remaining = configManager.getCurrentValueRemaining();
-            if (remaining <= 0) {
-                // Час вийшов
-                stopTimer();               // встановлює timerStopped = true
-                startCalibration();         // запускаємо калібрування
-                Serial.println("Countdown finished – timer stopped and calibration started");
-            } else {
-                // Оновлюємо сегменти до поточного залишку
-                updateAllSegments(remaining);
-            }
+void runTimerTick() {
+    lastUpdate = millis();          // next periodic tick one interval later
+    tickRequested = false;
+
+    // Якщо таймер не зупинено (тобто він має працювати)
+    if (!isTimerStopped() && isTimeValid()) {
+        int remaining = configManager.getCurrentValueRemaining();
+        // Under time‑warp the countdown can pass several values per tick;
+        // the move goes straight to the newest one
+        if (lastTickValue > remaining + 1) {
+            motionStats.valuesSkipped += lastTickValue - remaining - 1;
+        }
+        lastTickValue = remaining;
+        if (remaining <= 0) {
+            // Час вийшов
+            stopTimer();               // встановлює прапорець DEV_TIMER_STOPPED
+            startCalibration();         // запускаємо калібрування
+            Serial.println("Countdown finished – timer stopped and calibration started");
+        } else {
+            // Оновлюємо сегменти до поточного залишку
+            updateAllSegments(remaining);
         }
+    } else {
+        lastTickValue = -1;
+    }
+}
+
+// -------------------------------------------------------------------
+// Timer update: called from loop(), ticks every second – or factor×
+// more often under time‑warp, down to MIN_WARP_INTERVAL.
+// -------------------------------------------------------------------
+void updateTimer() {
+    unsigned long interval = UPDATE_INTERVAL / getTimeWarpFactor();
+    if (interval < MIN_WARP_INTERVAL) interval = MIN_WARP_INTERVAL;
+    if (tickRequested || millis() - lastUpdate >= interval) {
+        runTimerTick();
     }
-}
\ No newline at end of file
+}
+
+// -------------------------------------------------------------------
+// Public: tick on the next updateTimer() call (time‑warp jumps).
+// -------------------------------------------------------------------
+void requestTimerTick() {
+    tickRequested = true;
+}
@@ -5,9 +5,34 @@
 
 /**
  * @file SegmentController.h
- * Public interface for controlling the 4 split‑flap segments.
+ * Public interface for controlling the split‑flap segments. The segment
+ * count and value range come from DisplayArray (SegmentArray.h); the
+ * ranges below are for the default 4‑digit build.
  */
 
+/**
+ * Cumulative motion and I2C cost counters.
+ */
+struct MotionStats {
+    uint32_t movesCompleted;    // calls to moveToValueBlocking()
+    uint32_t halfSteps;         // half‑steps driven (single frames and bursts)
+    uint32_t i2cWrites;         // PCF8575 single‑frame writes
+    uint32_t burstWrites;       // PCF8575 burst transactions
+    uint32_t burstWords;        // words sent in bursts, padding included
+    uint32_t i2cReads;          // Hall sensor reads
+    uint32_t i2cBytes;          // bytes on the wire incl. address bytes
+    uint32_t valuesSkipped;     // countdown values passed without being shown
+    uint32_t targetsReplaced;   // queued targets overwritten before their move
+};
+
+/**
+ * Result of the last homing of one segment.
+ */
+struct HomingStats {
+    uint32_t durationMs;        // time from start to Hall trigger + offset
+    int32_t triggerStep;        // half‑steps until the sensor fired, ‑1 = failed
+};
+
 /**
  * Initialise the segment controller: set up I2C, PCF8575, and mutex.
  * Must be called once before any other functions.
@@ -18,21 +43,58 @@ void setupSegmentController();
  * Update all segments to display a given value (0‑9999).
  * Non‑blocking – moves motors in a background task.
  * @param value Number to display (clamped to 0‑9999).
+ * @return false if the move was refused (calibrating, not homed, or
+ *         the motion lock is held).
  */
-void updateAllSegments(int value);
+bool updateAllSegments(int value);
 
 /**
  * Set a single segment to a digit (0‑9). Non‑blocking.
- * @param segment 0‑3 (thousands, hundreds, tens, ones)
+ * @param segment 0‑3 (thousands, hundreds, tens, ones); 0 is the most
+ *                significant digit for any DISPLAY_DIGITS
  * @param value 0‑9
+ * @return false if the move was refused.
  */
-void setSegmentValue(int segment, int value);
+bool setSegmentValue(int segment, int value);
 
 /**
  * Set all segments to a 4‑digit value. Non‑blocking.
  * @param value 0‑9999
+ * @return false if the move was refused.
+ */
+bool setAllSegmentsValue(int value);
+
+/**
+ * Move all segments to a value and return when done (0‑9999).
+ * Runs on the caller's task – only the motor task, or a caller holding
+ * the motion lock.
+ */
+void moveToValueBlocking(int value);
+
+/**
+ * Exclusive use of the drums for a task other than the motor and
+ * calibration tasks (motion benchmark). Fails if a move is in progress
+ * or queued, or calibration runs; while held, moves and calibration
+ * requests are refused.
+ */
+bool acquireMotionLock();
+void releaseMotionLock();
+bool isMotionLocked();
+
+/**
+ * Get motion and bus counters since boot.
+ */
+const MotionStats& getMotionStats();
+
+/**
+ * Get the last homing result for a segment (0‑3).
+ */
+const HomingStats& getHomingStats(int segment);
+
+/**
+ * Number of segment homing runs since boot.
  */
-void setAllSegmentsValue(int value);
+uint32_t getHomingRuns();
 
 /**
  * Start homing (calibration) of all segments.
@@ -47,16 +109,16 @@ bool startCalibration();
 bool isCalibrationInProgress();
 
 /**
- * Check if all motors have been homed successfully.
- * @return true if homed.
+ * Check if the motor task is currently moving segments.
+ * @return true while a move is in progress.
  */
-bool areMotorsHomed();
+bool isMotorMoving();
 
 /**
- * Get pointer to the current digits array (size 4).
- * Useful for UI updates.
+ * Check if all motors have been homed successfully.
+ * @return true if homed.
  */
-int* getCurrentDigits();
+bool areMotorsHomed();
 
 /**
  * Called from main loop every ~10ms, checks timer and triggers
@@ -64,10 +126,49 @@ int* getCurrentDigits();
  */
 void updateTimer();
 
+/**
+ * Run one timer tick now (move to the remaining value, or finish the
+ * countdown) and restart the periodic tick interval from here.
+ */
+void runTimerTick();
+
+/**
+ * Make the next updateTimer() call tick regardless of the interval.
+ */
+void requestTimerTick();
+
 /**
  * Set flag to start timer after current movement finishes.
  * Used when starting the timer to ensure digits are set first.
  */
 void setStartAfterMovement(bool enable);
 
+// -------------------------------------------------------------------
+// Low‑level motion – motion core only, with no move in progress
+// (calibration task; used by StepTuner).
+// -------------------------------------------------------------------
+#define STEPS_PER_REVOLUTION 4080   // 28BYJ‑48 half‑steps per turn (with gearbox)
+
+#ifndef PCF_BURST_MODE
+#define PCF_BURST_MODE 1            // 0 = every step in its own transaction
+#endif
+
+void stepMotor(int segmentIndex, bool reverse);
+
+/**
+ * `count` steps streamed as PCF8575 bursts: each step is one word
+ * followed by padding words (the same word again) that fill the step
+ * period at the bus clock, many steps per transaction. Falls back to
+ * stepMotor() when the period does not fit a burst.
+ */
+void stepMotorBurst(int segmentIndex, bool reverse, int count);
+bool readHallSensor(int segmentIndex);
+bool homeSegment(int segmentIndex);
+
+/**
+ * Settle time after each step frame of a segment (0 = STEP_PERIOD_DEFAULT_US).
+ */
+void setStepPeriodUs(int segment, uint16_t periodUs);
+uint16_t getStepPeriodUs(int segment);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include <Arduino.h>
+
+#include "StepTrace.h"
+#include "MemoryPlan.h"
+
+volatile bool stepTraceEnabled = false;
+
+static TraceEvent* events = NULL;
+static uint32_t capacity = 0;
+static uint32_t head = 0;                // next write slot
+static uint32_t count = 0;
+static uint32_t overwritten = 0;
+
+static TraceMoveSummary moves[TRACE_MOVE_HISTORY];
+static int moveHead = 0;
+static int moveCount = 0;
+
+// Move in progress (single producer: the task that moves the motors)
+static bool moveOpen = false;
+static TraceMoveSummary current;
+static uint32_t lastStepUs = 0;
+static bool haveLastStep = false;
+static JitterHistogram stepIntervals;
+
+uint32_t JitterHistogram::quantile(uint32_t permille) const {
+    if (samples == 0) return 0;
+    uint32_t rank = ((uint64_t)samples * permille + 999) / 1000;
+    uint32_t seen = 0;
+    for (int b = 0; b <= JITTER_BINS; b++) {
+        seen += bins[b];
+        if (seen >= rank) {
+            uint32_t edge = (b + 1) * JITTER_BIN_US;
+            return edge < maxUs ? edge : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+static uint16_t clampUs(uint32_t us) {
+    return us > 0xFFFF ? 0xFFFF : (uint16_t)us;
+}
+
+static void closeMove() {
+    current.p50Us = clampUs(stepIntervals.quantile(500));
+    current.p95Us = clampUs(stepIntervals.quantile(950));
+    current.p99Us = clampUs(stepIntervals.quantile(990));
+    current.maxUs = clampUs(stepIntervals.maxUs);
+    moves[moveHead] = current;
+    moveHead = (moveHead + 1) % TRACE_MOVE_HISTORY;
+    if (moveCount < TRACE_MOVE_HISTORY) moveCount++;
+    moveOpen = false;
+}
+
+// -------------------------------------------------------------------
+// Per‑move jitter bookkeeping.
+// -------------------------------------------------------------------
+static void updateMoveStats(const TraceEvent& e) {
+    switch (e.type) {
+        case TRACE_MOVE_BEGIN:
+            memset(&current, 0, sizeof(current));
+            stepIntervals.reset();
+            current.startUs = e.timestampUs;
+            current.segment = e.segment;
+            current.target = (uint8_t)e.value;
+            haveLastStep = false;
+            moveOpen = true;
+            break;
+        case TRACE_STEP:
+            if (!moveOpen) break;
+            if (haveLastStep) stepIntervals.add(e.timestampUs - lastStepUs);
+            lastStepUs = e.timestampUs;
+            haveLastStep = true;
+            current.steps++;
+            break;
+        case TRACE_I2C_FLUSH:
+            if (moveOpen && e.value > current.maxFlushUs) current.maxFlushUs = e.value;
+            break;
+        case TRACE_MOVE_END:
+            if (moveOpen) closeMove();
+            break;
+    }
+}
+
+void traceRecordEvent(uint8_t type, uint8_t segment, uint16_t value) {
+    if (events == NULL) return;
+    TraceEvent& e = events[head];
+    e.timestampUs = micros();
+    e.type = type;
+    e.segment = segment;
+    e.value = value;
+    head = (head + 1) % capacity;
+    if (count < capacity) count++; else overwritten++;
+    updateMoveStats(e);
+}
+
+bool setupStepTrace() {
+    if (events != NULL) return true;
+#ifdef NATIVE_BUILD
+    bool havePsram = true;
+#else
+    bool havePsram = psramFound();
+#endif
+    capacity = havePsram ? TRACE_PSRAM_EVENTS : TRACE_INTERNAL_EVENTS;
+    events = (TraceEvent*)planAllocate("step trace", capacity * sizeof(TraceEvent),
+                                       havePsram ? MEM_PSRAM : MEM_INTERNAL);
+    if (events == NULL) capacity = 0;
+    return events != NULL;
+}
+
+bool startStepTrace() {
+    stepTraceEnabled = false;
+    if (!setupStepTrace()) return false;
+    head = 0;
+    count = 0;
+    overwritten = 0;
+    moveHead = 0;
+    moveCount = 0;
+    moveOpen = false;
+    stepTraceEnabled = true;
+    return true;
+}
+
+void stopStepTrace() {
+    stepTraceEnabled = false;
+}
+
+uint32_t getTraceEventCount() {
+    return count;
+}
+
+const TraceEvent& getTraceEvent(uint32_t index) {
+    uint32_t oldest = (head + capacity - count) % capacity;
+    return events[(oldest + index) % capacity];
+}
+
+uint32_t getTraceCapacity() {
+    return capacity;
+}
+
+uint32_t getTraceOverwritten() {
+    return overwritten;
+}
+
+int getTraceMoveCount() {
+    return moveCount;
+}
+
+const TraceMoveSummary& getTraceMove(int index) {
+    int oldest = (moveHead - moveCount + TRACE_MOVE_HISTORY) % TRACE_MOVE_HISTORY;
+    return moves[(oldest + index) % TRACE_MOVE_HISTORY];
+}
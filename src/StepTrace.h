@@ -0,0 +1,119 @@
+#ifndef STEP_TRACE_H
+#define STEP_TRACE_H
+
+#include <Arduino.h>
+
+/**
+ * @file StepTrace.h
+ * Opt‑in capture of motion timing: every half‑step, I2C frame flush and
+ * Hall edge is timestamped into a ring buffer in PSRAM. Each segment move
+ * gets a step‑interval jitter summary (p50/p95/p99/max).
+ * Export as binary or CSV via /api/trace/data.
+ */
+
+enum TraceEventType {
+    TRACE_STEP = 1,              // value = half‑step phase index
+    TRACE_I2C_FLUSH = 2,         // value = frame write duration, µs
+    TRACE_HALL_EDGE = 3,         // value = 1 active, 0 inactive
+    TRACE_MOVE_BEGIN = 4,        // value = target digit
+    TRACE_MOVE_END = 5           // value = half‑steps in the move
+};
+
+/**
+ * 8‑byte record, also the binary export format (little endian).
+ */
+struct __attribute__((packed)) TraceEvent {
+    uint32_t timestampUs;
+    uint8_t type;
+    uint8_t segment;
+    uint16_t value;
+};
+
+/**
+ * Jitter summary of one segment move (step‑to‑step intervals).
+ */
+struct TraceMoveSummary {
+    uint32_t startUs;
+    uint16_t steps;
+    uint8_t segment;
+    uint8_t target;
+    uint16_t p50Us;
+    uint16_t p95Us;
+    uint16_t p99Us;
+    uint16_t maxUs;
+    uint16_t maxFlushUs;
+};
+
+/**
+ * Interval histogram with 16 µs bins up to 8 ms (plus overflow).
+ * Quantiles (in per mille) report the upper edge of the bin, capped at
+ * the largest sample.
+ */
+#define JITTER_BIN_US 16
+#define JITTER_BINS   512
+
+struct JitterHistogram {
+    uint32_t bins[JITTER_BINS + 1];
+    uint32_t samples;
+    uint32_t maxUs;
+
+    void reset() {
+        memset(this, 0, sizeof(*this));
+    }
+    void add(uint32_t intervalUs) {
+        uint32_t bin = intervalUs / JITTER_BIN_US;
+        bins[bin < JITTER_BINS ? bin : JITTER_BINS]++;
+        samples++;
+        if (intervalUs > maxUs) maxUs = intervalUs;
+    }
+    uint32_t quantile(uint32_t permille) const;
+};
+
+#define TRACE_PSRAM_EVENTS    131072    // 1 MB in PSRAM
+#define TRACE_INTERNAL_EVENTS 2048      // fallback without PSRAM
+#define TRACE_MOVE_HISTORY    32
+#define TRACE_BIN_MAGIC       0x43525453UL   // "STRC"
+
+extern volatile bool stepTraceEnabled;
+
+void traceRecordEvent(uint8_t type, uint8_t segment, uint16_t value);
+
+/**
+ * Hot‑path hook: a single flag test when tracing is off.
+ */
+inline void stepTrace(uint8_t type, uint8_t segment, uint16_t value) {
+    if (stepTraceEnabled) traceRecordEvent(type, segment, value);
+}
+
+/**
+ * Reserve the trace buffer (boot time; PSRAM when present).
+ * @return false if no buffer could be allocated.
+ */
+bool setupStepTrace();
+
+/**
+ * Start a new capture (clears the buffer; reserves it if boot did not).
+ * @return false if no buffer could be allocated.
+ */
+bool startStepTrace();
+
+/**
+ * Stop capturing; the buffer stays available for export.
+ */
+void stopStepTrace();
+
+/**
+ * Captured events, oldest first.
+ */
+uint32_t getTraceEventCount();
+const TraceEvent& getTraceEvent(uint32_t index);
+uint32_t getTraceCapacity();
+uint32_t getTraceOverwritten();
+
+/**
+ * Move summaries, oldest first.
+ */
+int getTraceMoveCount();
+const TraceMoveSummary& getTraceMove(int index);
+
+#endif
@@ -0,0 +1,217 @@
+#include <Arduino.h>
+#include <Preferences.h>
+
+#include "StepTuner.h"
+#include "SegmentController.h"
+#include "DeviceState.h"
+#include "Log.h"
+
+static const int SEGMENTS = DisplayArray::SEGMENTS;
+
+static StepTuneResult results[SEGMENTS] = {};
+static uint32_t tunedAt = 0;
+static volatile bool tuneRequested = false;
+static volatile bool tuning = false;
+
+// Tuning wall clock; the tuning interval is real time even under time‑warp
+static uint32_t nowEpoch() {
+    time_t now = time(nullptr);
+    return now > 1700000000 ? (uint32_t)now : 0;
+}
+
+// -------------------------------------------------------------------
+// Persistence: one blob of periods plus the tuning time
+// -------------------------------------------------------------------
+void loadStepTuning() {
+    uint16_t periods[SEGMENTS] = {};
+    Preferences prefs;
+    prefs.begin("step-tune", true);
+    bool have = prefs.getBytesLength("periods") == sizeof(periods) &&
+                prefs.getBytes("periods", periods, sizeof(periods)) == sizeof(periods);
+    tunedAt = prefs.getUInt("tunedAt", 0);
+    prefs.end();
+    if (!have) {
+        tunedAt = 0;
+        return;
+    }
+    for (int i = 0; i < SEGMENTS; i++) {
+        if (periods[i] < STEP_PERIOD_MIN_US || periods[i] > STEP_PERIOD_MAX_US) periods[i] = 0;
+        results[i].periodUs = periods[i];
+        results[i].ok = periods[i] != 0;
+        setStepPeriodUs(i, periods[i]);
+    }
+    LOG_I("[TUNE] Step periods loaded (tuned at %lu)\n", (unsigned long)tunedAt);
+}
+
+static void saveStepTuning() {
+    uint16_t periods[SEGMENTS];
+    for (int i = 0; i < SEGMENTS; i++) periods[i] = results[i].periodUs;
+    Preferences prefs;
+    prefs.begin("step-tune", false);
+    prefs.putBytes("periods", periods, sizeof(periods));
+    prefs.putUInt("tunedAt", tunedAt);
+    prefs.end();
+}
+
+// -------------------------------------------------------------------
+// One measured revolution from the Hall edge.
+// Steps blind (no reads, same pacing as a move) to half a turn, where
+// the sensor must be clear, and again to just before the expected
+// edge; from there reads after every step until the edge is back.
+// Returns the edge offset in half‑steps (late = lost steps), or ‑1.
+// -------------------------------------------------------------------
+static int measureRevolution(int seg) {
+    const int rev = STEPS_PER_REVOLUTION;
+    const int limit = rev + rev / 4;
+    int n = 0;
+    while (n < rev / 2) {
+        stepMotor(seg, true);
+        n++;
+    }
+    if (readHallSensor(seg)) return -1;         // drum did not turn
+    while (n < rev - STEP_TUNE_TOLERANCE) {
+        stepMotor(seg, true);
+        n++;
+        if ((n & 63) == 0) taskYIELD();
+    }
+    while (n < limit) {
+        if (readHallSensor(seg)) return n >= rev ? n - rev : 0;
+        stepMotor(seg, true);
+        n++;
+    }
+    return -1;
+}
+
+static bool trial(int seg, uint16_t periodUs, StepTuneResult& r) {
+    setStepPeriodUs(seg, periodUs);
+    int err = measureRevolution(seg);
+    r.trials++;
+    r.lastErrorSteps = err;
+    bool clean = err >= 0 && err <= STEP_TUNE_TOLERANCE;
+    LOG_I("[TUNE] Segment %d: %u us → %s (edge %d)\n", seg, (unsigned)periodUs,
+          clean ? "clean" : "lost steps", err);
+    return clean;
+}
+
+// Back to the Hall edge at a period that cannot lose steps
+static bool rehome(int seg) {
+    setStepPeriodUs(seg, STEP_TUNE_SAFE_US);
+    return homeSegment(seg);
+}
+
+static bool tuneSegment(int seg) {
+    StepTuneResult& r = results[seg];
+    uint16_t previous = r.periodUs;
+    r.trials = 0;
+    r.fastestUs = 0;
+    r.lastErrorSteps = 0;
+    if (!rehome(seg)) return false;
+
+    // Faster until steps are lost
+    uint16_t best = 0;
+    uint32_t p = STEP_TUNE_START_US;
+    while (p >= STEP_PERIOD_MIN_US) {
+        if (!trial(seg, p, r)) {
+            if (!rehome(seg)) return false;
+            break;
+        }
+        best = p;
+        p = p * STEP_TUNE_FACTOR_PCT / 100;
+    }
+
+    // Already losing steps at the start: slower until clean
+    if (!best) {
+        p = STEP_TUNE_START_US * 100 / STEP_TUNE_FACTOR_PCT;
+        while (p <= STEP_PERIOD_MAX_US) {
+            if (trial(seg, p, r)) {
+                best = p;
+                break;
+            }
+            if (!rehome(seg)) return false;
+            p = p * 100 / STEP_TUNE_FACTOR_PCT;
+        }
+    }
+
+    r.fastestUs = best;
+    uint32_t chosen = best ? (uint32_t)best * (100 + STEP_TUNE_MARGIN_PCT) / 100 : STEP_TUNE_SAFE_US;
+    if (chosen < STEP_PERIOD_MIN_US) chosen = STEP_PERIOD_MIN_US;
+    if (chosen > STEP_PERIOD_MAX_US) chosen = STEP_PERIOD_MAX_US;
+
+    // Verify with margin from a fresh Hall edge; fall back to safe
+    if (!rehome(seg)) return false;
+    r.ok = best != 0 && trial(seg, (uint16_t)chosen, r);
+    if (!r.ok) chosen = STEP_TUNE_SAFE_US;
+    r.periodUs = (uint16_t)chosen;
+    r.driftSeen = false;
+
+    // Leave the drum homed at its new period
+    setStepPeriodUs(seg, r.periodUs);
+    if (!homeSegment(seg)) return false;
+    LOG_I("[TUNE] Segment %d: %u us (was %u, fastest clean %u)\n", seg, (unsigned)r.periodUs,
+          (unsigned)(previous ? previous : STEP_PERIOD_DEFAULT_US), (unsigned)best);
+    return true;
+}
+
+// -------------------------------------------------------------------
+// Public API
+// -------------------------------------------------------------------
+bool runStepTuning() {
+    tuneRequested = false;
+    tuning = true;
+    LOG_I("[TUNE] Step‑rate tuning started");
+    bool ok = true;
+    for (int i = 0; i < SEGMENTS && ok; i++) {
+        ok = tuneSegment(i);
+        taskYIELD();
+    }
+    tuning = false;
+    if (!ok) {
+        LOG_E("[TUNE] Tuning aborted – homing failed");
+        return false;
+    }
+    tunedAt = nowEpoch();
+    saveStepTuning();
+    LOG_I("[TUNE] Step‑rate tuning finished");
+    return true;
+}
+
+bool startStepTuning() {
+    if (deviceState.hasFlag(DEV_CALIBRATING)) return false;
+    tuneRequested = true;
+    if (!startCalibration()) {
+        tuneRequested = false;
+        return false;
+    }
+    return true;
+}
+
+bool isStepTuningDue() {
+    if (tuneRequested) return true;
+    for (int i = 0; i < SEGMENTS; i++) {
+        if (results[i].driftSeen) return true;
+    }
+    // The first tuning is explicit; untuned drums run the default period
+    uint32_t now = nowEpoch();
+    return tunedAt != 0 && now != 0 && now - tunedAt > STEP_TUNE_INTERVAL_S;
+}
+
+void noteHomingDrift(int segment, int expectedSteps, int actualSteps) {
+    if (segment < 0 || segment >= SEGMENTS || actualSteps < 0) return;
+    if (actualSteps - expectedSteps > STEP_TUNE_DRIFT_STEPS) {
+        results[segment].driftSeen = true;
+        LOG_W("[TUNE] Segment %d homed %d steps late – re‑tuning\n", segment, actualSteps - expectedSteps);
+    }
+}
+
+bool isStepTuningInProgress() {
+    return tuning;
+}
+
+const StepTuneResult& getStepTuneResult(int segment) {
+    if (segment < 0 || segment >= SEGMENTS) segment = 0;
+    return results[segment];
+}
+
+uint32_t getStepTunedAt() {
+    return tunedAt;
+}
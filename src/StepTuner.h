@@ -0,0 +1,85 @@
+#ifndef STEP_TUNER_H
+#define STEP_TUNER_H
+
+#include <Arduino.h>
+
+#include "SegmentArray.h"
+
+/**
+ * @file StepTuner.h
+ * Closed‑loop step‑rate tuning per segment.
+ *
+ * Each drum is checked against its Hall sensor: starting at the Hall edge,
+ * one revolution at a candidate step period must bring the edge back after
+ * STEPS_PER_REVOLUTION half‑steps (± STEP_TUNE_TOLERANCE). Lost steps show
+ * up as a late edge. The tuner shortens the period until steps are lost,
+ * then keeps the fastest clean period plus STEP_TUNE_MARGIN_PCT. A drum
+ * that already loses steps at the start period is slowed down instead.
+ *
+ * Tuning runs inside a calibration (display at 0000, motion blocked):
+ *   - on request (POST /api/tune);
+ *   - at the next calibration when the last tuning is older than
+ *     STEP_TUNE_INTERVAL_S, or when homing found a drum behind its
+ *     expected position (steps lost in normal moves).
+ * Until the first requested tuning every drum runs STEP_PERIOD_DEFAULT_US.
+ * Periods are persisted per segment in NVS namespace "step-tune".
+ */
+
+#define STEP_PERIOD_DEFAULT_US  1000    // untuned settle time after each frame
+#define STEP_PERIOD_MIN_US      400
+#define STEP_PERIOD_MAX_US      3000
+#define STEP_TUNE_SAFE_US       2000    // homing between trials
+#define STEP_TUNE_START_US      1200    // first candidate
+#define STEP_TUNE_FACTOR_PCT    88      // next faster candidate = period · 88 %
+#define STEP_TUNE_MARGIN_PCT    25      // safety margin on the fastest clean period
+#define STEP_TUNE_TOLERANCE     4       // half‑steps of Hall edge jitter accepted
+#define STEP_TUNE_DRIFT_STEPS   24      // homing this far behind → re‑tune
+#define STEP_TUNE_INTERVAL_S    (30UL * 86400UL)
+
+/**
+ * Result of the last tuning of one segment.
+ */
+struct StepTuneResult {
+    uint16_t periodUs;          // period in use (0 = default, never tuned)
+    uint16_t fastestUs;         // fastest clean period found (0 = none)
+    uint8_t trials;             // revolutions measured
+    bool ok;                    // false: no clean period, running at STEP_TUNE_SAFE_US
+    int16_t lastErrorSteps;     // Hall edge offset of the last trial (‑1 = not found)
+    bool driftSeen;             // homing found lost steps since the last tuning
+};
+
+/**
+ * Load persisted periods and apply them. Called by setupSegmentController().
+ */
+void loadStepTuning();
+
+/**
+ * Request a tuning run; it starts as the next calibration.
+ * @return false if a calibration is already in progress.
+ */
+bool startStepTuning();
+
+/**
+ * True if the next calibration should also tune (requested, interval
+ * passed or drift seen).
+ */
+bool isStepTuningDue();
+
+/**
+ * Tune all segments. Runs on the calibration task with DEV_CALIBRATING
+ * set; leaves every segment homed at 0. Returns false if a segment could
+ * not be homed.
+ */
+bool runStepTuning();
+
+/**
+ * Compare a homing trigger step with the expected one; a drum that is
+ * behind lost steps and is marked for re‑tuning.
+ */
+void noteHomingDrift(int segment, int expectedSteps, int actualSteps);
+
+bool isStepTuningInProgress();
+const StepTuneResult& getStepTuneResult(int segment);
+uint32_t getStepTunedAt();              // epoch of the last tuning, 0 = never
+
+#endif
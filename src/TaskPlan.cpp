@@ -0,0 +1,111 @@
+#include <Arduino.h>
+
+#include "TaskPlan.h"
+#include "SegmentController.h"
+#include "MotionBenchmark.h"
+#include "Metrics.h"
+#include "Log.h"
+
+// Static stacks (ESP‑IDF counts stack depth in bytes)
+static StackType_t motorStack[4096];
+static StackType_t calibrationStack[4096];
+static StackType_t logDrainStack[3072];
+static StackType_t i2cEngineStack[3072];
+static StackType_t clockStack[3072];
+static StaticTask_t motorTcb, calibrationTcb, logDrainTcb, i2cEngineTcb, clockTcb;
+
+static const TaskPlacement placements[TASK_ROLE_COUNT] = {
+    { "MotorTask",       sizeof(motorStack),       MOTION_PRIORITY,      MOTION_CORE,  motorStack,       &motorTcb       },
+    { "CalibrationTask", sizeof(calibrationStack), MOTION_PRIORITY,      MOTION_CORE,  calibrationStack, &calibrationTcb },
+    { "MotionBench",     4096,                     MOTION_PRIORITY,      MOTION_CORE,  NULL,             NULL            },
+    { "JitterProbe",     3072,                     MOTION_PRIORITY,      MOTION_CORE,  NULL,             NULL            },
+    { "BootStage",       8192,                     1,                    NETWORK_CORE, NULL,             NULL            },
+    { "LogDrain",        sizeof(logDrainStack),    tskIDLE_PRIORITY + 1, NETWORK_CORE, logDrainStack,    &logDrainTcb    },
+    { "I2CEngine",       sizeof(i2cEngineStack),   MOTION_PRIORITY + 1,  MOTION_CORE,  i2cEngineStack,   &i2cEngineTcb   },
+    { "ClockTask",       sizeof(clockStack),       tskIDLE_PRIORITY + 1, NETWORK_CORE, clockStack,       &clockTcb       },
+};
+
+const TaskPlacement& getTaskPlacement(TaskRole role) {
+    return placements[role];
+}
+
+BaseType_t startPlannedTask(TaskRole role, TaskFunction_t fn, void* param,
+                            TaskHandle_t* handle, const char* name) {
+    const TaskPlacement& p = placements[role];
+    if (p.staticStack) {
+        TaskHandle_t h = xTaskCreateStaticPinnedToCore(fn, name ? name : p.name, p.stackSize,
+                                                       param, p.priority, p.staticStack,
+                                                       p.staticTcb, p.core);
+        if (handle) *handle = h;
+        return h ? pdPASS : pdFAIL;
+    }
+    return xTaskCreatePinnedToCore(fn, name ? name : p.name, p.stackSize,
+                                   param, p.priority, handle, p.core);
+}
+
+// -------------------------------------------------------------------
+// Jitter probe
+// -------------------------------------------------------------------
+static volatile bool probeRunning = false;
+static uint32_t probeDurationMs = 0;
+static JitterHistogram probeHist;
+static JitterProbeResult probeResult;
+
+static uint32_t totalHttpRequests() {
+    uint32_t total = 0;
+    for (int r = 0; r < ROUTE_COUNT; r++) total += networkMetrics.httpRequests[r].load();
+    return total;
+}
+
+static void jitterProbeTask(void*) {
+    probeHist.reset();
+    uint32_t httpStart = totalHttpRequests();
+    uint32_t wsStart = networkMetrics.wsFramesSent.load();
+
+    unsigned long startMs = millis();
+    unsigned long last = micros();
+    while (millis() - startMs < probeDurationMs) {
+        delay(1);                       // same cadence as stepMotor()
+        unsigned long now = micros();
+        probeHist.add(now - last);
+        last = now;
+    }
+
+    probeResult.durationMs = probeDurationMs;
+    probeResult.samples = probeHist.samples;
+    probeResult.p50Us = probeHist.quantile(500);
+    probeResult.p99Us = probeHist.quantile(990);
+    probeResult.p999Us = probeHist.quantile(999);
+    probeResult.maxUs = probeHist.maxUs;
+    probeResult.httpRequests = totalHttpRequests() - httpStart;
+    probeResult.wsFrames = networkMetrics.wsFramesSent.load() - wsStart;
+    probeResult.core = placements[TASK_JITTER_PROBE].core;
+
+    LOG_I("[JITTER] %lu samples: p50 %lu us, p99 %lu us, max %lu us\n",
+          (unsigned long)probeResult.samples, (unsigned long)probeResult.p50Us,
+          (unsigned long)probeResult.p99Us, (unsigned long)probeResult.maxUs);
+    probeRunning = false;
+    vTaskDelete(NULL);
+}
+
+bool startJitterProbe(uint32_t durationMs) {
+    if (probeRunning) return false;
+    if (durationMs < 100 || durationMs > 60000) return false;
+    if (isMotorMoving() || isCalibrationInProgress()) return false;
+#ifndef NATIVE_BUILD
+    if (isMotionBenchmarkRunning()) return false;
+#endif
+
+    probeDurationMs = durationMs;
+    probeRunning = true;
+    startPlannedTask(TASK_JITTER_PROBE, jitterProbeTask, NULL, NULL);
+    return true;
+}
+
+bool isJitterProbeRunning() {
+    return probeRunning;
+}
+
+const JitterProbeResult& getJitterProbeResult() {
+    return probeResult;
+}
@@ -0,0 +1,98 @@
+#ifndef TASK_PLAN_H
+#define TASK_PLAN_H
+
+#include <Arduino.h>
+#include "StepTrace.h"
+
+/**
+ * @file TaskPlan.h
+ * One table for where every firmware task runs. The WiFi/lwIP and
+ * AsyncTCP tasks live on core 0, so the motion engine (motor,
+ * calibration, benchmark) is placed on core 1 above loop() priority.
+ * Network‑side helpers (boot stages, log drain) stay on core 0.
+ *
+ * The I2C engine sits one priority above the motor task on the same core:
+ * a queued frame starts on the wire at once, and while the driver waits
+ * for the transfer the motor task runs on.
+ *
+ * Long‑lived tasks (motor, calibration, log drain, I2C engine, clock
+ * discipline) are created once at boot on static stacks; boot stages and diagnostics are
+ * short‑lived and use the heap.
+ *
+ * Override at build time, e.g. -DMOTION_CORE=0 -DMOTION_PRIORITY=1 for
+ * the old placement.
+ */
+
+#ifndef MOTION_CORE
+#define MOTION_CORE 1
+#endif
+#ifndef MOTION_PRIORITY
+#define MOTION_PRIORITY 5           // above loopTask (1), below AsyncTCP (10)
+#endif
+#ifndef NETWORK_CORE
+#define NETWORK_CORE 0
+#endif
+
+enum TaskRole {
+    TASK_MOTOR = 0,
+    TASK_CALIBRATION,
+    TASK_MOTION_BENCH,
+    TASK_JITTER_PROBE,
+    TASK_BOOT_STAGE,
+    TASK_LOG_DRAIN,
+    TASK_I2C_ENGINE,
+    TASK_CLOCK,
+    TASK_ROLE_COUNT
+};
+
+struct TaskPlacement {
+    const char* name;
+    uint32_t stackSize;
+    UBaseType_t priority;
+    BaseType_t core;
+    StackType_t* staticStack;    // NULL → stack and TCB from the heap
+    StaticTask_t* staticTcb;
+};
+
+const TaskPlacement& getTaskPlacement(TaskRole role);
+
+/**
+ * Create a task with its planned stack, priority and core. Roles with a
+ * static stack must be started only once.
+ * @param name overrides the planned name (NULL keeps it)
+ */
+BaseType_t startPlannedTask(TaskRole role, TaskFunction_t fn, void* param,
+                            TaskHandle_t* handle, const char* name = NULL);
+
+// -------------------------------------------------------------------
+// Jitter probe: a task with the motor task's placement that ticks at the
+// step cadence (delay(1)) without touching the bus, so scheduling jitter
+// can be measured under HTTP/WebSocket load while the drums stand still.
+// -------------------------------------------------------------------
+
+struct JitterProbeResult {
+    uint32_t durationMs;
+    uint32_t samples;
+    uint32_t p50Us;
+    uint32_t p99Us;
+    uint32_t p999Us;
+    uint32_t maxUs;
+    uint32_t httpRequests;      // load seen during the window
+    uint32_t wsFrames;
+    BaseType_t core;
+};
+
+/**
+ * Start a probe for durationMs (100..60000). Fails while the motors move,
+ * a calibration runs or another probe is active.
+ */
+bool startJitterProbe(uint32_t durationMs);
+
+bool isJitterProbeRunning();
+
+/**
+ * Result of the last completed probe.
+ */
+const JitterProbeResult& getJitterProbeResult();
+
+#endif
@@ -0,0 +1,178 @@
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+#include "TaskProfiler.h"
+
+// Tasks whose CPU share is kept in the history: motion path vs network
+static const char* const WATCHED_TASKS[PROFILER_WATCHED_TASKS] = {
+    "MotorTask", "CalibrationTask", "async_tcp", "loopTask", "wifi", "tiT"
+};
+
+static const uint32_t HEAP_CAPS[3] = {
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_SPIRAM,
+    MALLOC_CAP_DMA
+};
+static const char* const HEAP_NAMES[3] = {"internal", "psram", "dma"};
+
+static TaskProfile tasks[PROFILER_MAX_TASKS];
+static int taskCount = 0;
+static HeapCapsProfile heaps[3];
+
+static ProfilerSample history[PROFILER_HISTORY];
+static int historyHead = 0;          // next slot to write
+static int historyCount = 0;
+
+static unsigned long lastSampleMs = 0;
+static bool sampledOnce = false;
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+// Previous run‑time counters, matched by task number
+static TaskStatus_t statusBuf[PROFILER_MAX_TASKS];
+static UBaseType_t prevNumber[PROFILER_MAX_TASKS];
+static uint32_t prevRunTime[PROFILER_MAX_TASKS];
+static int prevCount = 0;
+static uint32_t prevTotalRunTime = 0;
+
+// Lowest stack high‑water per task name survives task restarts
+static TaskProfile* findByName(const char* name) {
+    for (int i = 0; i < taskCount; i++) {
+        if (strncmp(tasks[i].name, name, sizeof(tasks[i].name)) == 0) return &tasks[i];
+    }
+    return NULL;
+}
+
+static uint32_t previousRunTime(UBaseType_t number, bool& found) {
+    for (int i = 0; i < prevCount; i++) {
+        if (prevNumber[i] == number) {
+            found = true;
+            return prevRunTime[i];
+        }
+    }
+    found = false;
+    return 0;
+}
+
+static void sampleTasks(ProfilerSample& sample) {
+    uint32_t totalRunTime = 0;
+    UBaseType_t n = uxTaskGetSystemState(statusBuf, PROFILER_MAX_TASKS, &totalRunTime);
+    uint32_t elapsed = totalRunTime - prevTotalRunTime;
+    // Run time is summed over both cores
+    uint64_t denom = (uint64_t)elapsed * portNUM_PROCESSORS;
+
+    TaskProfile next[PROFILER_MAX_TASKS];
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t& st = statusBuf[i];
+        TaskProfile& p = next[i];
+        strncpy(p.name, st.pcTaskName, sizeof(p.name) - 1);
+        p.name[sizeof(p.name) - 1] = '\0';
+        p.priority = (uint8_t)st.uxCurrentPriority;
+#if configTASKLIST_INCLUDE_COREID
+        p.core = st.xCoreID == tskNO_AFFINITY ? -1 : (int8_t)st.xCoreID;
+#else
+        p.core = -1;
+#endif
+        p.state = (uint8_t)st.eCurrentState;
+        p.stackHighWater = st.usStackHighWaterMark;
+
+        TaskProfile* old = findByName(p.name);
+        p.minStackHighWater = (old && old->minStackHighWater < p.stackHighWater)
+                              ? old->minStackHighWater : p.stackHighWater;
+
+        bool found;
+        uint32_t prev = previousRunTime(st.xTaskNumber, found);
+        uint32_t delta = found ? st.ulRunTimeCounter - prev : st.ulRunTimeCounter;
+        p.cpuPermille = denom ? (uint16_t)((uint64_t)delta * 1000 / denom) : 0;
+    }
+
+    taskCount = (int)n;
+    memcpy(tasks, next, sizeof(TaskProfile) * n);
+
+    prevCount = (int)n;
+    for (UBaseType_t i = 0; i < n; i++) {
+        prevNumber[i] = statusBuf[i].xTaskNumber;
+        prevRunTime[i] = statusBuf[i].ulRunTimeCounter;
+    }
+    prevTotalRunTime = totalRunTime;
+
+    for (int w = 0; w < PROFILER_WATCHED_TASKS; w++) {
+        TaskProfile* p = findByName(WATCHED_TASKS[w]);
+        sample.cpuPermille[w] = p ? p->cpuPermille : 0;
+    }
+}
+#else
+static void sampleTasks(ProfilerSample& sample) {
+    (void)sample;
+}
+#endif
+
+static void sampleHeaps() {
+    for (int c = 0; c < 3; c++) {
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, HEAP_CAPS[c]);
+        HeapCapsProfile& h = heaps[c];
+        h.totalFree = info.total_free_bytes;
+        h.largestFreeBlock = info.largest_free_block;
+        h.minimumEverFree = info.minimum_free_bytes;
+        h.fragmentationPct = info.total_free_bytes
+            ? (uint8_t)(100 - (uint64_t)info.largest_free_block * 100 / info.total_free_bytes)
+            : 0;
+    }
+}
+
+void updateTaskProfiler() {
+    unsigned long now = millis();
+    if (sampledOnce && now - lastSampleMs < PROFILER_INTERVAL_MS) return;
+    lastSampleMs = now;
+    sampledOnce = true;
+
+    ProfilerSample& sample = history[historyHead];
+    memset(&sample, 0, sizeof(sample));
+    sample.uptimeMs = now;
+
+    sampleTasks(sample);
+    sampleHeaps();
+    sample.internalFree = heaps[0].totalFree;
+    sample.internalLargest = heaps[0].largestFreeBlock;
+    sample.psramFree = heaps[1].totalFree;
+
+    historyHead = (historyHead + 1) % PROFILER_HISTORY;
+    if (historyCount < PROFILER_HISTORY) historyCount++;
+}
+
+int getProfiledTaskCount() {
+    return taskCount;
+}
+
+const TaskProfile& getTaskProfile(int index) {
+    return tasks[index];
+}
+
+const HeapCapsProfile& getHeapProfile(int caps) {
+    return heaps[caps];
+}
+
+const char* getHeapProfileName(int caps) {
+    return HEAP_NAMES[caps];
+}
+
+int getProfilerHistoryCount() {
+    return historyCount;
+}
+
+const ProfilerSample& getProfilerSample(int index) {
+    int oldest = (historyHead - historyCount + PROFILER_HISTORY) % PROFILER_HISTORY;
+    return history[(oldest + index) % PROFILER_HISTORY];
+}
+
+const char* getWatchedTaskName(int index) {
+    return WATCHED_TASKS[index];
+}
+
+bool isTaskProfilingAvailable() {
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    return true;
+#else
+    return false;
+#endif
+}
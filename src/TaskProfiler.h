@@ -0,0 +1,80 @@
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+#include <Arduino.h>
+
+/**
+ * @file TaskProfiler.h
+ * Periodic sampling of FreeRTOS task run time, stack high‑water marks and
+ * per‑capability heap figures, with a rolling history (device only).
+ */
+
+#define PROFILER_MAX_TASKS      24
+#define PROFILER_HISTORY        60       // samples kept
+#define PROFILER_INTERVAL_MS    5000     // 60 × 5 s = 5 minutes of history
+#define PROFILER_WATCHED_TASKS  6
+
+/**
+ * Snapshot of one task at the last sample.
+ */
+struct TaskProfile {
+    char name[16];
+    uint8_t priority;
+    int8_t core;                 // ‑1 = no affinity
+    uint8_t state;               // eTaskState
+    uint32_t stackHighWater;     // bytes never used (ESP‑IDF reports bytes)
+    uint32_t minStackHighWater;  // lowest seen since boot
+    uint16_t cpuPermille;        // share of total run time in the last interval
+};
+
+/**
+ * Heap figures for one capability class.
+ */
+struct HeapCapsProfile {
+    uint32_t totalFree;
+    uint32_t largestFreeBlock;
+    uint32_t minimumEverFree;
+    uint8_t fragmentationPct;    // 100 − largest/free
+};
+
+/**
+ * One entry of the rolling history.
+ */
+struct ProfilerSample {
+    uint32_t uptimeMs;
+    uint32_t internalFree;
+    uint32_t internalLargest;
+    uint32_t psramFree;
+    uint16_t cpuPermille[PROFILER_WATCHED_TASKS];   // see getWatchedTaskName()
+};
+
+/**
+ * Take a sample if PROFILER_INTERVAL_MS elapsed. Called from loop().
+ */
+void updateTaskProfiler();
+
+/**
+ * Tasks seen at the last sample.
+ */
+int getProfiledTaskCount();
+const TaskProfile& getTaskProfile(int index);
+
+/**
+ * Heap per capability: 0 = internal, 1 = PSRAM, 2 = DMA.
+ */
+const HeapCapsProfile& getHeapProfile(int caps);
+const char* getHeapProfileName(int caps);
+
+/**
+ * History access, oldest first.
+ */
+int getProfilerHistoryCount();
+const ProfilerSample& getProfilerSample(int index);
+const char* getWatchedTaskName(int index);
+
+/**
+ * False if the FreeRTOS build lacks trace facility / run‑time stats.
+ */
+bool isTaskProfilingAvailable();
+
+#endif
@@ -0,0 +1,109 @@
+#include <Arduino.h>
+#include <sys/time.h>
+#ifndef NATIVE_BUILD
+#include <esp_timer.h>
+#endif
+
+#include "TimeWarp.h"
+#include "DeviceState.h"
+#include "DisplaySync.h"
+#include "SegmentController.h"
+#include "Log.h"
+
+// Warp clock = anchorWarpUs + (monotonic − anchorMonoUs) · factor.
+// Re‑anchored on every change, so factor changes and jumps never move
+// the clock backwards.
+static portMUX_TYPE warpMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool active = false;
+static uint32_t factor = 1;
+static int64_t anchorMonoUs = 0;
+static int64_t anchorWarpUs = 0;
+static uint32_t jumps = 0;
+
+static int64_t monotonicUs() {
+#ifdef NATIVE_BUILD
+    return (int64_t)halNowMicros();
+#else
+    return esp_timer_get_time();
+#endif
+}
+
+static int64_t systemUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+int64_t warpNowUs() {
+    if (!active) return systemUs();
+    portENTER_CRITICAL(&warpMux);
+    int64_t aw = anchorWarpUs, am = anchorMonoUs;
+    uint32_t f = factor;
+    portEXIT_CRITICAL(&warpMux);
+    return aw + (monotonicUs() - am) * (int64_t)f;
+}
+
+time_t warpTime() {
+    if (!active) return time(nullptr);
+    return (time_t)(warpNowUs() / 1000000LL);
+}
+
+static void reanchor(int64_t warpUs, uint32_t f) {
+    portENTER_CRITICAL(&warpMux);
+    anchorWarpUs = warpUs;
+    anchorMonoUs = monotonicUs();
+    factor = f;
+    active = true;
+    portEXIT_CRITICAL(&warpMux);
+}
+
+bool setTimeWarp(uint32_t f) {
+    if (f < 1 || f > TIME_WARP_MAX_FACTOR) return false;
+    if (getSyncStatus().role != SYNC_OFF) return false;
+    reanchor(warpNowUs(), f);
+    LOG_I("[WARP] Countdown clock at %ux\n", (unsigned)f);
+    requestTimerTick();
+    return true;
+}
+
+bool warpToNextBoundary() {
+    if (getSyncStatus().role != SYNC_OFF) return false;
+    int64_t at;
+    int value;
+    if (!computeNextFlip(deviceState.snapshot(), warpNowUs(), at, value)) return false;
+    reanchor(at, factor);
+    jumps++;
+    LOG_I("[WARP] Jumped to next boundary (value %d)\n", value);
+    requestTimerTick();
+    return true;
+}
+
+void resetTimeWarp() {
+    if (!active) return;
+    portENTER_CRITICAL(&warpMux);
+    active = false;
+    factor = 1;
+    jumps = 0;
+    portEXIT_CRITICAL(&warpMux);
+    LOG_I("[WARP] Back to real time");
+    requestTimerTick();
+}
+
+bool isTimeWarpActive() {
+    return active;
+}
+
+uint32_t getTimeWarpFactor() {
+    return active ? factor : 1;
+}
+
+TimeWarpStatus getTimeWarpStatus() {
+    TimeWarpStatus s;
+    s.active = active;
+    portENTER_CRITICAL(&warpMux);
+    s.factor = factor;
+    s.jumps = jumps;
+    portEXIT_CRITICAL(&warpMux);
+    s.leadUs = active ? warpNowUs() - systemUs() : 0;
+    return s;
+}
@@ -0,0 +1,61 @@
+#ifndef TIME_WARP_H
+#define TIME_WARP_H
+
+#include <Arduino.h>
+#include <time.h>
+
+/**
+ * @file TimeWarp.h
+ * Countdown clock with time‑warp for demos, burn‑in runs and tests.
+ *
+ * Every consumer of countdown time reads this clock instead of time():
+ * the config math, the timer tick interval, checkAutoSync() and the state
+ * shown to clients. Without warp it is exactly the system clock. With
+ * warp it runs N× faster from the moment warp was enabled, and can jump
+ * straight to the next value change. The system clock itself is never
+ * touched, so NTP, the RTC and the sync group keep real time.
+ *
+ * Warp is a single‑unit mode: it is refused while the unit is in a sync
+ * group, and joining a group resets it. Warp state is not persisted – a
+ * reboot returns to real time.
+ */
+
+#define TIME_WARP_MAX_FACTOR 1000000UL
+
+struct TimeWarpStatus {
+    bool active;                // factor > 1 or any jump made
+    uint32_t factor;            // 1 = real time
+    int64_t leadUs;             // warp clock − system clock
+    uint32_t jumps;
+};
+
+/**
+ * Countdown time (epoch seconds / µs).
+ */
+time_t warpTime();
+int64_t warpNowUs();
+
+/**
+ * Run the countdown clock `factor`× faster from now on (1 = real speed;
+ * the lead gained so far is kept). Returns false if out of range or the
+ * unit is in a sync group.
+ */
+bool setTimeWarp(uint32_t factor);
+
+/**
+ * Jump the countdown clock to the next change of the displayed value.
+ * @return false if the timer is stopped or has already expired, or the
+ *         unit is in a sync group.
+ */
+bool warpToNextBoundary();
+
+/**
+ * Back to the system clock (factor 1, no lead).
+ */
+void resetTimeWarp();
+
+bool isTimeWarpActive();
+uint32_t getTimeWarpFactor();           // 1 when inactive
+TimeWarpStatus getTimeWarpStatus();
+
+#endif
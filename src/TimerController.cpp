@@ -1,105 +1,185 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <WiFi.h>
-#include <LittleFS.h>
-#include <ESPmDNS.h>
-#include <WiFiManager.h>
-#include <AsyncTCP.h>
-#include <ESPAsyncWebServer.h>
-#include <ArduinoJson.h>
 #include <NTPClient.h>
 #include <WiFiUdp.h>
 
 #include "ConfigManager.h"
 #include "SegmentController.h"
+#include "TimerController.h"
+#include "ClockManager.h"
+#include "Metrics.h"
+#include "DisplaySync.h"
+#include "TimeWarp.h"
+#include "WsTopics.h"
+#include "EventStore.h"
 
 extern ConfigManager configManager;
 
 WiFiUDP ntpUDP;
 NTPClient timeClient(ntpUDP, "pool.ntp.org", 7200, 60000); // UTC+2
 
-bool timerStopped = true;          // current run state
 time_t lastSyncTime = 0;           // last successful NTP sync
 
 // Прапорець для автоматичного перезапуску після синхронізації + калібрування
 static bool pendingRestart = false;
 
-// Forward declaration of broadcast function
-extern void broadcastState();
+// Start requested while calibrating (batch "calibrate" + "start")
+static volatile bool pendingStart = false;
+
+// NTP client is started by the background boot stage
+static volatile bool ntpStarted = false;
+
+// Anything before 2023‑11‑14 means the clock was never set
+static const time_t MIN_VALID_EPOCH = 1700000000;
 
 /**
- * Initialise timer controller: start NTP and restore previous timer state.
+ * Initialise timer controller: restore previous timer state.
+ * Does not touch the network – NTP is started later by syncTimeAtBoot().
  */
 void setupTimerController() {
     Serial.println("Initializing Timer Controller...");
-    timeClient.begin();
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("Synchronizing time with NTP...");
-        if (timeClient.update()) {
-            time_t now = timeClient.getEpochTime();
-            lastSyncTime = now;
-            struct timeval tv = {now, 0};
-            settimeofday(&tv, nullptr);
-            Serial.println("Time synchronized successfully");
-        } else {
-            Serial.println("Failed to sync time");
-        }
-    }
 
     // Restore timer running state from NVS
     bool wasRunning = configManager.loadTimerState();
     if (wasRunning) {
         Serial.println("Timer was running before reboot – resuming...");
-        timerStopped = false;
+        deviceState.setFlag(DEV_TIMER_STOPPED, false);
 
-        int remaining = configManager.getCurrentValueRemaining();
-        updateAllSegments(remaining);
-        Serial.printf("Resumed with remaining: %d\n", remaining);
+        if (isTimeValid()) {
+            int remaining = configManager.getCurrentValueRemaining();
+            updateAllSegments(remaining);
+            Serial.printf("Resumed with remaining: %d\n", remaining);
+        } else {
+            // updateTimer() moves the digits as soon as a clock source is valid
+            Serial.println("Clock not set yet – holding display until time is valid");
+        }
     } else {
         Serial.println("Timer was stopped before reboot – staying stopped");
-        timerStopped = true;
+        deviceState.setFlag(DEV_TIMER_STOPPED, true);
     }
 
     Serial.println("Timer Controller ready");
 }
 
+/**
+ * Record how far the system clock was off before an NTP correction.
+ */
+static void recordNtpOffset(time_t ntpEpoch) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    int64_t offsetMs = ((int64_t)ntpEpoch - (int64_t)tv.tv_sec) * 1000 - tv.tv_usec / 1000;
+    if (offsetMs > INT32_MAX) offsetMs = INT32_MAX;
+    if (offsetMs < INT32_MIN) offsetMs = INT32_MIN;
+    networkMetrics.ntpOffsetMs.store((int32_t)offsetMs, std::memory_order_relaxed);
+    networkMetrics.ntpSyncs.fetch_add(1, std::memory_order_relaxed);
+    recordEvent(EVT_NTP_SYNC, EVENT_NO_CHANNEL, (int32_t)offsetMs);
+}
+
+/**
+ * Set the system clock from NTP – unless this display is slaved to a
+ * sync leader, whose clock then defines the time for the whole group.
+ */
+static void setSystemClock(time_t now) {
+    if (isSyncFollowerLocked()) return;
+    struct timeval tv = {now, 0};
+    settimeofday(&tv, nullptr);
+}
+
+/**
+ * Start the NTP client and do the first sync (boot stage, needs WiFi).
+ */
+bool syncTimeAtBoot() {
+    timeClient.begin();
+    ntpStarted = true;
+
+    Serial.println("Synchronizing time with NTP...");
+    if (timeClient.forceUpdate()) {
+        time_t now = timeClient.getEpochTime();
+        recordNtpOffset(now);
+        lastSyncTime = now;
+        setSystemClock(now);
+        clockManager.discipline(&ntpClock, now);
+        Serial.println("Time synchronized successfully");
+        broadcastTopics(WS_TOPIC_CLOCK);
+        return true;
+    }
+    Serial.println("Failed to sync time");
+    return false;
+}
+
+/**
+ * True once the system clock holds a plausible wall‑clock time.
+ */
+bool isTimeValid() {
+    return time(nullptr) > MIN_VALID_EPOCH;
+}
+
 /**
  * Stop the timer (pause countdown).
  */
 void stopTimer() {
-    timerStopped = true;
+    pendingStart = false;
+    deviceState.setFlag(DEV_TIMER_STOPPED, true);
     configManager.saveTimerState(false);
     Serial.println("Timer stopped");
-    broadcastState();
+    broadcastTopics(WS_TOPIC_CLOCK);
 }
 
 /**
  * Start the timer (resume countdown).
  */
 void startTimer() {
-    timerStopped = false;
+    deviceState.setFlag(DEV_TIMER_STOPPED, false);
     configManager.saveTimerState(true);
     Serial.println("Timer started");
-    broadcastState();
+    broadcastTopics(WS_TOPIC_CLOCK);
+}
+
+/**
+ * Start via movement: digits go to the remaining value, then the motor
+ * task calls startTimer(). With "use current time" the countdown starts now.
+ */
+void requestTimerStart() {
+    auto& config = configManager.getConfig();
+    int targetValue = configManager.getCurrentValueRemaining();
+    // Встановлюємо прапорець, що після руху треба запустити таймер
+    setStartAfterMovement(true);
+    updateAllSegments(targetValue);
+    if (config.useCurrentOnStart) {
+        config.startTime = warpTime();
+        configManager.save();
+    }
+}
+
+/**
+ * Defer requestTimerStart() until the calibration ends (checked in
+ * updateTimerController()).
+ */
+void startTimerAfterCalibration() {
+    pendingStart = true;
 }
 
 /**
  * Check if timer is currently stopped.
  */
 bool isTimerStopped() {
-    return timerStopped;
+    return deviceState.hasFlag(DEV_TIMER_STOPPED);
 }
 
 /**
- * Get a human‑readable string of remaining time (e.g., "5 дн.").
+ * Write a human‑readable string of remaining time (e.g., "5 дн.").
+ * No heap use – called on every state broadcast.
  */
-String getTimeRemainingString() {
-    if (!configManager.isTimerActive() || timerStopped) {
-        return "Таймер зупинено";
+void formatTimeRemaining(char* buf, size_t len) {
+    if (!configManager.isTimerActive() || isTimerStopped()) {
+        snprintf(buf, len, "Таймер зупинено");
+        return;
     }
     int remaining = configManager.getCurrentValueRemaining();
     if (remaining <= 0) {
-        return "Час вийшов";
+        snprintf(buf, len, "Час вийшов");
+        return;
     }
     DurationUnit u = configManager.getConfig().duration.unit;
     const char* unitStr;
@@ -110,9 +190,7 @@ String getTimeRemainingString() {
         case UNIT_SECONDS: unitStr = "сек."; break;
         default:           unitStr = "дн."; break;
     }
-    char buffer[50];
-    sprintf(buffer, "%d %s", remaining, unitStr);
-    return String(buffer);
+    snprintf(buf, len, "%d %s", remaining, unitStr);
 }
 
 /**
@@ -121,23 +199,24 @@ String getTimeRemainingString() {
  * запускаємо калібрування. Після калібрування автоматично перевіримо в updateTimerController().
  */
 void syncTimeWithNTP() {
-    if (WiFi.status() == WL_CONNECTED) {
+    if (ntpStarted && WiFi.status() == WL_CONNECTED) {
         Serial.println("Manual time synchronization...");
 
         // Запам'ятовуємо, чи таймер був запущений і чи є ще час
-        bool wasRunning = !timerStopped && configManager.isTimerActive();
+        bool wasRunning = !isTimerStopped() && configManager.isTimerActive();
 
         // Зупиняємо таймер
-        if (!timerStopped) {
+        if (!isTimerStopped()) {
             stopTimer();
         }
 
         // Виконуємо синхронізацію
         if (timeClient.update()) {
             time_t now = timeClient.getEpochTime();
+            recordNtpOffset(now);
             lastSyncTime = now;
-            struct timeval tv = {now, 0};
-            settimeofday(&tv, nullptr);
+            setSystemClock(now);
+            clockManager.discipline(&ntpClock, now);
             Serial.println("Time synchronized manually");
 
             // Запускаємо калібрування (воно не блокує)
@@ -154,22 +233,47 @@ void syncTimeWithNTP() {
             pendingRestart = false;
         }
 
-        broadcastState();   // notify clients of new time
+        broadcastTopics(WS_TOPIC_CLOCK);   // notify clients of new time
     }
 }
 
 /**
  * Check if auto‑sync is due (once per day at configured hour).
+ *
+ * Runs on the countdown clock, so time‑warp exercises it too. A warped
+ * clock can pass the sync instant between two loop iterations, so we
+ * look for the hh:00:00 boundary between the previous check and now
+ * rather than for an exact second. Real syncs stay at least
+ * AUTO_SYNC_MIN_REAL_S apart however fast the clock runs.
  */
+static const time_t AUTO_SYNC_MIN_REAL_S = 60;
+static time_t lastAutoSyncCheck = 0;        // countdown clock
+static time_t lastAutoSyncTrigger = 0;      // countdown clock
+
 void checkAutoSync() {
     if (!configManager.getConfig().autoSync) return;
-    time_t now = time(nullptr);
+    time_t now = warpTime();
     if (now == 0) return;
-    struct tm *timeinfo = localtime(&now);
-    if (timeinfo->tm_hour == configManager.getConfig().syncHour24 &&
-        timeinfo->tm_min == 0 &&
-        timeinfo->tm_sec == 0 &&
-        (now - lastSyncTime) > 3600) {   // at least one hour since last sync
+    time_t prev = lastAutoSyncCheck;
+    lastAutoSyncCheck = now;
+    if (prev == 0 || now <= prev) return;
+
+    // Most recent syncHour:00:00 at or before now
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
+    int hour = configManager.getConfig().syncHour24;
+    bool today = timeinfo.tm_hour >= hour;
+    timeinfo.tm_hour = hour;
+    timeinfo.tm_min = 0;
+    timeinfo.tm_sec = 0;
+    timeinfo.tm_isdst = -1;
+    if (!today) timeinfo.tm_mday -= 1;
+    time_t due = mktime(&timeinfo);
+
+    if (due > prev && due <= now &&
+        (now - lastAutoSyncTrigger) > 3600 &&       // at least one hour since last sync
+        (lastSyncTime == 0 || time(nullptr) - lastSyncTime >= AUTO_SYNC_MIN_REAL_S)) {
+        lastAutoSyncTrigger = now;
         syncTimeWithNTP();
     }
 }
@@ -179,7 +283,14 @@ void checkAutoSync() {
  * and handles pending restart after calibration.
  */
 void updateTimerController() {
-    timeClient.update();    // keep NTP client updated
+    if (ntpStarted && WiFi.status() == WL_CONNECTED) {
+        // keep NTP client updated; each fresh answer disciplines the RTC
+        if (timeClient.update()) {
+            time_t ntpNow = (time_t)timeClient.getEpochTime();
+            recordNtpOffset(ntpNow);
+            clockManager.discipline(&ntpClock, ntpNow);
+        }
+    }
     checkAutoSync();
 
     // Якщо очікується перезапуск і калібрування завершене
@@ -196,4 +307,14 @@ void updateTimerController() {
             pendingRestart = false; // скидаємо прапорець
         }
     }
-}
\ No newline at end of file
+
+    if (pendingStart && !isCalibrationInProgress()) {
+        pendingStart = false;
+        if (areMotorsHomed()) {
+            requestTimerStart();
+            Serial.println("Timer start requested after calibration");
+        } else {
+            Serial.println("Timer not started: calibration failed");
+        }
+    }
+}
@@ -13,6 +13,18 @@
  */
 void setupTimerController();
 
+/**
+ * Start the NTP client and perform the first sync (requires WiFi).
+ * @return true if the clock was set.
+ */
+bool syncTimeAtBoot();
+
+/**
+ * Check if the system clock holds a real wall‑clock time.
+ * @return true once set by NTP (or another time source).
+ */
+bool isTimeValid();
+
 /**
  * Manually trigger NTP sync.
  */
@@ -28,6 +40,18 @@ void stopTimer();
  */
 void startTimer();
 
+/**
+ * Start the timer the way the Start button does: move the digits to the
+ * remaining value first; startTimer() follows when they arrive.
+ */
+void requestTimerStart();
+
+/**
+ * Start the timer (as requestTimerStart()) once the calibration in
+ * progress has finished with all motors homed.
+ */
+void startTimerAfterCalibration();
+
 /**
  * Check if timer is currently paused.
  * @return true if stopped.
@@ -35,9 +59,9 @@ void startTimer();
 bool isTimerStopped();
 
 /**
- * Get a user‑friendly string of remaining time (e.g., "3 дн.").
+ * Write a user‑friendly string of remaining time (e.g., "3 дн.").
  */
-String getTimeRemainingString();
+void formatTimeRemaining(char* buf, size_t len);
 
 /**
  * Called from main loop – updates NTP and auto‑sync.
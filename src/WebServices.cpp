@@ -15,25 +15,46 @@
 
 #include "ConfigManager.h"
 #include "SegmentController.h"
+#include "SegmentArray.h"
+#include "BootSequence.h"
+#include "ClockManager.h"
+#include "MotionBenchmark.h"
+#include "I2CBus.h"
+#include "Metrics.h"
+#include "TaskProfiler.h"
+#include "StepTrace.h"
+#include "TaskPlan.h"
+#include "DeviceState.h"
+#include "MemoryPlan.h"
+#include "JsonArena.h"
+#include "DisplaySync.h"
+#include "TimeWarp.h"
+#include "StepTuner.h"
+#include "WsTopics.h"
+#include "EventStore.h"
+#include "Log.h"
 
 // External references
 extern ConfigManager configManager;
-extern bool timerStopped;
 extern WiFiUDP ntpUDP;
 extern NTPClient timeClient;
 
 // Function prototypes (defined later in this file)
-String getTimeStringFromRTC();
-String formatDate(time_t t);
-String formatTime(time_t t);
-String unitToString(DurationUnit u);
-DurationUnit stringToUnit(const String& s);
+void getTimeStringFromRTC(char* buf, size_t len);
+void formatDate(time_t t, char* buf, size_t len);
+void formatTime(time_t t, char* buf, size_t len);
+const char* unitToString(DurationUnit u);
+DurationUnit stringToUnit(const char* s);
 
 void syncTimeWithNTP();
 void stopTimer();
 void startTimer();
+void requestTimerStart();
+void startTimerAfterCalibration();
 bool isTimerStopped();
-String getTimeRemainingString();
+void formatTimeRemaining(char* buf, size_t len);
+
+static int runBatch(JsonArrayConst ops, JsonObject result);
 
 // Global web server and WiFiManager instances
 AsyncWebServer server(80);
@@ -43,45 +64,371 @@ WiFiManager wm;
 // WebSocket for real‑time updates
 // -------------------------------------------------------------------
 AsyncWebSocket ws("/ws");   // WebSocket endpoint
+AsyncWebSocket logWs("/api/logs");   // formatted log lines from the log drain task
+
+/**
+ * Log sink: forward drained lines to /api/logs subscribers.
+ */
+static void logToWebSocket(const char* line) {
+    if (logWs.count() == 0) return;
+    logWs.textAll(line);
+}
+
+/**
+ * Fill the state document from one coherent device‑state snapshot, so
+ * digits, flags and config always belong together.
+ * JSON structure is shared by /api/state and the WebSocket frames; a
+ * topic frame carries only the fields of its topics (see WsTopics.h).
+ */
+static void fillStateJson(JsonDocument& doc, uint8_t topics = WS_TOPIC_STATE) {
+    DeviceSnapshot state = deviceState.snapshot();
+    char text[32];
+    time_t now = warpTime();
+
+    if (topics & WS_TOPIC_CALIBRATION) {
+        doc["motorsHomed"] = state.motorsHomed;
+        doc["calibrationInProgress"] = state.calibrationInProgress;
+    }
+
+    if (topics & WS_TOPIC_CLOCK) {
+        doc["timerStopped"] = state.timerStopped;
+        doc["epoch"] = (int64_t)now;
+        doc["warpFactor"] = getTimeWarpFactor();
+        getTimeStringFromRTC(text, sizeof(text));
+        doc["currentTimeFormatted"] = text;
+        formatTimeRemaining(text, sizeof(text));
+        doc["timeRemaining"] = text;
+
+        // Remaining seconds (safe 64‑bit), from the same snapshot
+        int64_t remaining = 0;
+        if (!state.timerStopped && now > 0) {
+            int64_t total = (int64_t)state.durationValue *
+                            ConfigManager::unitToSeconds((DurationUnit)state.durationUnit);
+            remaining = total - ((int64_t)now - state.startTime);
+            if (remaining > total) remaining = total;    // start still in the future
+            if (remaining < 0) remaining = 0;
+        }
+        doc["remainingSeconds"] = remaining;
+    }
+
+    if (topics & WS_TOPIC_MOTION) {
+        JsonArray segmentValues = doc["segmentValues"].to<JsonArray>();
+        for (int i = 0; i < DISPLAY_DIGITS; i++) segmentValues.add(state.digits[i]);
+    }
+
+    if (topics & WS_TOPIC_CONFIG) {
+        doc["durationValue"] = state.durationValue;
+        doc["durationUnit"] = unitToString((DurationUnit)state.durationUnit);
+        doc["syncHour"] = state.syncHour24;
+        doc["autoSync"] = state.autoSync;
+        formatDate((time_t)state.startTime, text, sizeof(text));
+        doc["startDate"] = text;
+        formatTime((time_t)state.startTime, text, sizeof(text));
+        doc["startTime"] = text;
+        doc["useCurrentOnStart"] = state.useCurrentOnStart;
+        doc["startTimestamp"] = state.startTime;
+        doc["calibrateOnStart"] = state.calibrateOnStart;
+    }
+
+    if (topics & WS_TOPIC_METRICS) {
+        const MotionStats& m = getMotionStats();
+        JsonObject o = doc["metrics"].to<JsonObject>();
+        o["uptimeS"] = millis() / 1000;
+        o["heapFree"] = ESP.getFreeHeap();
+        o["wsClients"] = networkMetrics.wsClients.load(std::memory_order_relaxed);
+        o["wsFramesSent"] = networkMetrics.wsFramesSent.load(std::memory_order_relaxed);
+        o["wsFramesDropped"] = networkMetrics.wsFramesDropped.load(std::memory_order_relaxed);
+        o["movesCompleted"] = m.movesCompleted;
+        o["halfSteps"] = m.halfSteps;
+        o["i2cRecoveries"] = i2cBusStats().recoveries;
+    }
+}
+
+// -------------------------------------------------------------------
+// Preallocated serialisation memory. The broadcast path (loop task) and
+// the HTTP handlers (AsyncTCP task) each own one arena.
+// -------------------------------------------------------------------
+alignas(8) static uint8_t broadcastArenaBuffer[4096];
+static JsonArena broadcastArena(broadcastArenaBuffer, sizeof(broadcastArenaBuffer));
+static char broadcastJson[1024];
+
+#define HTTP_ARENA_SIZE  16384   // /api/profiler history is the largest document
+#define CONFIG_BODY_MAX  1024
+#define BATCH_BODY_MAX   1024
+static JsonArena httpArena(NULL, 0);     // buffer attached in setupWebServer()
+static char configBody[CONFIG_BODY_MAX + 1];
+static char batchBody[BATCH_BODY_MAX + 1];
+static AsyncWebServerRequest* configOwner = NULL;  // request filling configBody
+static AsyncWebServerRequest* batchOwner = NULL;   // request filling batchBody
+
+// A chunked body buffer belongs to one request from its first chunk until
+// the last one is handled or the client goes away. A second request that
+// arrives meanwhile gets a 409 instead of interleaving its chunks.
+static bool claimBody(AsyncWebServerRequest*& owner, AsyncWebServerRequest* request, size_t index) {
+    if (index > 0) return owner == request;
+    if (owner && owner != request) {
+        request->send(409, "application/json", "{\"error\":\"Another upload in progress\"}");
+        return false;
+    }
+    owner = request;
+    AsyncWebServerRequest** slot = &owner;
+    request->onDisconnect([slot, request]() { if (*slot == request) *slot = NULL; });
+    return true;
+}
+
+#define METRICS_BUFFER_SIZE 16384
+static char* metricsBuffer = NULL;
+
+// JSON responses are serialised into one of a few slots reserved at boot
+// (PSRAM) and streamed from there. A slot stays with its request until
+// the last byte is handed to TCP or the client goes away.
+#define RESPONSE_SLOTS      4
+#define RESPONSE_SLOT_SIZE  12288
+static char* responseSlots = NULL;
+static AsyncWebServerRequest* responseOwner[RESPONSE_SLOTS];
+
+static void sendJson(AsyncWebServerRequest* request, int status, const JsonDocument& doc) {
+    size_t len = measureJson(doc);
+    if (doc.overflowed() || responseSlots == NULL || len >= RESPONSE_SLOT_SIZE) {
+        request->send(500, "application/json", "{\"error\":\"Response too large\"}");
+        return;
+    }
+    int slot = 0;
+    while (slot < RESPONSE_SLOTS && responseOwner[slot] != NULL) slot++;
+    if (slot == RESPONSE_SLOTS) {
+        request->send(503, "application/json", "{\"error\":\"Server busy\"}");
+        return;
+    }
+    char* body = responseSlots + slot * RESPONSE_SLOT_SIZE;
+    serializeJson(doc, body, RESPONSE_SLOT_SIZE);
+    responseOwner[slot] = request;
+    request->onDisconnect([slot, request]() {
+        if (responseOwner[slot] == request) responseOwner[slot] = NULL;   // aborted mid‑body
+    });
+
+    AsyncWebServerResponse *response = request->beginResponse("application/json", len,
+        [slot, request, body, len](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            size_t n = len - index;
+            if (n > maxLen) n = maxLen;
+            memcpy(buffer, body + index, n);
+            if (index + n == len && responseOwner[slot] == request) responseOwner[slot] = NULL;
+            return n;
+        });
+    response->setCode(status);
+    request->send(response);
+}
+
+// Topics requested by broadcastTopics() from any task, sent by
+// serviceBroadcasts()
+static std::atomic<uint8_t> pendingTopics(0);
+
+// Non‑zero while a batch applies its operations; their requests collect
+// in pendingTopics and go out as one frame afterwards
+static std::atomic<uint8_t> broadcastHolds(0);
 
 /**
- * Broadcast current state to all connected WebSocket clients.
+ * Request a state broadcast to all WebSocket clients. Safe from any task;
+ * bursts collapse into one frame sent from the loop task.
  * JSON structure matches /api/state.
  */
 void broadcastState() {
-    JsonDocument doc;
-    auto& config = configManager.getConfig();
-
-    doc["motorsHomed"] = areMotorsHomed();
-    doc["timerStopped"] = isTimerStopped();
-    doc["currentTimeFormatted"] = getTimeStringFromRTC();
-    doc["timeRemaining"] = getTimeRemainingString();
-    doc["calibrationInProgress"] = isCalibrationInProgress();
-
-    int* digits = getCurrentDigits();
-    JsonArray segmentValues = doc["segmentValues"].to<JsonArray>();
-    for (int i = 0; i < 4; i++) segmentValues.add(digits[i]);
-
-    doc["durationValue"] = config.duration.value;
-    doc["durationUnit"] = unitToString(config.duration.unit);
-    doc["syncHour"] = config.syncHour24;
-    doc["autoSync"] = config.autoSync;
-    doc["startDate"] = formatDate(config.startTime);
-    doc["startTime"] = formatTime(config.startTime);
-    doc["useCurrentOnStart"] = config.useCurrentOnStart;
-    doc["startTimestamp"] = config.startTime;
-    doc["calibrateOnStart"] = config.calibrateOnStart;
-
-    // Remaining seconds (safe 64‑bit)
-    if (!timerStopped && configManager.isTimerActive()) {
-        doc["remainingSeconds"] = configManager.getRemainingSeconds();
-    } else {
-        doc["remainingSeconds"] = 0;
-    }
-
-    String response;
-    serializeJson(doc, response);
-    ws.textAll(response);   // send to all clients
+    broadcastTopics(WS_TOPIC_STATE);
+}
+
+void broadcastTopics(uint8_t topics) {
+    pendingTopics.fetch_or(topics, std::memory_order_release);
+}
+
+// -------------------------------------------------------------------
+// Per‑client subscriptions. Written by the WebSocket events (AsyncTCP
+// task), read by serviceBroadcasts() (loop task).
+// -------------------------------------------------------------------
+#define WS_MAX_SUBSCRIBERS 8            // AsyncWebSocket's client limit
+
+struct WsSubscriber {
+    uint32_t clientId;                  // 0 = free slot
+    uint8_t topics;
+    bool subscribed;                    // false: legacy client, full state frames
+    bool snapshotDue;                   // send current values of all its topics
+};
+
+static WsSubscriber subscribers[WS_MAX_SUBSCRIBERS] = {};
+static portMUX_TYPE subscribersMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void publishSubscriberCounts() {
+    uint32_t counts[WS_TOPIC_COUNT] = {};
+    for (const WsSubscriber& sub : subscribers) {
+        if (!sub.clientId) continue;
+        for (int t = 0; t < WS_TOPIC_COUNT; t++) {
+            if (sub.topics & (1 << t)) counts[t]++;
+        }
+    }
+    for (int t = 0; t < WS_TOPIC_COUNT; t++) {
+        networkMetrics.wsSubscribers[t].store(counts[t], std::memory_order_relaxed);
+    }
+}
+
+static void addSubscriber(uint32_t clientId) {
+    portENTER_CRITICAL(&subscribersMux);
+    for (WsSubscriber& sub : subscribers) {
+        if (sub.clientId) continue;
+        sub = { clientId, WS_TOPIC_STATE, false, true };
+        break;
+    }
+    portEXIT_CRITICAL(&subscribersMux);
+    publishSubscriberCounts();
+}
+
+static void removeSubscriber(uint32_t clientId) {
+    portENTER_CRITICAL(&subscribersMux);
+    for (WsSubscriber& sub : subscribers) {
+        if (sub.clientId == clientId) sub = {};
+    }
+    portEXIT_CRITICAL(&subscribersMux);
+    publishSubscriberCounts();
+}
+
+/**
+ * Change a client's topics (set replaces, otherwise add/remove).
+ * @return the client's topics afterwards
+ */
+static uint8_t updateSubscription(uint32_t clientId, uint8_t add, uint8_t remove, bool replace) {
+    uint8_t topics = 0;
+    portENTER_CRITICAL(&subscribersMux);
+    for (WsSubscriber& sub : subscribers) {
+        if (sub.clientId != clientId) continue;
+        uint8_t before = sub.subscribed ? sub.topics : 0;
+        sub.topics = ((replace ? 0 : before) | add) & ~remove;
+        sub.subscribed = true;
+        sub.snapshotDue = (sub.topics & ~before) != 0;
+        topics = sub.topics;
+        break;
+    }
+    portEXIT_CRITICAL(&subscribersMux);
+    publishSubscriberCounts();
+    return topics;
+}
+
+/**
+ * Send pending topic frames. Called from loop(); uses only preallocated
+ * memory on our side (the WebSocket library still queues its own frames).
+ * Clients with the same topics share one serialised frame.
+ */
+void serviceBroadcasts() {
+    static unsigned long lastClockMs = 0;
+    static unsigned long lastMetricsMs = 0;
+    unsigned long nowMs = millis();
+    if (nowMs - lastClockMs >= WS_CLOCK_RESYNC_MS) {
+        lastClockMs = nowMs;
+        broadcastTopics(WS_TOPIC_CLOCK);
+    }
+    if (nowMs - lastMetricsMs >= WS_METRICS_INTERVAL_MS) {
+        lastMetricsMs = nowMs;
+        broadcastTopics(WS_TOPIC_METRICS);      // goes nowhere without subscribers
+    }
+    if (broadcastHolds.load(std::memory_order_acquire)) return;
+
+    uint8_t pending = pendingTopics.exchange(0, std::memory_order_acq_rel);
+    if (ws.count() == 0) return;
+
+    // Decide per client under the lock, send outside it
+    uint32_t ids[WS_MAX_SUBSCRIBERS];
+    uint8_t masks[WS_MAX_SUBSCRIBERS];
+    int targets = 0;
+    portENTER_CRITICAL(&subscribersMux);
+    for (WsSubscriber& sub : subscribers) {
+        if (!sub.clientId) continue;
+        uint8_t mask = sub.topics & pending;
+        if (sub.snapshotDue) mask = sub.topics;
+        if (!sub.subscribed && mask) mask = WS_TOPIC_STATE;     // legacy: whole document
+        sub.snapshotDue = false;
+        if (!mask) continue;
+        ids[targets] = sub.clientId;
+        masks[targets] = mask;
+        targets++;
+    }
+    portEXIT_CRITICAL(&subscribersMux);
+
+    for (int i = 0; i < targets; i++) {
+        uint8_t mask = masks[i];
+        if (!mask) continue;                    // already sent with an earlier group
+        size_t len;
+        {
+            JsonDocument doc(&broadcastArena);
+            fillStateJson(doc, mask);
+            len = serializeJson(doc, broadcastJson, sizeof(broadcastJson));
+            if (doc.overflowed() || len >= sizeof(broadcastJson) - 1) {
+                LOG_E("[WS] state frame does not fit (%u bytes)\n", (unsigned)len);
+                // Skip this group only; its topics go out on the next pass
+                for (int j = i; j < targets; j++) {
+                    if (masks[j] == mask) masks[j] = 0;
+                }
+                pendingTopics.fetch_or(mask, std::memory_order_acq_rel);
+                continue;
+            }
+        }
+        for (int j = i; j < targets; j++) {
+            if (masks[j] != mask) continue;
+            masks[j] = 0;
+            AsyncWebSocketClient* client = ws.client(ids[j]);
+            if (!client || client->status() != WS_CONNECTED) continue;
+            // A client whose send queue is full will drop this frame
+            if (client->canSend()) {
+                networkMetrics.wsFramesSent.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                networkMetrics.wsFramesDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            client->text(broadcastJson, len);
+        }
+    }
+}
+
+/**
+ * Handle a text message from a /ws client (AsyncTCP task).
+ */
+static void handleWsMessage(AsyncWebSocketClient* client, const uint8_t* data, size_t len) {
+    JsonDocument doc(&httpArena);
+    if (deserializeJson(doc, (const char*)data, len) || !doc.is<JsonObject>()) {
+        client->text("{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+
+    JsonVariantConst batch = doc["batch"];
+    if (!batch.isNull()) {
+        JsonDocument reply(&httpArena);
+        JsonObject result = reply["batch"].to<JsonObject>();
+        result["status"] = runBatch(batch.as<JsonArrayConst>(), result);
+        char frame[512];
+        size_t n = serializeJson(reply, frame, sizeof(frame));
+        if (n >= sizeof(frame) - 1) {
+            client->text("{\"batch\":{\"success\":false,\"error\":\"Result too large\"}}");
+            return;
+        }
+        client->text(frame, n);
+        return;
+    }
+
+    JsonVariantConst sub = doc["subscribe"];
+    JsonVariantConst unsub = doc["unsubscribe"];
+    if (sub.isNull() && unsub.isNull()) {
+        client->text("{\"error\":\"Unknown command\"}");
+        return;
+    }
+    uint8_t add = 0, remove = 0;
+    for (JsonVariantConst t : sub.as<JsonArrayConst>()) add |= wsTopicFromName(t.as<const char*>());
+    for (JsonVariantConst t : unsub.as<JsonArrayConst>()) remove |= wsTopicFromName(t.as<const char*>());
+    uint8_t topics = updateSubscription(client->id(), add, remove, !sub.isNull());
+
+    char reply[96];
+    size_t n = snprintf(reply, sizeof(reply), "{\"topics\":[");
+    bool first = true;
+    for (int t = 0; t < WS_TOPIC_COUNT && n < sizeof(reply); t++) {
+        if (!(topics & (1 << t))) continue;
+        n += snprintf(reply + n, sizeof(reply) - n, "%s\"%s\"", first ? "" : ",", wsTopicName(t));
+        first = false;
+    }
+    if (n < sizeof(reply)) snprintf(reply + n, sizeof(reply) - n, "]}");
+    client->text(reply);            // the snapshot follows with the next service pass
 }
 
 /**
@@ -92,15 +439,23 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
     switch (type) {
         case WS_EVT_CONNECT:
             Serial.printf("WebSocket client #%u connected\n", client->id());
-            // Send current state immediately on connect
-            broadcastState();
+            networkMetrics.wsClients.store(server->count(), std::memory_order_relaxed);
+            // Current state goes to the new client only, on the next service pass
+            addSubscriber(client->id());
             break;
         case WS_EVT_DISCONNECT:
             Serial.printf("WebSocket client #%u disconnected\n", client->id());
+            networkMetrics.wsClients.store(server->count(), std::memory_order_relaxed);
+            removeSubscriber(client->id());
             break;
-        case WS_EVT_DATA:
-            // We don't process incoming messages – client only listens
+        case WS_EVT_DATA: {
+            // Commands are small: single‑frame text messages only
+            AwsFrameInfo* info = (AwsFrameInfo*)arg;
+            if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+                handleWsMessage(client, data, len);
+            }
             break;
+        }
         case WS_EVT_PONG:
         case WS_EVT_ERROR:
             break;
@@ -118,7 +473,11 @@ void setupLittleFS() {
     Serial.println("LittleFS mounted successfully");
 }
 
-void setupWiFi() {
+/**
+ * Connect to WiFi (WiFiManager portal if no credentials).
+ * Returns false on timeout; the caller decides whether to retry.
+ */
+bool setupWiFi() {
     WiFi.mode(WIFI_STA);
     WiFi.setHostname("timer");
 
@@ -126,14 +485,14 @@ void setupWiFi() {
     wm.setHostname("timer");
 
     if (!wm.autoConnect("ESP32-Timer")) {
-        Serial.println("WiFi failed, rebooting...");
-        delay(1000);
-        ESP.restart();
+        Serial.println("WiFi failed, will retry");
+        return false;
     }
 
     Serial.println("WiFi connected");
     Serial.print("IP address: ");
     Serial.println(WiFi.localIP());
+    return true;
 }
 
 void setupMDNS() {
@@ -149,33 +508,33 @@ void setupMDNS() {
 // -------------------------------------------------------------------
 // Time formatting helpers
 // -------------------------------------------------------------------
-String getTimeStringFromRTC() {
-    time_t now = time(nullptr);
-    if (now == 0) return "--:--:--";
-    struct tm *timeinfo = localtime(&now);
-    char timeStr[20];
-    strftime(timeStr, sizeof(timeStr), "%H:%M:%S", timeinfo);
-    return String(timeStr);
+void getTimeStringFromRTC(char* buf, size_t len) {
+    time_t now = warpTime();
+    if (now == 0) {
+        snprintf(buf, len, "--:--:--");
+        return;
+    }
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
+    strftime(buf, len, "%H:%M:%S", &timeinfo);
 }
 
-String formatDate(time_t t) {
-    struct tm *tm = localtime(&t);
-    char buf[11];
-    snprintf(buf, sizeof(buf), "%04d-%02d-%02d", tm->tm_year+1900, tm->tm_mon+1, tm->tm_mday);
-    return String(buf);
+void formatDate(time_t t, char* buf, size_t len) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    snprintf(buf, len, "%04d-%02d-%02d", tm.tm_year+1900, tm.tm_mon+1, tm.tm_mday);
 }
 
-String formatTime(time_t t) {
-    struct tm *tm = localtime(&t);
-    char buf[9];
-    snprintf(buf, sizeof(buf), "%02d:%02d:%02d", tm->tm_hour, tm->tm_min, tm->tm_sec);
-    return String(buf);
+void formatTime(time_t t, char* buf, size_t len) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    snprintf(buf, len, "%02d:%02d:%02d", tm.tm_hour, tm.tm_min, tm.tm_sec);
 }
 
 // -------------------------------------------------------------------
 // Duration unit conversion
 // -------------------------------------------------------------------
-String unitToString(DurationUnit u) {
+const char* unitToString(DurationUnit u) {
     switch(u) {
         case UNIT_DAYS:    return "days";
         case UNIT_HOURS:   return "hours";
@@ -185,74 +544,319 @@ String unitToString(DurationUnit u) {
     }
 }
 
-DurationUnit stringToUnit(const String& s) {
-    if (s == "hours") return UNIT_HOURS;
-    if (s == "minutes") return UNIT_MINUTES;
-    if (s == "seconds") return UNIT_SECONDS;
+DurationUnit stringToUnit(const char* s) {
+    if (s == NULL) return UNIT_DAYS;
+    if (strcmp(s, "hours") == 0) return UNIT_HOURS;
+    if (strcmp(s, "minutes") == 0) return UNIT_MINUTES;
+    if (strcmp(s, "seconds") == 0) return UNIT_SECONDS;
     return UNIT_DAYS;
 }
 
+// -------------------------------------------------------------------
+// Config fields (POST /api/config and the batch "config" operation)
+// -------------------------------------------------------------------
+
+/**
+ * Check the fields present in a config document.
+ * @return NULL if valid, otherwise a static error message
+ */
+static const char* checkConfigFields(JsonVariantConst in) {
+    JsonVariantConst v = in["durationValue"];
+    if (!v.isNull() && (!v.is<int>() || v.as<int>() < 0 || v.as<int>() > DisplayArray::maxValue())) {
+        return "Invalid durationValue";
+    }
+    v = in["durationUnit"];
+    if (!v.isNull()) {
+        const char* unit = v.as<const char*>();
+        if (unit == NULL || strcmp(unitToString(stringToUnit(unit)), unit) != 0) return "Invalid durationUnit";
+    }
+    v = in["syncHour"];
+    if (!v.isNull() && (!v.is<int>() || v.as<int>() < 0 || v.as<int>() > 23)) {
+        return "Invalid syncHour";
+    }
+    return NULL;
+}
+
+/**
+ * Apply the fields present in a config document to `config`; absent
+ * fields keep their value. `running` is the timer state the change
+ * applies to.
+ * @return true if the timer has to stop (switched to "use current time"
+ *         while running)
+ */
+static bool applyConfigFields(JsonVariantConst in, TimerConfig& config, bool running) {
+    bool newUseCurrentOnStart = in["useCurrentOnStart"] | config.useCurrentOnStart;
+    bool mustStop = newUseCurrentOnStart && !config.useCurrentOnStart && running;
+
+    config.useCurrentOnStart = newUseCurrentOnStart;
+    config.duration.value = in["durationValue"] | config.duration.value;
+    if (!in["durationUnit"].isNull()) config.duration.unit = stringToUnit(in["durationUnit"].as<const char*>());
+    config.syncHour24 = in["syncHour"] | config.syncHour24;
+    config.autoSync = in["autoSync"] | config.autoSync;
+    config.calibrateOnStart = in["calibrateOnStart"] | config.calibrateOnStart;
+
+    // Handle start time logic
+    if (newUseCurrentOnStart && (!running || mustStop)) {
+        config.startTime = warpTime();
+    }
+    if (!newUseCurrentOnStart && !in["startDate"].isNull() && !in["startTime"].isNull()) {
+        char datetimeStr[48];
+        snprintf(datetimeStr, sizeof(datetimeStr), "%sT%s",
+                 in["startDate"] | "", in["startTime"] | "");
+        struct tm tm = {0};
+        if (sscanf(datetimeStr, "%d-%d-%dT%d:%d:%d",
+                   &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                   &tm.tm_hour, &tm.tm_min, &tm.tm_sec) == 6) {
+            tm.tm_year -= 1900;
+            tm.tm_mon -= 1;
+            config.startTime = mktime(&tm);
+        }
+    }
+    return mustStop;
+}
+
+// -------------------------------------------------------------------
+// Batches: an ordered list of operations applied as one change.
+//
+//   {"ops":[{"op":"config","durationValue":30,"durationUnit":"minutes"},
+//           {"op":"calibrate"},
+//           {"op":"start"}]}
+//
+// Operations: config (fields as POST /api/config), calibrate, start,
+// stop, reset, testall (value). Every operation is checked before any
+// is applied; one invalid operation rejects the whole batch. Applying
+// works on a copy of the config that is written to NVS (one write)
+// before anything else happens: if the write fails, the previous config
+// is restored and nothing moves. Clients get one broadcast for the
+// batch. A start after "calibrate" (or during a running calibration)
+// waits for the homing.
+// -------------------------------------------------------------------
+#define BATCH_MAX_OPS 8
+
+enum BatchOpType : uint8_t {
+    BATCH_CONFIG = 0,
+    BATCH_CALIBRATE,
+    BATCH_START,
+    BATCH_STOP,
+    BATCH_RESET,
+    BATCH_TESTALL,
+    BATCH_OP_COUNT
+};
+
+static const char* const BATCH_OP_NAMES[BATCH_OP_COUNT] = {
+    "config", "calibrate", "start", "stop", "reset", "testall"
+};
+
+static int batchOpType(const char* name) {
+    if (name == NULL) return -1;
+    for (int i = 0; i < BATCH_OP_COUNT; i++) {
+        if (strcmp(name, BATCH_OP_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static int batchReject(JsonObject result, int status, int index, const char* error) {
+    result["success"] = false;
+    if (index >= 0) result["failedOp"] = index;
+    result["error"] = error;
+    return status;
+}
+
+/**
+ * Validate and apply a batch (AsyncTCP task). Writes the combined result
+ * to `result`.
+ * @return HTTP status: 200, 400 (invalid operation), 409 (motors busy),
+ *         500 (config not saved – nothing applied)
+ */
+static int runBatch(JsonArrayConst ops, JsonObject result) {
+    if (ops.isNull() || ops.size() == 0) return batchReject(result, 400, -1, "Missing ops");
+    if (ops.size() > BATCH_MAX_OPS) return batchReject(result, 400, -1, "Too many ops");
+
+    // Check everything first – nothing is applied if one operation is invalid
+    uint8_t types[BATCH_MAX_OPS];
+    int count = 0;
+    bool calibrating = isCalibrationInProgress();
+    bool calibrate = false;
+    bool locked = isMotionLocked();
+    for (JsonVariantConst op : ops) {
+        int type = batchOpType(op["op"].as<const char*>());
+        if (type < 0) return batchReject(result, 400, count, "Unknown op");
+        if (locked && type != BATCH_CONFIG && type != BATCH_STOP) {
+            return batchReject(result, 409, count, "Motion benchmark running");
+        }
+        switch (type) {
+            case BATCH_CONFIG: {
+                const char* error = checkConfigFields(op);
+                if (error) return batchReject(result, 400, count, error);
+                break;
+            }
+            case BATCH_CALIBRATE:
+                if (calibrating) return batchReject(result, 409, count, "Calibration already in progress");
+                calibrate = true;
+                break;
+            case BATCH_START:
+                if (!calibrate && !calibrating && !areMotorsHomed()) {
+                    return batchReject(result, 409, count, "Motors not homed");
+                }
+                break;
+            case BATCH_TESTALL: {
+                JsonVariantConst v = op["value"];
+                if (!v.is<int>() || v.as<int>() < 0 || v.as<int>() > DisplayArray::maxValue()) {
+                    return batchReject(result, 400, count, "Invalid value");
+                }
+                if (calibrate || calibrating) return batchReject(result, 409, count, "Motors busy calibrating");
+                break;
+            }
+            default:
+                break;
+        }
+        types[count++] = (uint8_t)type;
+    }
+
+    // Apply in order to a staged config and the wanted timer state
+    TimerConfig staged = configManager.getConfig();
+    bool wasRunning = !isTimerStopped();
+    bool running = wasRunning;
+    bool startWanted = false;
+    bool stopWanted = false;
+    int moveTo = -1;                    // reset / testall target
+    uint8_t topics = 0;
+    JsonArray results = result["results"].to<JsonArray>();
+    for (int i = 0; i < count; i++) {
+        JsonVariantConst op = ops[i];
+        const char* outcome = "applied";
+        switch (types[i]) {
+            case BATCH_CONFIG:
+                if (applyConfigFields(op, staged, running)) {
+                    running = false;
+                    startWanted = false;
+                    stopWanted = true;
+                }
+                topics |= WS_TOPIC_CONFIG | WS_TOPIC_CLOCK;
+                break;
+            case BATCH_CALIBRATE:
+                topics |= WS_TOPIC_CALIBRATION;
+                break;
+            case BATCH_START:
+                if (running) {
+                    outcome = "unchanged";
+                    break;
+                }
+                running = true;
+                startWanted = true;
+                outcome = calibrate || calibrating ? "after calibration" : "after movement";
+                topics |= WS_TOPIC_CLOCK | WS_TOPIC_CONFIG;
+                break;
+            case BATCH_STOP:
+                if (!running) {
+                    outcome = "unchanged";
+                    break;
+                }
+                running = false;
+                startWanted = false;
+                stopWanted = true;
+                topics |= WS_TOPIC_CLOCK | WS_TOPIC_CONFIG;
+                break;
+            case BATCH_RESET:
+                staged.duration.value = 0;
+                moveTo = 0;
+                topics |= WS_TOPIC_CONFIG | WS_TOPIC_CLOCK;
+                break;
+            case BATCH_TESTALL:
+                moveTo = op["value"].as<int>();
+                topics |= WS_TOPIC_MOTION;
+                break;
+        }
+        JsonObject r = results.add<JsonObject>();
+        r["op"] = BATCH_OP_NAMES[types[i]];
+        r["result"] = outcome;
+    }
+
+    // Commit: persist the config (and a stop) first, then act; one broadcast
+    broadcastHolds.fetch_add(1, std::memory_order_acq_rel);
+    TimerConfig previous = configManager.getConfig();
+    bool stopping = wasRunning && stopWanted;
+    configManager.getConfig() = staged;
+    if (stopping) configManager.saveTimerState(false);
+    if (!configManager.save() || !configManager.flush()) {
+        // Roll back; the blob on flash still holds the previous config
+        configManager.getConfig() = previous;
+        if (stopping) configManager.saveTimerState(true);
+        configManager.save();
+        broadcastHolds.fetch_sub(1, std::memory_order_acq_rel);
+        LOG_E("[BATCH] Save failed – batch not applied");
+        result.remove("results");
+        return batchReject(result, 500, -1, "Save failed");
+    }
+    if (stopping) stopTimer();
+    if (calibrate && !startCalibration()) {
+        // Lost a race with another calibration request; it homes the drums all the same
+        LOG_W("[BATCH] Calibration already started");
+    }
+    if (startWanted) {
+        if (calibrate || calibrating) {
+            startTimerAfterCalibration();
+        } else {
+            requestTimerStart();
+        }
+    } else if (moveTo >= 0 && !calibrate) {
+        updateAllSegments(moveTo);
+    } else if (running && !calibrate) {
+        updateAllSegments(configManager.getCurrentValueRemaining());
+    }
+    broadcastHolds.fetch_sub(1, std::memory_order_acq_rel);
+    broadcastTopics(topics);
+
+    LOG_I("[BATCH] %d operations applied\n", count);
+    result["success"] = true;
+    return 200;
+}
+
 // -------------------------------------------------------------------
 // Web server setup – REST endpoints and static files
 // -------------------------------------------------------------------
 void setupWebServer() {
-    timeClient.begin();
-
     // Attach WebSocket handler
     ws.onEvent(onWsEvent);
     server.addHandler(&ws);
+    server.addHandler(&logWs);
+    setLogSink(logToWebSocket);
+
+    // Long‑lived buffers: reserved once, large ones in PSRAM
+    planRegisterStatic("ws state arena", sizeof(broadcastArenaBuffer));
+    planRegisterStatic("ws state frame", sizeof(broadcastJson));
+    planRegisterStatic("config body", sizeof(configBody));
+    planRegisterStatic("batch body", sizeof(batchBody));
+    httpArena.attach(planAllocate("http json arena", HTTP_ARENA_SIZE, MEM_PSRAM), HTTP_ARENA_SIZE);
+    metricsBuffer = (char*)planAllocate("metrics page", METRICS_BUFFER_SIZE, MEM_PSRAM);
+    responseSlots = (char*)planAllocate("http responses", RESPONSE_SLOTS * RESPONSE_SLOT_SIZE, MEM_PSRAM);
 
     // ---------- REST API ----------
     server.on("/api/state", HTTP_GET, [](AsyncWebServerRequest *request) {
-        JsonDocument doc;
-        auto& config = configManager.getConfig();
-
-        doc["motorsHomed"] = areMotorsHomed();
-        doc["timerStopped"] = isTimerStopped();
-        doc["currentTimeFormatted"] = getTimeStringFromRTC();
-        doc["timeRemaining"] = getTimeRemainingString();
-        doc["calibrationInProgress"] = isCalibrationInProgress();
+        metricsCountRequest(ROUTE_STATE);
+        JsonDocument doc(&httpArena);
+        fillStateJson(doc);
 
-        int* digits = getCurrentDigits();
-        JsonArray segmentValues = doc["segmentValues"].to<JsonArray>();
-        for (int i = 0; i < 4; i++) segmentValues.add(digits[i]);
-
-        doc["durationValue"] = config.duration.value;
-        doc["durationUnit"] = unitToString(config.duration.unit);
-        doc["syncHour"] = config.syncHour24;
-        doc["autoSync"] = config.autoSync;
-        doc["startDate"] = formatDate(config.startTime);
-        doc["startTime"] = formatTime(config.startTime);
-        doc["useCurrentOnStart"] = config.useCurrentOnStart;
-        doc["startTimestamp"] = config.startTime;
-        doc["calibrateOnStart"] = config.calibrateOnStart;
-
-        if (!timerStopped && configManager.isTimerActive()) {
-            doc["remainingSeconds"] = configManager.getRemainingSeconds();
-        } else {
-            doc["remainingSeconds"] = 0;
-        }
-
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        sendJson(request, 200, doc);
     });
 
     server.on("/api/config", HTTP_GET, [](AsyncWebServerRequest *request) {
-        JsonDocument doc;
-        auto& config = configManager.getConfig();
-        doc["durationValue"] = config.duration.value;
-        doc["durationUnit"] = unitToString(config.duration.unit);
-        doc["syncHour"] = config.syncHour24;
-        doc["autoSync"] = config.autoSync;
-        doc["startDate"] = formatDate(config.startTime);
-        doc["startTime"] = formatTime(config.startTime);
-        doc["useCurrentOnStart"] = config.useCurrentOnStart;
-        doc["startTimestamp"] = config.startTime;
-        doc["calibrateOnStart"] = config.calibrateOnStart;
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        metricsCountRequest(ROUTE_CONFIG_GET);
+        JsonDocument doc(&httpArena);
+        DeviceSnapshot state = deviceState.snapshot();
+        char text[16];
+        doc["durationValue"] = state.durationValue;
+        doc["durationUnit"] = unitToString((DurationUnit)state.durationUnit);
+        doc["syncHour"] = state.syncHour24;
+        doc["autoSync"] = state.autoSync;
+        formatDate((time_t)state.startTime, text, sizeof(text));
+        doc["startDate"] = text;
+        formatTime((time_t)state.startTime, text, sizeof(text));
+        doc["startTime"] = text;
+        doc["useCurrentOnStart"] = state.useCurrentOnStart;
+        doc["startTimestamp"] = state.startTime;
+        doc["calibrateOnStart"] = state.calibrateOnStart;
+        sendJson(request, 200, doc);
     });
 
     server.on(
@@ -261,61 +865,35 @@ void setupWebServer() {
         [](AsyncWebServerRequest *request) {},
         NULL,
         [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-            static String body;
-
-            if (index == 0) body = "";
-            body += String((char*)data).substring(0, len);
+            // Body is collected in a fixed buffer (AsyncTCP task only)
+            if (total > CONFIG_BODY_MAX) {
+                if (index == 0) request->send(413, "application/json", "{\"error\":\"Body too large\"}");
+                return;
+            }
+            if (!claimBody(configOwner, request, index)) return;
+            memcpy(configBody + index, data, len);
             if (index + len != total) return;
+            configBody[total] = '\0';
+            configOwner = NULL;  // parsed below, before this task takes another chunk
+            metricsCountRequest(ROUTE_CONFIG_POST);
 
-            JsonDocument doc;
-            DeserializationError error = deserializeJson(doc, body);
+            JsonDocument doc(&httpArena);
+            DeserializationError error = deserializeJson(doc, configBody, total);
             if (error) {
                 request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
                 return;
             }
 
-            auto& config = configManager.getConfig();
-            bool oldUseCurrentOnStart = config.useCurrentOnStart;
-
-            // Read all fields with defaults
-            bool newUseCurrentOnStart = doc["useCurrentOnStart"] | config.useCurrentOnStart;
-            int newDurationValue = doc["durationValue"] | config.duration.value;
-            DurationUnit newDurationUnit = doc["durationUnit"].isNull() ? config.duration.unit : stringToUnit(doc["durationUnit"].as<String>());
-            int newSyncHour = doc["syncHour"] | config.syncHour24;
-            bool newAutoSync = doc["autoSync"] | config.autoSync;
-            bool newCalibrateOnStart = doc["calibrateOnStart"] | config.calibrateOnStart;
-
-            // Handle start time logic
-            if (newUseCurrentOnStart && !oldUseCurrentOnStart) {
-                if (!timerStopped) {
-                    stopTimer();
-                }
-                config.startTime = time(nullptr);
-            }
-
-            config.useCurrentOnStart = newUseCurrentOnStart;
-            config.duration.value = newDurationValue;
-            config.duration.unit = newDurationUnit;
-            config.syncHour24 = newSyncHour;
-            config.autoSync = newAutoSync;
-            config.calibrateOnStart = newCalibrateOnStart;
-
-            if (newUseCurrentOnStart && timerStopped) {
-                config.startTime = time(nullptr);
+            const char* invalid = checkConfigFields(doc.as<JsonVariantConst>());
+            if (invalid) {
+                char body[64];
+                snprintf(body, sizeof(body), "{\"error\":\"%s\"}", invalid);
+                request->send(400, "application/json", body);
+                return;
             }
 
-            if (!newUseCurrentOnStart) {
-                if (!doc["startDate"].isNull() && !doc["startTime"].isNull()) {
-                    String datetimeStr = doc["startDate"].as<String>() + "T" + doc["startTime"].as<String>();
-                    struct tm tm = {0};
-                    if (sscanf(datetimeStr.c_str(), "%d-%d-%dT%d:%d:%d",
-                               &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
-                               &tm.tm_hour, &tm.tm_min, &tm.tm_sec) == 6) {
-                        tm.tm_year -= 1900;
-                        tm.tm_mon -= 1;
-                        config.startTime = mktime(&tm);
-                    }
-                }
+            if (applyConfigFields(doc.as<JsonVariantConst>(), configManager.getConfig(), !isTimerStopped())) {
+                stopTimer();
             }
 
             if (!configManager.save()) {
@@ -323,101 +901,731 @@ void setupWebServer() {
                 return;
             }
 
-            if (!timerStopped) {
+            if (!isTimerStopped()) {
                 int remaining = configManager.getCurrentValueRemaining();
                 updateAllSegments(remaining);
             }
 
             // Broadcast updated state to all clients
-            broadcastState();
+            broadcastTopics(WS_TOPIC_CONFIG | WS_TOPIC_CLOCK);
 
             request->send(200, "application/json", "{\"success\":true}");
         }
     );
 
+    server.on(
+        "/api/batch",
+        HTTP_POST,
+        [](AsyncWebServerRequest *request) {},
+        NULL,
+        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            // Body is collected in a fixed buffer (AsyncTCP task only)
+            if (total > BATCH_BODY_MAX) {
+                if (index == 0) request->send(413, "application/json", "{\"error\":\"Body too large\"}");
+                return;
+            }
+            if (!claimBody(batchOwner, request, index)) return;
+            memcpy(batchBody + index, data, len);
+            if (index + len != total) return;
+            batchBody[total] = '\0';
+            batchOwner = NULL;   // parsed below, before this task takes another chunk
+            metricsCountRequest(ROUTE_BATCH);
+
+            JsonDocument doc(&httpArena);
+            if (deserializeJson(doc, batchBody, total) || !doc.is<JsonObject>()) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+            JsonDocument reply(&httpArena);
+            int status = runBatch(doc["ops"].as<JsonArrayConst>(), reply.to<JsonObject>());
+            sendJson(request, status, reply);
+        }
+    );
+
     server.on("/api/stop", HTTP_POST, [](AsyncWebServerRequest *request) {
-        auto& config = configManager.getConfig();
+        metricsCountRequest(ROUTE_STOP);
 
         if (isTimerStopped()) {
-            int targetValue = configManager.getCurrentValueRemaining();
-            // Встановлюємо прапорець, що після руху треба запустити таймер
-            setStartAfterMovement(true);
-            updateAllSegments(targetValue);
-            if (config.useCurrentOnStart) {
-                config.startTime = time(nullptr);
-                configManager.save();
+            if (isMotionLocked()) {
+                request->send(409, "application/json", "{\"error\":\"Motion benchmark running\"}");
+                return;
             }
             // startTimer() буде викликано після завершення руху в SegmentController
+            requestTimerStart();
             request->send(200, "application/json", "{\"status\":\"started\"}");
         } else {
             stopTimer();
             request->send(200, "application/json", "{\"status\":\"stopped\"}");
         }
-        broadcastState();   // notify all clients
+        broadcastTopics(WS_TOPIC_CLOCK | WS_TOPIC_CONFIG);   // notify all clients
     });
 
     server.on("/api/sync", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_SYNC);
         syncTimeWithNTP();
         request->send(200, "application/json", "{\"success\":true}");
-        broadcastState();   // time may have changed
+        broadcastTopics(WS_TOPIC_CLOCK);   // time may have changed
     });
 
     server.on("/api/calibrate", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_CALIBRATE);
         if (startCalibration()) {
             request->send(200, "application/json", "{\"success\":true, \"message\":\"Calibration started\"}");
-            broadcastState();   // calibration in progress now
+            broadcastTopics(WS_TOPIC_CALIBRATION);   // calibration in progress now
+        } else if (isMotionLocked()) {
+            request->send(409, "application/json", "{\"error\":\"Motion benchmark running\"}");
+        } else {
+            request->send(429, "application/json", "{\"error\":\"Calibration already in progress\"}");
+        }
+    });
+
+    // Step‑rate tuning (see StepTuner.h): runs as a calibration
+    server.on("/api/tune", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_TUNE);
+        if (startStepTuning()) {
+            request->send(200, "application/json", "{\"success\":true, \"message\":\"Tuning started\"}");
+            broadcastTopics(WS_TOPIC_CALIBRATION);   // calibration in progress now
         } else {
             request->send(429, "application/json", "{\"error\":\"Calibration already in progress\"}");
         }
     });
 
+    server.on("/api/tune", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_TUNE);
+        JsonDocument doc(&httpArena);
+        doc["inProgress"] = isStepTuningInProgress();
+        doc["tunedAt"] = getStepTunedAt();
+        doc["due"] = isStepTuningDue();
+        JsonArray segments = doc["segments"].to<JsonArray>();
+        for (int i = 0; i < DISPLAY_DIGITS; i++) {
+            const StepTuneResult& r = getStepTuneResult(i);
+            JsonObject o = segments.add<JsonObject>();
+            o["periodUs"] = getStepPeriodUs(i);
+            o["fastestUs"] = r.fastestUs;
+            o["trials"] = r.trials;
+            o["ok"] = r.ok;
+            o["lastErrorSteps"] = r.lastErrorSteps;
+            o["driftSeen"] = r.driftSeen;
+        }
+        sendJson(request, 200, doc);
+    });
+
+    server.on("/api/storage", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_STORAGE);
+        JsonDocument doc(&httpArena);
+        const StorageStats& stats = configManager.getStats();
+        doc["flashWrites"] = stats.flashWrites;
+        doc["skippedWrites"] = stats.skippedWrites;
+        doc["coalescedSaves"] = stats.coalescedSaves;
+        doc["writeErrors"] = stats.writeErrors;
+        doc["lastFlushMicros"] = stats.lastFlushMicros;
+        doc["savePending"] = configManager.isSavePending();
+        EventStoreStats ev = getEventStoreStats();
+        JsonObject events = doc["events"].to<JsonObject>();
+        events["records"] = ev.records;
+        events["oldest"] = ev.oldest;
+        events["newest"] = ev.newest;
+        events["recorded"] = ev.recorded;
+        events["written"] = ev.written;
+        events["dropped"] = ev.dropped;
+        events["writeErrors"] = ev.writeErrors;
+        events["rotations"] = ev.rotations;
+        sendJson(request, 200, doc);
+    });
+
+    // Event history (see EventStore.h):
+    //   /api/events?type=homing&channel=2&from=…&to=…            raw records
+    //   /api/events?type=move&bucket=3600[&field=extra]           hourly count/min/max/mean
+    server.on("/api/events", HTTP_GET, [](AsyncWebServerRequest *request) {
+        static EventQuery query;
+        static char line[96];
+        static size_t lineLen, lineOff;
+        static bool firstRow, finished;
+
+        metricsCountRequest(ROUTE_EVENTS);
+        query = {};
+        query.channel = -1;
+        query.to = UINT32_MAX;
+        if (request->hasParam("type")) {
+            query.type = eventTypeFromName(request->getParam("type")->value().c_str());
+            if (!query.type) {
+                request->send(400, "application/json", "{\"error\":\"Unknown type\"}");
+                return;
+            }
+        }
+        if (request->hasParam("channel")) query.channel = request->getParam("channel")->value().toInt();
+        if (request->hasParam("from")) query.from = strtoul(request->getParam("from")->value().c_str(), NULL, 10);
+        if (request->hasParam("to")) query.to = strtoul(request->getParam("to")->value().c_str(), NULL, 10);
+        if (request->hasParam("bucket")) query.bucketS = strtoul(request->getParam("bucket")->value().c_str(), NULL, 10);
+        query.useExtra = request->hasParam("field") && request->getParam("field")->value() == "extra";
+        if (query.bucketS && !query.type) {
+            request->send(400, "application/json", "{\"error\":\"Buckets need a type\"}");
+            return;
+        }
+        if (!eventQueryBegin(query)) {
+            request->send(503, "application/json", "{\"error\":\"Event store busy or not mounted\"}");
+            return;
+        }
+        request->onDisconnect([]() { eventQueryEnd(); });
+
+        lineLen = snprintf(line, sizeof(line), "{\"type\":\"%s\",\"bucket\":%lu,\"field\":\"%s\",\"%s\":[",
+                           query.type ? eventTypeName(query.type) : "all", (unsigned long)query.bucketS,
+                           query.useExtra ? "extra" : "value", query.bucketS ? "buckets" : "records");
+        lineOff = 0;
+        firstRow = true;
+        finished = false;
+        AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+            [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                size_t n = 0;
+                while (n < maxLen) {
+                    if (lineOff == lineLen) {
+                        if (finished) break;
+                        EventRecord r;
+                        EventBucket b;
+                        const char* sep = firstRow ? "" : ",";
+                        if (!eventQueryNext(r, b)) {
+                            lineLen = snprintf(line, sizeof(line), "]}");
+                            finished = true;
+                        } else if (query.bucketS) {
+                            // [start, count, min, max, mean]
+                            lineLen = snprintf(line, sizeof(line), "%s[%lu,%lu,%ld,%ld,%.1f]", sep,
+                                               (unsigned long)b.start, (unsigned long)b.count, (long)b.min,
+                                               (long)b.max, (double)b.sum / b.count);
+                        } else if (r.channel == EVENT_NO_CHANNEL) {
+                            // [time, type, channel, value, extra]
+                            lineLen = snprintf(line, sizeof(line), "%s[%lu,\"%s\",null,%ld,%ld]", sep,
+                                               (unsigned long)r.time, eventTypeName(r.type),
+                                               (long)r.value, (long)r.extra);
+                        } else {
+                            lineLen = snprintf(line, sizeof(line), "%s[%lu,\"%s\",%u,%ld,%ld]", sep,
+                                               (unsigned long)r.time, eventTypeName(r.type), r.channel,
+                                               (long)r.value, (long)r.extra);
+                        }
+                        firstRow = false;
+                        lineOff = 0;
+                    }
+                    size_t chunk = lineLen - lineOff;
+                    if (chunk > maxLen - n) chunk = maxLen - n;
+                    memcpy(buffer + n, line + lineOff, chunk);
+                    lineOff += chunk;
+                    n += chunk;
+                }
+                return n;
+            });
+        request->send(response);
+    });
+
+    server.on("/api/boot", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_BOOT);
+        JsonDocument doc(&httpArena);
+        doc["complete"] = isBootComplete();
+        JsonArray stages = doc["stages"].to<JsonArray>();
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            const BootStageReport& r = getBootStageReport((BootStageId)i);
+            JsonObject st = stages.add<JsonObject>();
+            st["name"] = r.name;
+            st["background"] = r.background;
+            st["done"] = r.done;
+            st["ok"] = r.ok;
+            st["startMs"] = r.startMs;
+            st["durationMs"] = r.durationMs;
+        }
+        sendJson(request, 200, doc);
+    });
+
+    server.on("/api/clock", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_CLOCK);
+        JsonDocument doc(&httpArena);
+        ClockProvider* active = clockManager.activeSource();
+        doc["active"] = active ? active->name() : "none";
+        doc["lastDrift"] = clockManager.lastDrift();
+        doc["lastDriftMs"] = clockManager.lastDriftMs();
+        doc["disciplineWrites"] = clockManager.disciplineWrites();
+        JsonArray providers = doc["providers"].to<JsonArray>();
+        for (int i = 0; i < clockManager.providerCount(); i++) {
+            ClockProvider* p = clockManager.provider(i);
+            time_t epoch;
+            JsonObject o = providers.add<JsonObject>();
+            o["name"] = p->name();
+            o["quality"] = p->quality();
+            bool valid = p->read(epoch);
+            o["valid"] = valid;
+            if (valid) o["epoch"] = epoch;
+        }
+        sendJson(request, 200, doc);
+    });
+
+    server.on("/api/i2c", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_I2C);
+        JsonDocument doc(&httpArena);
+        const I2CBusStats& bus = i2cBusStats();
+        doc["recoveries"] = bus.recoveries;
+        JsonObject queue = doc["queue"].to<JsonObject>();
+        queue["depth"] = I2C_QUEUE_DEPTH;
+        queue["jobs"] = bus.jobsQueued;
+        queue["highWater"] = bus.queueHighWater;
+        queue["fullWaits"] = bus.queueFullWaits;
+        queue["dropped"] = bus.submitFailures;
+        JsonArray buckets = doc["bucketLimitsUs"].to<JsonArray>();
+        for (int b = 0; b < I2C_HIST_BUCKETS - 1; b++) buckets.add(i2cHistBucketLimit(b));
+        JsonArray devices = doc["devices"].to<JsonArray>();
+        for (int i = 0; i < i2cDeviceCount(); i++) {
+            const I2CDeviceStats& s = i2cDeviceStats(i);
+            JsonObject d = devices.add<JsonObject>();
+            char addr[5];
+            snprintf(addr, sizeof(addr), "0x%02X", s.address);
+            d["address"] = addr;
+            d["transactions"] = s.transactions;
+            d["bytesOut"] = s.bytesOut;
+            d["bytesIn"] = s.bytesIn;
+            d["nacks"] = s.nacks;
+            d["timeouts"] = s.timeouts;
+            d["otherErrors"] = s.otherErrors;
+            d["retries"] = s.retries;
+            d["failures"] = s.failures;
+            d["maxLatencyUs"] = s.maxLatencyUs;
+            JsonArray hist = d["latencyHist"].to<JsonArray>();
+            for (int b = 0; b < I2C_HIST_BUCKETS; b++) hist.add(s.latencyHist[b]);
+        }
+        sendJson(request, 200, doc);
+    });
+
+    // Motion benchmark: results are written to /bench_motion.json
+    server.on("/api/bench/motion", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_BENCH);
+        int from = request->hasParam("from", true) ? request->getParam("from", true)->value().toInt() : DisplayArray::maxValue();
+        int to = request->hasParam("to", true) ? request->getParam("to", true)->value().toInt() : 0;
+        int stride = request->hasParam("stride", true) ? request->getParam("stride", true)->value().toInt() : 1;
+        if (startMotionBenchmarkTask(from, to, stride)) {
+            request->send(202, "application/json", "{\"success\":true, \"result\":\"" MOTION_BENCH_FILE "\"}");
+        } else {
+            request->send(409, "application/json", "{\"error\":\"Motors busy, timer running or not homed\"}");
+        }
+    });
+
+    server.on("/api/bench/motion", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_BENCH);
+        JsonDocument doc(&httpArena);
+        const MotionBenchSummary& sum = getLastMotionBenchSummary();
+        doc["running"] = isMotionBenchmarkRunning();
+        doc["transitions"] = sum.transitions;
+        doc["meanUs"] = sum.transitions ? sum.totalMicros / sum.transitions : 0;
+        doc["maxUs"] = sum.maxMicros;
+        doc["worstFrom"] = sum.worstFrom;
+        doc["totalHalfSteps"] = sum.totalHalfSteps;
+        doc["totalI2c"] = sum.totalI2cTransactions;
+        doc["totalBytes"] = sum.totalI2cBytes;
+        sendJson(request, 200, doc);
+    });
+
     // Новий ендпоінт для скидання цифр на 0
     server.on("/api/reset", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_RESET);
+        if (isMotionLocked()) {
+            request->send(409, "application/json", "{\"error\":\"Motion benchmark running\"}");
+            return;
+        }
         auto& config = configManager.getConfig();
         config.duration.value = 0;
         configManager.save();
         updateAllSegments(0);
-        broadcastState();
+        broadcastTopics(WS_TOPIC_CONFIG | WS_TOPIC_CLOCK);
         request->send(200, "application/json", "{\"success\":true}");
     });
 
     server.on("/api/test", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_TEST);
         if (!request->hasParam("segment", true) || !request->hasParam("value", true)) {
             request->send(400, "application/json", "{\"error\":\"Missing parameters\"}");
             return;
         }
         int segment = request->getParam("segment", true)->value().toInt();
         int value = request->getParam("value", true)->value().toInt();
-        if (segment >= 0 && segment < 4 && value >= 0 && value <= 9) {
-            setSegmentValue(segment, value);
+        if (segment >= 0 && segment < DISPLAY_DIGITS && value >= 0 && value <= 9) {
+            if (!setSegmentValue(segment, value)) {
+                request->send(409, "application/json", "{\"error\":\"Motors busy or not homed\"}");
+                return;
+            }
             request->send(200, "application/json", "{\"success\":true}");
-            broadcastState();   // digits may change (async, but will reflect soon)
+            broadcastTopics(WS_TOPIC_MOTION);   // digits may change (async, but will reflect soon)
         } else {
             request->send(400, "application/json", "{\"error\":\"Invalid parameters\"}");
         }
     });
 
     server.on("/api/testall", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_TESTALL);
         if (!request->hasParam("value", true)) {
             request->send(400, "application/json", "{\"error\":\"Missing value parameter\"}");
             return;
         }
         int value = request->getParam("value", true)->value().toInt();
-        if (value >= 0 && value <= 9999) {
-            setAllSegmentsValue(value);
+        if (value >= 0 && value <= DisplayArray::maxValue()) {
+            if (!setAllSegmentsValue(value)) {
+                request->send(409, "application/json", "{\"error\":\"Motors busy or not homed\"}");
+                return;
+            }
+            request->send(200, "application/json", "{\"success\":true}");
+            broadcastTopics(WS_TOPIC_MOTION);
+        } else {
+            char err[48];
+            snprintf(err, sizeof(err), "{\"error\":\"Invalid value (0-%d)\"}", DisplayArray::maxValue());
+            request->send(400, "application/json", err);
+        }
+    });
+
+    server.on("/api/profiler", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_PROFILER);
+        JsonDocument doc(&httpArena);
+        doc["available"] = isTaskProfilingAvailable();
+        doc["intervalMs"] = PROFILER_INTERVAL_MS;
+
+        JsonArray tasks = doc["tasks"].to<JsonArray>();
+        for (int i = 0; i < getProfiledTaskCount(); i++) {
+            const TaskProfile& t = getTaskProfile(i);
+            JsonObject o = tasks.add<JsonObject>();
+            o["name"] = t.name;
+            o["priority"] = t.priority;
+            o["core"] = t.core;
+            o["state"] = t.state;
+            o["stackFree"] = t.stackHighWater;
+            o["stackFreeMin"] = t.minStackHighWater;
+            o["cpuPermille"] = t.cpuPermille;
+        }
+
+        JsonObject heap = doc["heap"].to<JsonObject>();
+        for (int c = 0; c < 3; c++) {
+            const HeapCapsProfile& h = getHeapProfile(c);
+            JsonObject o = heap[getHeapProfileName(c)].to<JsonObject>();
+            o["free"] = h.totalFree;
+            o["largestBlock"] = h.largestFreeBlock;
+            o["minFree"] = h.minimumEverFree;
+            o["fragmentationPct"] = h.fragmentationPct;
+        }
+
+        JsonArray watched = doc["watchedTasks"].to<JsonArray>();
+        for (int w = 0; w < PROFILER_WATCHED_TASKS; w++) watched.add(getWatchedTaskName(w));
+
+        // History as parallel arrays keeps the document small
+        JsonObject history = doc["history"].to<JsonObject>();
+        JsonArray uptime = history["uptimeMs"].to<JsonArray>();
+        JsonArray internalFree = history["internalFree"].to<JsonArray>();
+        JsonArray internalLargest = history["internalLargest"].to<JsonArray>();
+        JsonArray psramFree = history["psramFree"].to<JsonArray>();
+        JsonArray cpu = history["cpuPermille"].to<JsonArray>();
+        for (int i = 0; i < getProfilerHistoryCount(); i++) {
+            const ProfilerSample& s = getProfilerSample(i);
+            uptime.add(s.uptimeMs);
+            internalFree.add(s.internalFree);
+            internalLargest.add(s.internalLargest);
+            psramFree.add(s.psramFree);
+            JsonArray row = cpu.add<JsonArray>();
+            for (int w = 0; w < PROFILER_WATCHED_TASKS; w++) row.add(s.cpuPermille[w]);
+        }
+
+        sendJson(request, 200, doc);
+    });
+
+    // Step‑timing trace: start/stop capture, per‑move jitter summary and
+    // raw export (?format=csv or ?format=bin). Export needs a stopped trace.
+    server.on("/api/trace/start", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_TRACE);
+        if (startStepTrace()) {
+            request->send(200, "application/json", "{\"success\":true}");
+        } else {
+            request->send(507, "application/json", "{\"error\":\"No memory for trace buffer\"}");
+        }
+    });
+
+    server.on("/api/trace/stop", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_TRACE);
+        stopStepTrace();
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+
+    server.on("/api/trace", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_TRACE);
+        JsonDocument doc(&httpArena);
+        doc["running"] = (bool)stepTraceEnabled;
+        doc["events"] = getTraceEventCount();
+        doc["capacity"] = getTraceCapacity();
+        doc["overwritten"] = getTraceOverwritten();
+        JsonArray moves = doc["moves"].to<JsonArray>();
+        for (int i = 0; i < getTraceMoveCount(); i++) {
+            const TraceMoveSummary& m = getTraceMove(i);
+            JsonObject o = moves.add<JsonObject>();
+            o["startUs"] = m.startUs;
+            o["segment"] = m.segment;
+            o["target"] = m.target;
+            o["steps"] = m.steps;
+            o["p50Us"] = m.p50Us;
+            o["p95Us"] = m.p95Us;
+            o["p99Us"] = m.p99Us;
+            o["maxUs"] = m.maxUs;
+            o["maxFlushUs"] = m.maxFlushUs;
+        }
+        sendJson(request, 200, doc);
+    });
+
+    server.on("/api/trace/data", HTTP_GET, [](AsyncWebServerRequest *request) {
+        static volatile bool exportBusy = false;
+        static uint32_t nextEvent;
+        static char line[48];
+        static size_t lineLen, lineOff;
+
+        metricsCountRequest(ROUTE_TRACE);
+        if (stepTraceEnabled) {
+            request->send(409, "application/json", "{\"error\":\"Stop the trace first\"}");
+            return;
+        }
+        if (exportBusy) {
+            request->send(503, "application/json", "{\"error\":\"Export in progress\"}");
+            return;
+        }
+        exportBusy = true;
+        request->onDisconnect([]() { exportBusy = false; });
+        uint32_t count = getTraceEventCount();
+
+        if (request->hasParam("format") && request->getParam("format")->value() == "bin") {
+            // 16‑byte header: magic, version, record size, count, overwritten
+            static uint8_t header[16];
+            uint32_t magic = TRACE_BIN_MAGIC, overwritten = getTraceOverwritten();
+            uint16_t version = 1, recSize = sizeof(TraceEvent);
+            memcpy(header, &magic, 4);
+            memcpy(header + 4, &version, 2);
+            memcpy(header + 6, &recSize, 2);
+            memcpy(header + 8, &count, 4);
+            memcpy(header + 12, &overwritten, 4);
+            size_t total = sizeof(header) + (size_t)count * sizeof(TraceEvent);
+
+            AsyncWebServerResponse *response = request->beginResponse(
+                "application/octet-stream", total,
+                [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                    size_t n = 0;
+                    while (n < maxLen) {
+                        size_t pos = index + n;
+                        if (pos < sizeof(header)) {
+                            buffer[n++] = header[pos];
+                            continue;
+                        }
+                        size_t rec = (pos - sizeof(header)) / sizeof(TraceEvent);
+                        size_t off = (pos - sizeof(header)) % sizeof(TraceEvent);
+                        if (rec >= getTraceEventCount()) break;
+                        size_t chunk = sizeof(TraceEvent) - off;
+                        if (chunk > maxLen - n) chunk = maxLen - n;
+                        memcpy(buffer + n, (const uint8_t*)&getTraceEvent(rec) + off, chunk);
+                        n += chunk;
+                    }
+                    return n;
+                });
+            response->addHeader("Content-Disposition", "attachment; filename=steptrace.bin");
+            request->send(response);
+            return;
+        }
+
+        static const char* const TYPE_NAMES[] = {"", "step", "flush", "hall", "move_begin", "move_end"};
+        nextEvent = 0;
+        lineLen = snprintf(line, sizeof(line), "t_us,type,segment,value\n");
+        lineOff = 0;
+        AsyncWebServerResponse *response = request->beginChunkedResponse("text/csv",
+            [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                size_t n = 0;
+                while (n < maxLen) {
+                    if (lineOff == lineLen) {
+                        if (nextEvent >= getTraceEventCount()) break;
+                        const TraceEvent& e = getTraceEvent(nextEvent++);
+                        lineLen = snprintf(line, sizeof(line), "%lu,%s,%u,%u\n",
+                                           (unsigned long)e.timestampUs,
+                                           e.type <= TRACE_MOVE_END ? TYPE_NAMES[e.type] : "?",
+                                           e.segment, e.value);
+                        lineOff = 0;
+                    }
+                    size_t chunk = lineLen - lineOff;
+                    if (chunk > maxLen - n) chunk = maxLen - n;
+                    memcpy(buffer + n, line + lineOff, chunk);
+                    lineOff += chunk;
+                    n += chunk;
+                }
+                return n;
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=steptrace.csv");
+        request->send(response);
+    });
+
+    // Scheduling jitter at the motion task's placement. Start a probe,
+    // load the server (HTTP/WebSocket) meanwhile, then read the result.
+    server.on("/api/jitter", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_JITTER);
+        uint32_t ms = request->hasParam("ms", true) ? request->getParam("ms", true)->value().toInt() : 10000;
+        if (startJitterProbe(ms)) {
+            request->send(202, "application/json", "{\"success\":true}");
+        } else {
+            request->send(409, "application/json", "{\"error\":\"Probe busy, motors moving or ms not in 100..60000\"}");
+        }
+    });
+
+    server.on("/api/jitter", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_JITTER);
+        JsonDocument doc(&httpArena);
+        const JitterProbeResult& r = getJitterProbeResult();
+        doc["running"] = isJitterProbeRunning();
+        doc["durationMs"] = r.durationMs;
+        doc["samples"] = r.samples;
+        doc["nominalUs"] = 1000;
+        doc["p50Us"] = r.p50Us;
+        doc["p99Us"] = r.p99Us;
+        doc["p999Us"] = r.p999Us;
+        doc["maxUs"] = r.maxUs;
+        doc["httpRequests"] = r.httpRequests;
+        doc["wsFrames"] = r.wsFrames;
+
+        JsonArray plan = doc["plan"].to<JsonArray>();
+        for (int i = 0; i < TASK_ROLE_COUNT; i++) {
+            const TaskPlacement& p = getTaskPlacement((TaskRole)i);
+            JsonObject o = plan.add<JsonObject>();
+            o["task"] = p.name;
+            o["core"] = p.core;
+            o["priority"] = p.priority;
+            o["stack"] = p.stackSize;
+        }
+        sendJson(request, 200, doc);
+    });
+
+    // Multi‑display sync: role and lock status (see DisplaySync.h)
+    server.on("/api/group", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_GROUP);
+        if (!request->hasParam("role", true)) {
+            request->send(400, "application/json", "{\"error\":\"Missing role (off, leader, follower)\"}");
+            return;
+        }
+        String role = request->getParam("role", true)->value();
+        SyncRole r;
+        if (role == "off") r = SYNC_OFF;
+        else if (role == "leader") r = SYNC_LEADER;
+        else if (role == "follower") r = SYNC_FOLLOWER;
+        else {
+            request->send(400, "application/json", "{\"error\":\"Unknown role\"}");
+            return;
+        }
+        if (setDisplaySyncRole(r)) {
             request->send(200, "application/json", "{\"success\":true}");
-            broadcastState();
         } else {
-            request->send(400, "application/json", "{\"error\":\"Invalid value (0-9999)\"}");
+            request->send(500, "application/json", "{\"error\":\"Cannot open sync socket\"}");
         }
     });
 
+    server.on("/api/group", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_GROUP);
+        JsonDocument doc(&httpArena);
+        const SyncStatus& s = getSyncStatus();
+        char id[9];
+        doc["role"] = getSyncRoleName(s.role);
+        doc["running"] = s.running;
+        doc["locked"] = s.locked;
+        snprintf(id, sizeof(id), "%08X", (unsigned)s.unitId);
+        doc["unitId"] = id;
+        snprintf(id, sizeof(id), "%08X", (unsigned)s.leaderId);
+        doc["leaderId"] = id;
+        doc["offsetUs"] = s.lastOffsetUs;
+        doc["rttUs"] = s.lastRttUs;
+        doc["clockSteps"] = s.clockSteps;
+        doc["beaconsSent"] = s.beaconsSent;
+        doc["beaconsReceived"] = s.beaconsReceived;
+        doc["exchanges"] = s.exchanges;
+        doc["configApplied"] = s.configApplied;
+        doc["packetsRejected"] = s.packetsRejected;
+        doc["nextFlipMs"] = s.nextFlipUs / 1000;
+        doc["flipsFired"] = s.flipsFired;
+        doc["maxFlipLateUs"] = s.maxFlipLateUs;
+
+        JsonArray flips = doc["flips"].to<JsonArray>();
+        for (int i = 0; i < getSyncFlipCount(); i++) {
+            const SyncFlip& f = getSyncFlip(i);
+            JsonObject o = flips.add<JsonObject>();
+            o["value"] = f.value;
+            o["atMs"] = f.scheduledUs / 1000;
+            o["lateUs"] = f.lateUs;
+        }
+        sendJson(request, 200, doc);
+    });
+
+    // Time‑warp of the countdown clock (see TimeWarp.h): factor=N,
+    // jump=1 (to the next value change) or reset=1
+    server.on("/api/warp", HTTP_POST, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_WARP);
+        bool ok;
+        if (request->hasParam("reset", true)) {
+            resetTimeWarp();
+            ok = true;
+        } else if (request->hasParam("jump", true)) {
+            ok = warpToNextBoundary();
+        } else if (request->hasParam("factor", true)) {
+            long factor = request->getParam("factor", true)->value().toInt();
+            ok = factor >= 1 && setTimeWarp((uint32_t)factor);
+        } else {
+            request->send(400, "application/json", "{\"error\":\"Missing factor, jump or reset\"}");
+            return;
+        }
+        if (!ok) {
+            request->send(409, "application/json",
+                          "{\"error\":\"Rejected (factor out of range, timer not running or unit in a sync group)\"}");
+            return;
+        }
+        broadcastTopics(WS_TOPIC_CLOCK);
+        request->send(200, "application/json", "{\"success\":true}");
+    });
+
+    server.on("/api/warp", HTTP_GET, [](AsyncWebServerRequest *request) {
+        metricsCountRequest(ROUTE_WARP);
+        JsonDocument doc(&httpArena);
+        TimeWarpStatus w = getTimeWarpStatus();
+        const MotionStats& m = getMotionStats();
+        doc["active"] = w.active;
+        doc["factor"] = w.factor;
+        doc["leadMs"] = w.leadUs / 1000;
+        doc["jumps"] = w.jumps;
+        doc["now"] = (long long)warpTime();
+        doc["valuesSkipped"] = m.valuesSkipped;
+        doc["targetsReplaced"] = m.targetsReplaced;
+        sendJson(request, 200, doc);
+    });
+
+    // Prometheus scrape endpoint. Rendered into a buffer reserved at boot
+    // (PSRAM); one scrape at a time – a concurrent scrape gets 503 and
+    // retries next interval.
+    server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+        static volatile bool metricsBusy = false;
+
+        metricsCountRequest(ROUTE_METRICS);
+        if (metricsBuffer == NULL) {
+            request->send(503, "text/plain", "no buffer\n");
+            return;
+        }
+        if (metricsBusy) {
+            request->send(503, "text/plain", "busy\n");
+            return;
+        }
+        metricsBusy = true;
+        size_t len = renderMetrics(metricsBuffer, METRICS_BUFFER_SIZE);
+
+        AsyncWebServerResponse *response = request->beginResponse(
+            "text/plain; version=0.0.4", len,
+            [len](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                size_t n = len - index;
+                if (n > maxLen) n = maxLen;
+                memcpy(buffer, metricsBuffer + index, n);
+                return n;
+            });
+        request->onDisconnect([]() { metricsBusy = false; });
+        request->send(response);
+    });
+
     // Serve static files from LittleFS
     server.serveStatic("/", LittleFS, "/")
           .setDefaultFile("index.html")
           .setTryGzipFirst(false)
           .setFilter([](AsyncWebServerRequest *request) {
-              return !request->url().startsWith("/api");
+              return !request->url().startsWith("/api") && request->url() != "/metrics";
           });
 
     server.begin();
@@ -0,0 +1,60 @@
+#ifndef WS_TOPICS_H
+#define WS_TOPICS_H
+
+#include <Arduino.h>
+
+/**
+ * @file WsTopics.h
+ * Topics of the /ws state channel.
+ *
+ * A client picks what it shows by sending
+ *   {"subscribe":["clock","motion"]}     (replaces the current set)
+ *   {"unsubscribe":["config"]}
+ * and is answered with {"topics":[…]} followed by one frame with the
+ * current values of every subscribed topic. After that it only receives
+ * frames for its topics, each carrying just those topics' fields of the
+ * /api/state document. A client that never subscribes keeps getting the
+ * full state document on every change.
+ *
+ * Clock frames carry the countdown clock ("epoch") so the client can run
+ * the clock itself; the server sends them on clock events (start/stop,
+ * NTP, warp) and as a resync every WS_CLOCK_RESYNC_MS.
+ */
+
+enum WsTopic : uint8_t {
+    WS_TOPIC_CLOCK       = 1 << 0,  // time, remaining, running/stopped
+    WS_TOPIC_MOTION      = 1 << 1,  // digits on the drums
+    WS_TOPIC_CONFIG      = 1 << 2,  // duration, start moment, sync settings
+    WS_TOPIC_CALIBRATION = 1 << 3,  // homing state
+    WS_TOPIC_METRICS     = 1 << 4,  // counters, every WS_METRICS_INTERVAL_MS
+};
+
+#define WS_TOPIC_COUNT          5
+#define WS_TOPIC_STATE          (WS_TOPIC_CLOCK | WS_TOPIC_MOTION | WS_TOPIC_CONFIG | WS_TOPIC_CALIBRATION)
+#define WS_CLOCK_RESYNC_MS      60000
+#define WS_METRICS_INTERVAL_MS  5000
+
+inline const char* wsTopicName(int index) {
+    static const char* const names[WS_TOPIC_COUNT] = {
+        "clock", "motion", "config", "calibration", "metrics"
+    };
+    return index >= 0 && index < WS_TOPIC_COUNT ? names[index] : "?";
+}
+
+/** Topic bit for a name, 0 if unknown. */
+inline uint8_t wsTopicFromName(const char* name) {
+    if (name == NULL) return 0;
+    for (int i = 0; i < WS_TOPIC_COUNT; i++) {
+        if (strcmp(name, wsTopicName(i)) == 0) return (uint8_t)(1 << i);
+    }
+    return 0;
+}
+
+/**
+ * Request frames for the given topics. Safe from any task; requests
+ * collapse until the loop task sends them (serviceBroadcasts()).
+ * broadcastState() is broadcastTopics(WS_TOPIC_STATE).
+ */
+void broadcastTopics(uint8_t topics);
+
+#endif
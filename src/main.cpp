@@ -15,60 +15,33 @@
 
 #include "ConfigManager.h"
 #include "SegmentController.h"
+#include "BootSequence.h"
+#include "TaskProfiler.h"
+#include "DisplaySync.h"
+#include "EventStore.h"
+#include "Log.h"
 
 // Global config manager instance
 ConfigManager configManager;
 
-// External functions from other modules
-void setupLittleFS();
-void setupWiFi();
-void setupMDNS();
-void setupWebServer();
-void setupSegmentController();
-void setupTimerController();
-
-// External variables (declared elsewhere)
-extern bool timerStopped;
-extern AsyncWebServer server;
-extern WiFiManager wm;
-
 // External update functions
 extern void updateTimer();          // from SegmentController.cpp
 extern void updateTimerController(); // from TimerController.cpp
+extern void serviceBroadcasts();     // from WebServices.cpp
 
 /**
  * Arduino setup – runs once at startup.
+ * Display and countdown come up first from persisted state; WiFi, mDNS,
+ * NTP and the web server start in background tasks (see BootSequence).
  */
 void setup() {
     Serial.begin(115200);
     delay(500);
 
-    // Initialize I2C for PCF8575 and DS3231
-    Wire.begin(8, 9);
-    Wire.setClock(400000);
-
-    // Mount LittleFS for web files
-    setupLittleFS();
-    setupWiFi();                     // WiFiManager portal if needed
-
-    // Load configuration from NVS
-    configManager.begin();
-    configManager.load();
-
-    // mDNS for http://timer.local
-    setupMDNS();
-
-    // Initialize hardware controllers
-    setupSegmentController();        // motors, Hall sensors, PCFs
-    setupTimerController();          // NTP, timer logic
-
-    // Start web server with REST API and WebSocket
-    setupWebServer();
+    setupLogging();                  // deferred log drain task
+    runBootSequence();
 
-    Serial.println("Setup complete!");
-    Serial.print("Open: http://");
-    Serial.println(WiFi.localIP());
-    Serial.println("Or: http://timer.local");
+    Serial.println("Setup complete – network starting in background");
 }
 
 /**
@@ -76,6 +49,11 @@ void setup() {
  */
 void loop() {
     updateTimer();                   // checks if timer needs to move digits
+    updateDisplaySync();             // multi‑display beacons and scheduled flips
     updateTimerController();         // NTP sync, auto‑sync logic
+    configManager.update();          // deferred NVS writes
+    serviceBroadcasts();             // pending WebSocket state frame
+    serviceEventStore();             // batched event history writes
+    updateTaskProfiler();            // task/heap sampling every 5 s
     delay(10);                       // small yield
 }
\ No newline at end of file
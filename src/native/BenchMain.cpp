@@ -0,0 +1,50 @@
+/**
+ * @file BenchMain.cpp
+ * Native motion benchmark: replays countdown transitions against the
+ * simulated expanders and writes the JSON report to stdout.
+ *
+ *   pio run -e native_bench && .pio/build/native_bench/program [from] [to] [stride] > bench.json
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <HalSim.h>
+
+#include "../ConfigManager.h"
+#include "../SegmentController.h"
+#include "../I2CBus.h"
+#include "../MotionBenchmark.h"
+
+ConfigManager configManager;
+
+void broadcastState() {}
+void broadcastTopics(uint8_t) {}
+
+static void stdoutSink(const char* text, void*) {
+    fputs(text, stdout);
+}
+
+int main(int argc, char** argv) {
+    int from = argc > 1 ? atoi(argv[1]) : 9999;
+    int to = argc > 2 ? atoi(argv[2]) : 0;
+    int stride = argc > 3 ? atoi(argv[3]) : 1;
+
+    halResetClock();
+    halAttachSimulatedBoard();
+    Serial.setEcho(false);           // keep stdout pure JSON
+
+    i2cBusBegin(8, 9, 400000);
+    configManager.begin();
+    setupSegmentController();
+
+    MotionBenchSummary summary;
+    if (!runMotionBenchmark(from, to, stride, stdoutSink, nullptr, &summary)) {
+        fprintf(stderr, "invalid range or motors not homed\n");
+        return 1;
+    }
+    fprintf(stderr, "%u transitions, mean %llu us, max %u us (from %d)\n",
+            summary.transitions,
+            (unsigned long long)(summary.totalMicros / (summary.transitions ? summary.transitions : 1)),
+            summary.maxMicros, summary.worstFrom);
+    return 0;
+}
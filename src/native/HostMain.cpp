@@ -0,0 +1,194 @@
+/**
+ * @file HostMain.cpp
+ * Native (Linux) entry point: runs the firmware logic against the
+ * simulated board on the virtual clock.
+ *
+ *   pio run -e native && .pio/build/native/program [seconds] [countdown] [metrics|trace|warp [factor]|tune|events [dir]]
+ *
+ * Boots like setup() does (minus the network), starts a countdown in
+ * seconds and drives loop() for the requested virtual time, then prints
+ * what the drums show and the I2C/NVS cost. With "metrics" as the third
+ * argument the /metrics page is printed as well; with "trace" the step
+ * trace runs from boot and the per‑move jitter summary is printed. With
+ * "warp" the countdown is in days and runs on the time‑warp clock
+ * (default 86400×, one day per second); the warp status and the
+ * values skipped because moves could not keep up are printed. With
+ * "tune" the four drums get different pull‑out limits, a step‑rate
+ * tuning runs before the countdown, and the tuned periods and any steps
+ * lost during the countdown are printed. With "events" the event history
+ * is kept in a local directory (default ./events, kept across runs) and
+ * the homing records and 10 s move‑duration buckets are printed.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Preferences.h>
+#include <HalSim.h>
+
+#include "../ConfigManager.h"
+#include "../SegmentController.h"
+#include "../I2CBus.h"
+#include "../TimerController.h"
+#include "../ClockManager.h"
+#include "../Metrics.h"
+#include "../StepTrace.h"
+#include "../DeviceState.h"
+#include "../TimeWarp.h"
+#include "../StepTuner.h"
+#include "../EventStore.h"
+
+// Global config manager instance (main.cpp is not part of the native build)
+ConfigManager configManager;
+
+// No web server on the host – nothing to broadcast to
+void broadcastState() {}
+void broadcastTopics(uint8_t) {}
+
+extern void updateTimer();
+extern void updateTimerController();
+
+int main(int argc, char** argv) {
+    long runSeconds = argc > 1 ? atol(argv[1]) : 30;
+    int countdown = argc > 2 ? atoi(argv[2]) : 20;
+    const char* mode = argc > 3 ? argv[3] : "";
+    bool warp = strcmp(mode, "warp") == 0;
+    bool events = strcmp(mode, "events") == 0;
+    uint32_t warpFactor = argc > 4 ? (uint32_t)atol(argv[4]) : 86400;
+
+    halResetClock();
+    SimBoard& board = halAttachSimulatedBoard();
+    board.rtc.setTime(1767261600);           // 2026‑01‑01 10:00:00
+
+    // Same order as the local boot stages
+    i2cBusBegin(8, 9, 400000);
+    configManager.begin();
+    configManager.load();
+    clockManager.addProvider(&rtcClock);
+    clockManager.seedSystemClock();
+    if (events) {
+        recordEvent(EVT_BOOT, EVENT_NO_CHANNEL, 0);
+        setupEventStore(argc > 4 ? argv[4] : "events");
+    }
+    if (strcmp(mode, "trace") == 0) startStepTrace();
+    setupSegmentController();
+    setupTimerController();
+
+    // Mechanically different drums: pull‑out limit per segment (µs)
+    const uint32_t pullOutUs[4] = {520, 700, 900, 1250};
+    uint32_t lostInTuning[4] = {};
+    if (strcmp(mode, "tune") == 0) {
+        for (int i = 0; i < 4; i++) board.segment(i).minStepUs = pullOutUs[i];
+        startStepTuning();
+        for (int i = 0; i < 4; i++) lostInTuning[i] = board.segment(i).lostSteps;
+    }
+
+    // Countdown in seconds (days under warp) starting now
+    TimerConfig& config = configManager.getConfig();
+    config.startTime = time(nullptr);
+    config.duration.value = countdown;
+    config.duration.unit = warp ? UNIT_DAYS : UNIT_SECONDS;
+    configManager.save();
+    if (warp && !setTimeWarp(warpFactor)) {
+        printf("warp factor %u out of range\n", (unsigned)warpFactor);
+        return 1;
+    }
+    startTimer();
+
+    unsigned long endMs = millis() + (unsigned long)runSeconds * 1000UL;
+    while (millis() < endMs) {
+        updateTimer();
+        updateTimerController();
+        configManager.update();
+        serviceEventStore();
+        delay(10);
+    }
+
+    DeviceSnapshot state = deviceState.snapshot();
+    printf("\n=== native run: %ld s virtual ===\n", runSeconds);
+    printf("displayed      : %d%d%d%d (remaining %d)\n",
+           state.digits[0], state.digits[1], state.digits[2], state.digits[3],
+           configManager.getCurrentValueRemaining());
+    for (int i = 0; i < 4; i++) {
+        const SimMotor& m = board.segment(i);
+        printf("segment %d drum : position %4d, half-steps %7u, skipped %u\n",
+               i, m.position, m.halfSteps, m.skippedPhases);
+    }
+    const uint8_t addrs[3] = {0x20, 0x21, 0x68};
+    for (uint8_t a : addrs) {
+        const HalI2cStats& s = halI2cStats(a);
+        printf("i2c 0x%02X       : %u writes, %u reads, %u bytes out, %u bytes in\n",
+               a, s.writeTransactions, s.readTransactions, s.bytesWritten, s.bytesRead);
+    }
+    printf("nvs writes     : %u\n", halNvsWriteCount());
+
+    if (strcmp(mode, "tune") == 0) {
+        printf("\nseg pull-out  period  fastest  trials  ok  lost(tuning)  lost(countdown)\n");
+        for (int i = 0; i < 4; i++) {
+            const StepTuneResult& r = getStepTuneResult(i);
+            printf("%3d %8u %7u %8u %7u %3d %13u %16u\n", i, (unsigned)pullOutUs[i],
+                   (unsigned)getStepPeriodUs(i), (unsigned)r.fastestUs, (unsigned)r.trials, r.ok ? 1 : 0,
+                   (unsigned)lostInTuning[i], (unsigned)(board.segment(i).lostSteps - lostInTuning[i]));
+        }
+    }
+
+    if (warp) {
+        TimeWarpStatus w = getTimeWarpStatus();
+        const MotionStats& m = getMotionStats();
+        printf("\nwarp           : %ux, lead %lld s, jumps %u\n", (unsigned)w.factor,
+               (long long)(w.leadUs / 1000000), (unsigned)w.jumps);
+        printf("moves          : %u completed, %u values skipped\n",
+               (unsigned)m.movesCompleted, (unsigned)m.valuesSkipped);
+        printf("timer          : %s\n", isTimerStopped() ? "finished" : "running");
+    }
+
+    if (strcmp(mode, "trace") == 0) {
+        stopStepTrace();
+        printf("\ntrace events   : %u (overwritten %u)\n",
+               getTraceEventCount(), getTraceOverwritten());
+        printf("seg target steps   p50   p95   p99   max flushMax (us)\n");
+        for (int i = 0; i < getTraceMoveCount(); i++) {
+            const TraceMoveSummary& m = getTraceMove(i);
+            printf("%3u %6u %5u %5u %5u %5u %5u %9u\n", m.segment, m.target, m.steps,
+                   m.p50Us, m.p95Us, m.p99Us, m.maxUs, m.maxFlushUs);
+        }
+    }
+
+    if (events) {
+        serviceEventStore(true);
+        EventStoreStats ev = getEventStoreStats();
+        printf("\nevents         : %u on flash (%u … %u), %u written, %u dropped, %u rotations\n",
+               (unsigned)ev.records, (unsigned)ev.oldest, (unsigned)ev.newest, (unsigned)ev.written,
+               (unsigned)ev.dropped, (unsigned)ev.rotations);
+        EventRecord r;
+        EventBucket b;
+        EventQuery q = {};
+        q.type = EVT_HOMING;
+        q.channel = -1;
+        q.to = UINT32_MAX;
+        printf("time        seg  hall step  ms\n");
+        if (eventQueryBegin(q)) {
+            while (eventQueryNext(r, b)) {
+                printf("%u %3u %10d %5d\n", (unsigned)r.time, r.channel, (int)r.value, (int)r.extra);
+            }
+            eventQueryEnd();
+        }
+        q.type = EVT_MOVE;
+        q.bucketS = 10;
+        q.useExtra = true;
+        printf("bucket      moves  min ms  max ms  mean ms\n");
+        if (eventQueryBegin(q)) {
+            while (eventQueryNext(r, b)) {
+                printf("%u %5u %7d %7d %8.1f\n", (unsigned)b.start, (unsigned)b.count,
+                       (int)b.min, (int)b.max, (double)b.sum / b.count);
+            }
+            eventQueryEnd();
+        }
+    }
+
+    if (strcmp(mode, "metrics") == 0) {
+        static char metrics[16384];
+        size_t len = renderMetrics(metrics, sizeof(metrics));
+        printf("\n%.*s", (int)len, metrics);
+    }
+    return 0;
+}
@@ -0,0 +1,748 @@
+/**
+ * @file LoadMain.cpp
+ * API load generator and traffic replay. Plain POSIX host tool: it talks
+ * HTTP/WebSocket to a running device (or anything serving the same API)
+ * and reports what the web layer does under many open dashboards. The
+ * native firmware build has no web layer (WebServices.cpp needs
+ * AsyncWebServer), so the target is a device on the LAN.
+ *
+ *   pio run -e native_load && .pio/build/native_load/program <host[:port]> [options]
+ *
+ *   --ws N            WebSocket clients on /ws (default 4)
+ *   --topics LIST     /ws clients subscribe to these topics, e.g.
+ *                     clock,motion (default: none sent, full state frames)
+ *   --poll M          polling tabs, GET /api/state every --interval (default 2)
+ *   --interval MS     poll period of one tab (default 1000, as script.js)
+ *   --duration S      run time (default 30)
+ *   --replay FILE     replay a recorded request sequence (see below)
+ *   --replayers K     concurrent replay sessions (default 1)
+ *   --sample MS       server probe period (default 5000)
+ *   --json            JSON report on stdout, summary on stderr
+ *
+ * Load shape follows the dashboard: each tab fires on a fixed period
+ * whether or not its previous request finished (setInterval + fetch), a
+ * dropped WebSocket reconnects after 3 s. HTTP requests use a fresh
+ * connection each (Connection: close).
+ *
+ * Report:
+ *   - per route: count, errors (non‑2xx, reset, 10 s timeout), latency
+ *     p50/p90/p99/max from connect to last byte;
+ *   - throughput: completed requests/s and bytes/s;
+ *   - WebSocket: frames and bytes per client, reconnects, time from
+ *     connect to the first state frame, and the fan‑out spread of each
+ *     broadcast (last − first arrival of the same frame across clients);
+ *   - server: free heap and largest block (start/min/end) and dropped WS
+ *     frames from /metrics, CPU busy share from /api/profiler (1000 − the
+ *     IDLE tasks' permille). Probe requests are not in the route table.
+ *
+ * Replay file: one request per line, "<ms> <METHOD> <path> [body]", with
+ * <ms> the offset from session start; '#' starts a comment. A body that
+ * starts with '{' is sent as JSON, anything else as a form. Sessions loop
+ * until the run ends. To replay a browser session, save it as HAR from
+ * the developer tools (UTC "Z" timestamps) and convert the API calls:
+ *
+ *   jq -r 'def ms: (.[0:19] + "Z" | fromdate) * 1000 + (.[20:23] | tonumber);
+ *     .log.entries | (.[0].startedDateTime | ms) as $t0 | .[]
+ *     | select(.request.url | test("/api/"))
+ *     | "\((.startedDateTime | ms) - $t0) \(.request.method) \(.request.url | sub("^[a-z]+://[^/]+"; "")) \(.request.postData.text // "")"' \
+ *     session.har > session.txt
+ *
+ * src/native/replay/dashboard.txt is a hand‑written sample: page load,
+ * a config save and a start/stop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#define HTTP_TIMEOUT_US     10000000LL
+#define WS_RECONNECT_US     3000000LL
+#define MAX_CONNECTIONS     1024
+#define MAX_REPLAY_LINES    4096
+
+static int64_t nowUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// -------------------------------------------------------------------
+// Options and recorded sequence
+// -------------------------------------------------------------------
+struct Options {
+    std::string host;
+    std::string port = "80";
+    int wsClients = 4;
+    int pollTabs = 2;
+    int pollMs = 1000;
+    int seconds = 30;
+    const char* replayFile = nullptr;
+    int replayers = 1;
+    int sampleMs = 5000;
+    bool json = false;
+    std::string topics;             // comma separated, empty = legacy client
+};
+
+struct ReplayLine {
+    int64_t atUs;
+    std::string method;
+    std::string path;
+    std::string body;
+};
+
+static bool loadReplay(const char* file, std::vector<ReplayLine>& lines) {
+    FILE* f = fopen(file, "r");
+    if (!f) return false;
+    char buf[2048];
+    while (fgets(buf, sizeof(buf), f) && lines.size() < MAX_REPLAY_LINES) {
+        char* hash = strchr(buf, '#');
+        if (hash) *hash = '\0';
+        buf[strcspn(buf, "\r\n")] = '\0';
+        long ms;
+        char method[16], path[512];
+        int used = 0;
+        if (sscanf(buf, "%ld %15s %511s %n", &ms, method, path, &used) < 3) continue;
+        ReplayLine l;
+        l.atUs = (int64_t)ms * 1000;
+        l.method = method;
+        l.path = path;
+        l.body = used ? buf + used : "";
+        lines.push_back(l);
+    }
+    fclose(f);
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const ReplayLine& a, const ReplayLine& b) { return a.atUs < b.atUs; });
+    return !lines.empty();
+}
+
+// -------------------------------------------------------------------
+// Statistics
+// -------------------------------------------------------------------
+struct RouteStats {
+    std::string name;           // "GET /api/state"
+    std::vector<uint32_t> latencyUs;
+    uint32_t errors = 0;
+    uint64_t bytes = 0;
+};
+
+struct WsClientStats {
+    uint32_t frames = 0;
+    uint64_t bytes = 0;
+    uint32_t connects = 0;
+    uint32_t closes = 0;
+    std::map<uint64_t, int> seen;        // frame hash → occurrences so far
+};
+
+struct Broadcast {
+    int64_t firstUs;
+    int64_t lastUs;
+    int clients;
+};
+
+struct ServerSample {
+    bool haveHeap = false;
+    uint32_t heapFreeMin = UINT32_MAX, largestBlockMin = UINT32_MAX;
+    uint32_t heapFreeStart = 0, heapFreeEnd = 0;
+    uint32_t wsDroppedStart = 0, wsDroppedEnd = 0;
+    bool haveDropped = false;
+    std::vector<uint32_t> cpuBusyPermille;
+};
+
+static std::vector<RouteStats> routes;
+static std::map<std::string, int> routeIndex;
+static std::vector<WsClientStats> wsStats;
+static std::map<std::pair<uint64_t, int>, Broadcast> broadcasts;
+static std::vector<uint32_t> firstFrameUs;
+static ServerSample server;
+
+static int routeFor(const std::string& method, const std::string& path) {
+    std::string key = method + " " + path.substr(0, path.find('?'));
+    auto it = routeIndex.find(key);
+    if (it != routeIndex.end()) return it->second;
+    RouteStats r;
+    r.name = key;
+    routes.push_back(r);
+    routeIndex[key] = (int)routes.size() - 1;
+    return (int)routes.size() - 1;
+}
+
+static uint32_t percentile(std::vector<uint32_t>& v, double q) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)(q * v.size() + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > v.size()) rank = v.size();
+    return v[rank - 1];
+}
+
+static uint64_t fnv1a(const char* p, size_t n) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < n; i++) h = (h ^ (uint8_t)p[i]) * 1099511628211ULL;
+    return h;
+}
+
+// -------------------------------------------------------------------
+// Connections (non‑blocking, one poll() loop)
+// -------------------------------------------------------------------
+enum ConnKind : uint8_t { CONN_HTTP, CONN_WS };
+enum Probe : uint8_t { PROBE_NONE, PROBE_METRICS, PROBE_PROFILER };
+
+struct Conn {
+    int fd = -1;
+    ConnKind kind = CONN_HTTP;
+    bool writable = false;
+    std::string out;
+    size_t outPos = 0;
+    std::string in;
+    int64_t startUs = 0;
+    // HTTP
+    int route = -1;
+    Probe probe = PROBE_NONE;
+    // WebSocket
+    int wsClient = -1;
+    bool upgraded = false;
+    bool gotFirst = false;
+};
+
+static Options opt;
+static struct addrinfo* target = nullptr;
+static std::vector<Conn> conns(MAX_CONNECTIONS);
+static std::vector<int64_t> wsReconnectAt;
+static uint64_t bytesIn = 0;
+static uint32_t completed = 0;
+static uint32_t connectFailures = 0;
+
+static Conn* openConn(ConnKind kind) {
+    for (Conn& c : conns) {
+        if (c.fd >= 0) continue;
+        int fd = socket(target->ai_family, SOCK_STREAM, 0);
+        if (fd < 0) return nullptr;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(fd, target->ai_addr, target->ai_addrlen) != 0 && errno != EINPROGRESS) {
+            close(fd);
+            connectFailures++;
+            return nullptr;
+        }
+        c = Conn();
+        c.fd = fd;
+        c.kind = kind;
+        c.startUs = nowUs();
+        return &c;
+    }
+    return nullptr;
+}
+
+static void closeConn(Conn& c) {
+    if (c.fd >= 0) close(c.fd);
+    c.fd = -1;
+    c.in.clear();
+    c.out.clear();
+}
+
+static void startHttp(const std::string& method, const std::string& path, const std::string& body,
+                      Probe probe) {
+    int route = probe == PROBE_NONE ? routeFor(method, path) : -1;
+    Conn* c = openConn(CONN_HTTP);
+    if (!c) {
+        if (route >= 0) routes[route].errors++;
+        return;
+    }
+    c->route = route;
+    c->probe = probe;
+    c->out = method + " " + path + " HTTP/1.1\r\nHost: " + opt.host +
+             "\r\nConnection: close\r\nUser-Agent: splitflap-load\r\n";
+    if (!body.empty() || method == "POST") {
+        c->out += body[0] == '{' ? "Content-Type: application/json\r\n"
+                                 : "Content-Type: application/x-www-form-urlencoded\r\n";
+        c->out += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    c->out += "\r\n" + body;
+}
+
+static void startWs(int client) {
+    Conn* c = openConn(CONN_WS);
+    if (!c) {
+        wsReconnectAt[client] = nowUs() + WS_RECONNECT_US;
+        return;
+    }
+    c->wsClient = client;
+    c->out = "GET /ws HTTP/1.1\r\nHost: " + opt.host +
+             "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    wsStats[client].connects++;
+    wsReconnectAt[client] = 0;
+}
+
+// -------------------------------------------------------------------
+// Server probes: /metrics (Prometheus text) and /api/profiler (JSON)
+// -------------------------------------------------------------------
+static bool metricValue(const std::string& text, const char* name, uint32_t& value) {
+    std::string key = std::string("\n") + name + " ";
+    size_t at = text.find(key);
+    if (at == std::string::npos) return false;
+    value = (uint32_t)strtoul(text.c_str() + at + key.size(), nullptr, 10);
+    return true;
+}
+
+static void handleMetrics(const std::string& body) {
+    uint32_t freeHeap, largest, dropped;
+    if (metricValue(body, "splitflap_free_heap_bytes", freeHeap) &&
+        metricValue(body, "splitflap_largest_free_block_bytes", largest)) {
+        if (!server.haveHeap) server.heapFreeStart = freeHeap;
+        server.haveHeap = true;
+        server.heapFreeEnd = freeHeap;
+        server.heapFreeMin = std::min(server.heapFreeMin, freeHeap);
+        server.largestBlockMin = std::min(server.largestBlockMin, largest);
+    }
+    if (metricValue(body, "splitflap_ws_frames_dropped_total", dropped)) {
+        if (!server.haveDropped) server.wsDroppedStart = dropped;
+        server.haveDropped = true;
+        server.wsDroppedEnd = dropped;
+    }
+}
+
+static void handleProfiler(const std::string& body) {
+    if (body.find("\"available\":true") == std::string::npos) return;
+    uint32_t idle = 0;
+    size_t at = 0;
+    while ((at = body.find("\"name\":\"", at)) != std::string::npos) {
+        at += 8;
+        bool isIdle = body.compare(at, 4, "IDLE") == 0;
+        size_t cpu = body.find("\"cpuPermille\":", at);
+        size_t next = body.find("\"name\":\"", at);
+        if (cpu == std::string::npos || (next != std::string::npos && cpu > next)) continue;
+        if (isIdle) idle += (uint32_t)strtoul(body.c_str() + cpu + 14, nullptr, 10);
+    }
+    server.cpuBusyPermille.push_back(idle >= 1000 ? 0 : 1000 - idle);
+}
+
+// -------------------------------------------------------------------
+// Response handling
+// -------------------------------------------------------------------
+static void finishHttp(Conn& c, bool ok) {
+    size_t headerEnd = c.in.find("\r\n\r\n");
+    int status = 0;
+    if (c.in.compare(0, 5, "HTTP/") == 0) status = atoi(c.in.c_str() + 9);
+    ok = ok && headerEnd != std::string::npos && status >= 200 && status < 300;
+
+    if (c.probe != PROBE_NONE) {
+        if (ok && c.probe == PROBE_METRICS) handleMetrics("\n" + c.in.substr(headerEnd + 4));
+        if (ok && c.probe == PROBE_PROFILER) handleProfiler(c.in.substr(headerEnd + 4));
+    } else if (c.route >= 0) {
+        RouteStats& r = routes[c.route];
+        if (ok) {
+            r.latencyUs.push_back((uint32_t)(nowUs() - c.startUs));
+            r.bytes += c.in.size();
+            completed++;
+        } else {
+            r.errors++;
+        }
+    }
+    closeConn(c);
+}
+
+// True once the whole body is in (Content‑Length), else wait for EOF
+static bool httpComplete(const Conn& c) {
+    size_t headerEnd = c.in.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return false;
+    const char* cl = strcasestr(c.in.c_str(), "\r\nContent-Length:");
+    if (!cl || cl > c.in.c_str() + headerEnd) return false;
+    size_t len = strtoul(cl + 17, nullptr, 10);
+    return c.in.size() >= headerEnd + 4 + len;
+}
+
+static void wsDropped(Conn& c) {
+    wsStats[c.wsClient].closes++;
+    wsReconnectAt[c.wsClient] = nowUs() + WS_RECONNECT_US;
+    closeConn(c);
+}
+
+static void wsFrame(Conn& c, uint8_t opcode, const char* payload, size_t len, int64_t at) {
+    if (opcode == 0x9) {                       // ping → masked pong, zero key
+        std::string pong;
+        pong += (char)0x8A;
+        pong += (char)(0x80 | (len < 126 ? len : 0));
+        pong.append(4, '\0');
+        if (len < 126) pong.append(payload, len);
+        c.out += pong;
+        return;
+    }
+    if (opcode == 0x8) {
+        wsDropped(c);
+        return;
+    }
+    if (opcode != 0x1 && opcode != 0x2 && opcode != 0x0) return;
+    if (len > 10 && memcmp(payload, "{\"topics\":", 10) == 0) return;   // subscription ack
+
+    WsClientStats& s = wsStats[c.wsClient];
+    s.frames++;
+    s.bytes += len;
+    if (!c.gotFirst) {
+        c.gotFirst = true;
+        firstFrameUs.push_back((uint32_t)(at - c.startUs));
+    }
+    uint64_t h = fnv1a(payload, len);
+    int n = s.seen[h]++;
+    auto key = std::make_pair(h, n);
+    auto it = broadcasts.find(key);
+    if (it == broadcasts.end()) {
+        broadcasts[key] = Broadcast{at, at, 1};
+    } else {
+        it->second.lastUs = at;
+        it->second.clients++;
+    }
+}
+
+static void wsParse(Conn& c, int64_t at) {
+    if (!c.upgraded) {
+        size_t end = c.in.find("\r\n\r\n");
+        if (end == std::string::npos) return;
+        if (c.in.compare(0, 12, "HTTP/1.1 101") != 0) {
+            wsDropped(c);
+            return;
+        }
+        c.upgraded = true;
+        c.in.erase(0, end + 4);
+        if (!opt.topics.empty()) {
+            // {"subscribe":[...]} as a masked text frame (zero key)
+            std::string list = "\"" + opt.topics + "\"";
+            for (size_t i = 0; (i = list.find(',', i)) != std::string::npos; i += 3) list.replace(i, 1, "\",\"");
+            std::string msg = "{\"subscribe\":[" + list + "]}";
+            if (msg.size() < 126) {
+                c.out += (char)0x81;
+                c.out += (char)(0x80 | msg.size());
+                c.out.append(4, '\0');
+                c.out += msg;
+            }
+        }
+    }
+    size_t pos = 0;
+    while (c.fd >= 0 && c.in.size() - pos >= 2) {
+        const uint8_t* p = (const uint8_t*)c.in.data() + pos;
+        uint64_t len = p[1] & 0x7F;
+        size_t hdr = 2;
+        if (len == 126) {
+            if (c.in.size() - pos < 4) break;
+            len = (p[2] << 8) | p[3];
+            hdr = 4;
+        } else if (len == 127) {
+            if (c.in.size() - pos < 10) break;
+            len = 0;
+            for (int i = 0; i < 8; i++) len = (len << 8) | p[2 + i];
+            hdr = 10;
+        }
+        if (p[1] & 0x80) hdr += 4;             // servers do not mask; skip key if one does
+        if (c.in.size() - pos < hdr + len) break;
+        wsFrame(c, p[0] & 0x0F, c.in.data() + pos + hdr, (size_t)len, at);
+        pos += hdr + (size_t)len;
+    }
+    if (c.fd >= 0) c.in.erase(0, pos);
+}
+
+static void serviceConn(Conn& c, short revents) {
+    int64_t at = nowUs();
+    if (revents & POLLOUT) {
+        if (!c.writable) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err) {
+                connectFailures++;
+                if (c.kind == CONN_WS) wsDropped(c); else finishHttp(c, false);
+                return;
+            }
+            c.writable = true;
+        }
+        while (c.outPos < c.out.size()) {
+            ssize_t n = send(c.fd, c.out.data() + c.outPos, c.out.size() - c.outPos, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            c.outPos += n;
+        }
+        if (c.outPos == c.out.size()) {
+            c.out.clear();
+            c.outPos = 0;
+        }
+    }
+    if (revents & (POLLIN | POLLHUP | POLLERR)) {
+        char buf[4096];
+        for (;;) {
+            ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                c.in.append(buf, n);
+                bytesIn += n;
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            // EOF or error
+            if (c.kind == CONN_WS) {
+                wsParse(c, at);
+                if (c.fd >= 0) wsDropped(c);
+            } else {
+                finishHttp(c, n == 0);
+            }
+            return;
+        }
+        if (c.kind == CONN_WS) {
+            wsParse(c, at);
+        } else if (httpComplete(c)) {
+            finishHttp(c, true);
+        }
+    }
+}
+
+// -------------------------------------------------------------------
+// Report
+// -------------------------------------------------------------------
+static void printReport(FILE* out, double seconds) {
+    std::vector<uint32_t> spread;
+    for (auto& b : broadcasts) {
+        if (b.second.clients >= 2) spread.push_back((uint32_t)(b.second.lastUs - b.second.firstUs));
+    }
+    uint32_t frames = 0, connects = 0, closes = 0;
+    uint64_t wsBytes = 0;
+    for (const WsClientStats& s : wsStats) {
+        frames += s.frames;
+        wsBytes += s.bytes;
+        connects += s.connects;
+        closes += s.closes;
+    }
+
+    fprintf(out, "\n=== load: %s:%s, %.0f s, %d ws, %d polling tabs every %d ms, %d replay ===\n",
+            opt.host.c_str(), opt.port.c_str(), seconds, opt.wsClients, opt.pollTabs, opt.pollMs,
+            opt.replayFile ? opt.replayers : 0);
+    fprintf(out, "%-28s %7s %5s %8s %8s %8s %8s\n", "route", "count", "err", "p50_ms", "p90_ms", "p99_ms", "max_ms");
+    for (RouteStats& r : routes) {
+        fprintf(out, "%-28s %7zu %5u %8.1f %8.1f %8.1f %8.1f\n", r.name.c_str(), r.latencyUs.size(),
+                r.errors, percentile(r.latencyUs, 0.50) / 1000.0, percentile(r.latencyUs, 0.90) / 1000.0,
+                percentile(r.latencyUs, 0.99) / 1000.0, percentile(r.latencyUs, 1.0) / 1000.0);
+    }
+    fprintf(out, "throughput     : %.1f req/s, %.1f kB/s in, %u connect failures\n",
+            completed / seconds, bytesIn / seconds / 1024.0, connectFailures);
+    fprintf(out, "websocket      : %u frames (%.2f/s per client), %.1f kB, %u connects, %u drops\n",
+            frames, opt.wsClients ? frames / seconds / opt.wsClients : 0.0, wsBytes / 1024.0, connects, closes);
+    fprintf(out, "first frame    : p50 %.1f ms, max %.1f ms\n",
+            percentile(firstFrameUs, 0.50) / 1000.0, percentile(firstFrameUs, 1.0) / 1000.0);
+    fprintf(out, "fan-out spread : p50 %.1f ms, p99 %.1f ms, max %.1f ms over %zu broadcasts\n",
+            percentile(spread, 0.50) / 1000.0, percentile(spread, 0.99) / 1000.0,
+            percentile(spread, 1.0) / 1000.0, spread.size());
+    if (server.haveHeap) {
+        fprintf(out, "server heap    : free %u → %u (min %u), largest block min %u\n",
+                server.heapFreeStart, server.heapFreeEnd, server.heapFreeMin, server.largestBlockMin);
+    } else {
+        fprintf(out, "server heap    : n/a (no /metrics)\n");
+    }
+    if (server.haveDropped) {
+        fprintf(out, "ws dropped     : %u frames during the run\n", server.wsDroppedEnd - server.wsDroppedStart);
+    }
+    if (!server.cpuBusyPermille.empty()) {
+        uint64_t sum = 0;
+        for (uint32_t v : server.cpuBusyPermille) sum += v;
+        fprintf(out, "server cpu     : %.1f%% busy (mean of %zu samples), max %.1f%%\n",
+                sum / 10.0 / server.cpuBusyPermille.size(), server.cpuBusyPermille.size(),
+                percentile(server.cpuBusyPermille, 1.0) / 10.0);
+    } else {
+        fprintf(out, "server cpu     : n/a (profiler unavailable)\n");
+    }
+}
+
+static void printJson(double seconds) {
+    printf("{\"target\":\"%s:%s\",\"seconds\":%.1f,\"wsClients\":%d,\"pollTabs\":%d,\"pollMs\":%d,"
+           "\"replayers\":%d,\"routes\":[",
+           opt.host.c_str(), opt.port.c_str(), seconds, opt.wsClients, opt.pollTabs, opt.pollMs,
+           opt.replayFile ? opt.replayers : 0);
+    for (size_t i = 0; i < routes.size(); i++) {
+        RouteStats& r = routes[i];
+        printf("%s{\"route\":\"%s\",\"count\":%zu,\"errors\":%u,\"p50Us\":%u,\"p90Us\":%u,\"p99Us\":%u,"
+               "\"maxUs\":%u,\"bytes\":%llu}", i ? "," : "", r.name.c_str(), r.latencyUs.size(), r.errors,
+               percentile(r.latencyUs, 0.50), percentile(r.latencyUs, 0.90), percentile(r.latencyUs, 0.99),
+               percentile(r.latencyUs, 1.0), (unsigned long long)r.bytes);
+    }
+    std::vector<uint32_t> spread;
+    for (auto& b : broadcasts) {
+        if (b.second.clients >= 2) spread.push_back((uint32_t)(b.second.lastUs - b.second.firstUs));
+    }
+    uint32_t frames = 0, closes = 0;
+    for (const WsClientStats& s : wsStats) {
+        frames += s.frames;
+        closes += s.closes;
+    }
+    uint64_t cpuSum = 0;
+    for (uint32_t v : server.cpuBusyPermille) cpuSum += v;
+    printf("],\"requestsPerSec\":%.2f,\"bytesInPerSec\":%.0f,\"connectFailures\":%u,"
+           "\"ws\":{\"frames\":%u,\"drops\":%u,\"firstFrameP50Us\":%u,\"spreadP50Us\":%u,\"spreadP99Us\":%u,"
+           "\"spreadMaxUs\":%u,\"broadcasts\":%zu},",
+           completed / seconds, bytesIn / seconds, connectFailures, frames, closes,
+           percentile(firstFrameUs, 0.50), percentile(spread, 0.50), percentile(spread, 0.99),
+           percentile(spread, 1.0), spread.size());
+    if (server.haveHeap) {
+        printf("\"heap\":{\"freeStart\":%u,\"freeEnd\":%u,\"freeMin\":%u,\"largestBlockMin\":%u},",
+               server.heapFreeStart, server.heapFreeEnd, server.heapFreeMin, server.largestBlockMin);
+    }
+    if (server.haveDropped) printf("\"wsFramesDropped\":%u,", server.wsDroppedEnd - server.wsDroppedStart);
+    if (!server.cpuBusyPermille.empty()) {
+        printf("\"cpuBusyPermille\":%llu,", (unsigned long long)(cpuSum / server.cpuBusyPermille.size()));
+    }
+    printf("\"ok\":true}\n");
+}
+
+// -------------------------------------------------------------------
+// Main loop
+// -------------------------------------------------------------------
+static bool parseArgs(int argc, char** argv) {
+    if (argc < 2) return false;
+    std::string hp = argv[1];
+    size_t colon = hp.rfind(':');
+    opt.host = hp.substr(0, colon);
+    if (colon != std::string::npos) opt.port = hp.substr(colon + 1);
+    for (int i = 2; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(a, "--json") == 0) { opt.json = true; continue; }
+        if (!v) return false;
+        if (strcmp(a, "--ws") == 0) opt.wsClients = atoi(v);
+        else if (strcmp(a, "--topics") == 0) opt.topics = v;
+        else if (strcmp(a, "--poll") == 0) opt.pollTabs = atoi(v);
+        else if (strcmp(a, "--interval") == 0) opt.pollMs = atoi(v);
+        else if (strcmp(a, "--duration") == 0) opt.seconds = atoi(v);
+        else if (strcmp(a, "--replay") == 0) opt.replayFile = v;
+        else if (strcmp(a, "--replayers") == 0) opt.replayers = atoi(v);
+        else if (strcmp(a, "--sample") == 0) opt.sampleMs = atoi(v);
+        else return false;
+        i++;
+    }
+    return opt.pollMs > 0 && opt.seconds > 0 && opt.sampleMs > 0 &&
+           opt.wsClients >= 0 && opt.pollTabs >= 0 && opt.replayers >= 0;
+}
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        fprintf(stderr, "usage: %s <host[:port]> [--ws N] [--topics LIST] [--poll M] [--interval MS]\n"
+                        "       [--duration S] [--replay FILE] [--replayers K] [--sample MS] [--json]\n", argv[0]);
+        return 2;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int gai = getaddrinfo(opt.host.c_str(), opt.port.c_str(), &hints, &target);
+    if (gai != 0) {
+        fprintf(stderr, "%s: %s\n", opt.host.c_str(), gai_strerror(gai));
+        return 1;
+    }
+
+    std::vector<ReplayLine> replay;
+    if (opt.replayFile && !loadReplay(opt.replayFile, replay)) {
+        fprintf(stderr, "cannot read replay file %s\n", opt.replayFile);
+        return 1;
+    }
+    int replayers = opt.replayFile ? opt.replayers : 0;
+
+    // Probe once a second before the load starts, so heap "start" is
+    // the idle figure
+    int64_t nextSample = nowUs();
+    int64_t start = nextSample + 1000000;
+    int64_t end = start + (int64_t)opt.seconds * 1000000LL;
+
+    // Tabs and sessions are spread evenly over one period
+    std::vector<int64_t> nextPoll(opt.pollTabs);
+    for (int t = 0; t < opt.pollTabs; t++) nextPoll[t] = start + (int64_t)opt.pollMs * 1000 * t / opt.pollTabs;
+    int64_t replaySpan = replay.empty() ? 0 : replay.back().atUs + 1000000;
+    std::vector<int64_t> sessionStart(replayers);
+    std::vector<size_t> replayPos(replayers, 0);
+    for (int r = 0; r < replayers; r++) sessionStart[r] = start + replaySpan * r / replayers;
+
+    wsStats.resize(opt.wsClients);
+    wsReconnectAt.assign(opt.wsClients, start);
+
+    std::vector<struct pollfd> fds;
+    std::vector<int> owner;
+    for (;;) {
+        int64_t now = nowUs();
+        bool running = now < end;
+
+        if (now >= nextSample || (!running && nextSample != INT64_MAX)) {
+            startHttp("GET", "/metrics", "", PROBE_METRICS);
+            startHttp("GET", "/api/profiler", "", PROBE_PROFILER);
+            nextSample = running ? now + (int64_t)opt.sampleMs * 1000 : INT64_MAX;
+        }
+        if (running && now >= start) {
+            for (int t = 0; t < opt.pollTabs; t++) {
+                while (now >= nextPoll[t]) {
+                    startHttp("GET", "/api/state", "", PROBE_NONE);
+                    nextPoll[t] += (int64_t)opt.pollMs * 1000;
+                }
+            }
+            for (int r = 0; r < replayers; r++) {
+                while (now >= sessionStart[r] + replay[replayPos[r]].atUs) {
+                    const ReplayLine& l = replay[replayPos[r]];
+                    startHttp(l.method, l.path, l.body, PROBE_NONE);
+                    if (++replayPos[r] == replay.size()) {
+                        replayPos[r] = 0;
+                        sessionStart[r] += replaySpan;
+                    }
+                }
+            }
+            for (int w = 0; w < opt.wsClients; w++) {
+                if (wsReconnectAt[w] && now >= wsReconnectAt[w]) startWs(w);
+            }
+        }
+
+        fds.clear();
+        owner.clear();
+        bool httpPending = false;
+        for (size_t i = 0; i < conns.size(); i++) {
+            Conn& c = conns[i];
+            if (c.fd < 0) continue;
+            if (c.kind == CONN_HTTP) {
+                if (now - c.startUs > HTTP_TIMEOUT_US) {
+                    finishHttp(c, false);
+                    continue;
+                }
+                httpPending = true;
+            }
+            short events = POLLIN;
+            if (!c.writable || !c.out.empty()) events |= POLLOUT;
+            fds.push_back({c.fd, events, 0});
+            owner.push_back((int)i);
+        }
+
+        // After the end: wait for in‑flight requests and the last probe
+        if (!running && !httpPending && nextSample == INT64_MAX) break;
+
+        int timeoutMs = 20;
+        if (poll(fds.data(), fds.size(), timeoutMs) < 0 && errno != EINTR) break;
+        for (size_t i = 0; i < fds.size(); i++) {
+            if (fds[i].revents && conns[owner[i]].fd == fds[i].fd) serviceConn(conns[owner[i]], fds[i].revents);
+        }
+    }
+    for (Conn& c : conns) closeConn(c);
+    freeaddrinfo(target);
+
+    double seconds = opt.seconds;
+    if (opt.json) {
+        printJson(seconds);
+        printReport(stderr, seconds);
+    } else {
+        printReport(stdout, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file SyncMain.cpp
+ * Multi‑display sync on one host: forks a leader and N followers, each a
+ * full native instance with its own simulated board, talking over the
+ * multicast group on loopback in real time.
+ *
+ *   pio run -e native_sync && .pio/build/native_sync/program [followers] [seconds] [countdown]
+ *
+ * Every instance boots with its wall clock off by a different amount
+ * (up to ±0.9 s, as after independent NTP syncs). The leader starts a
+ * countdown in seconds; the followers take config and run state from the
+ * leader's beacons. When the run ends, each instance reports the flips it
+ * fired, timestamped on the shared CLOCK_MONOTONIC. The parent prints
+ * the spread between instances for each countdown value.
+ *
+ * Followers need a few exchanges to lock; the first seconds (and the
+ * long first move from 0000) are not part of the table.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <HalSim.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../ConfigManager.h"
+#include "../SegmentController.h"
+#include "../I2CBus.h"
+#include "../TimerController.h"
+#include "../ClockManager.h"
+#include "../DisplaySync.h"
+#include "../DeviceState.h"
+
+ConfigManager configManager;
+
+void broadcastState() {}
+void broadcastTopics(uint8_t) {}
+
+extern void updateTimerController();
+
+#define MAX_INSTANCES 8
+
+static const int32_t CLOCK_ERRORS_MS[MAX_INSTANCES] = {0, 730, -410, 260, -880, 120, -150, 590};
+
+// -------------------------------------------------------------------
+// One instance: boot, run, write "value fireMicros lateUs" per flip.
+// -------------------------------------------------------------------
+static void runInstance(int index, long seconds, int countdown, int out) {
+    Serial.setEcho(false);
+    halResetClock();
+    SimBoard& board = halAttachSimulatedBoard();
+    board.rtc.setTime(1767261600);
+
+    i2cBusBegin(8, 9, 400000);
+    configManager.begin();
+    configManager.load();
+    clockManager.addProvider(&rtcClock);
+    clockManager.seedSystemClock();
+    setupSegmentController();
+    setupTimerController();
+
+    halSetRealtime(true);
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    halSetEpochMicros((int64_t)tv.tv_sec * 1000000LL + tv.tv_usec + CLOCK_ERRORS_MS[index] * 1000LL);
+
+    bool leader = index == 0;
+    startDisplaySync(leader ? SYNC_LEADER : SYNC_FOLLOWER, 1000 + index);
+    if (leader) {
+        TimerConfig& config = configManager.getConfig();
+        config.startTime = time(nullptr);
+        config.duration.value = countdown;
+        config.duration.unit = UNIT_SECONDS;
+        configManager.save();
+        startTimer();
+    }
+
+    unsigned long endMs = millis() + (unsigned long)seconds * 1000UL;
+    while (millis() < endMs) {
+        updateTimer();
+        updateDisplaySync();
+        updateTimerController();
+        configManager.update();
+        delay(1);
+    }
+
+    const SyncStatus& s = getSyncStatus();
+    dprintf(out, "%-8s %d: locked %d, offset %ld us, rtt %lu us, steps %lu, exchanges %lu, flips %lu, shows %d\n",
+            getSyncRoleName(s.role), index, s.locked ? 1 : 0, (long)s.lastOffsetUs,
+            (unsigned long)s.lastRttUs, (unsigned long)s.clockSteps, (unsigned long)s.exchanges,
+            (unsigned long)s.flipsFired, deviceState.snapshot().displayedValue());
+    for (int i = 0; i < getSyncFlipCount(); i++) {
+        const SyncFlip& f = getSyncFlip(i);
+        dprintf(out, "flip %d %d %llu %lu\n", index, (int)f.value,
+                (unsigned long long)f.fireMicros, (unsigned long)f.lateUs);
+    }
+}
+
+int main(int argc, char** argv) {
+    int followers = argc > 1 ? atoi(argv[1]) : 2;
+    long seconds = argc > 2 ? atol(argv[2]) : 25;
+    int countdown = argc > 3 ? atoi(argv[3]) : 25;
+    if (followers < 1) followers = 1;
+    if (followers > MAX_INSTANCES - 1) followers = MAX_INSTANCES - 1;
+    int instances = followers + 1;
+
+    int fds[MAX_INSTANCES];
+    pid_t pids[MAX_INSTANCES];
+    for (int i = 0; i < instances; i++) {
+        int p[2];
+        if (pipe(p) != 0) return 1;
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            close(p[0]);
+            runInstance(i, seconds, countdown, p[1]);
+            close(p[1]);
+            _exit(0);
+        }
+        close(p[1]);
+        fds[i] = p[0];
+    }
+
+    // fireMicros per instance and countdown value
+    static uint64_t fired[MAX_INSTANCES][100];
+    static uint32_t late[MAX_INSTANCES][100];
+    memset(fired, 0, sizeof(fired));
+    for (int i = 0; i < instances; i++) {
+        FILE* in = fdopen(fds[i], "r");
+        char line[256];
+        while (in && fgets(line, sizeof(line), in)) {
+            int idx, value;
+            unsigned long long us;
+            unsigned long lateUs;
+            if (sscanf(line, "flip %d %d %llu %lu", &idx, &value, &us, &lateUs) == 4) {
+                if (value >= 0 && value < 100) {
+                    fired[idx][value] = us;
+                    late[idx][value] = lateUs;
+                }
+            } else {
+                fputs(line, stdout);
+            }
+        }
+        if (in) fclose(in);
+        waitpid(pids[i], NULL, 0);
+    }
+
+    // A flip that comes due while an instance is still in the previous
+    // move fires late on that instance only; "late_us" shows which
+    printf("\nvalue  spread_us  late_us(leader, followers...)\n");
+    uint64_t worst = 0;
+    int rows = 0;
+    for (int v = 99; v >= 0; v--) {
+        uint64_t lo = UINT64_MAX, hi = 0;
+        bool all = true;
+        for (int i = 0; i < instances; i++) {
+            if (!fired[i][v]) { all = false; break; }
+            if (fired[i][v] < lo) lo = fired[i][v];
+            if (fired[i][v] > hi) hi = fired[i][v];
+        }
+        if (!all) continue;
+        printf("%5d  %9llu ", v, (unsigned long long)(hi - lo));
+        for (int i = 0; i < instances; i++) printf(" %6lu", (unsigned long)late[i][v]);
+        printf("\n");
+        if (hi - lo > worst) worst = hi - lo;
+        rows++;
+    }
+    printf("flips fired by all %d instances: %d, worst spread %llu us\n",
+           instances, rows, (unsigned long long)worst);
+    return rows > 0 ? 0 : 1;
+}